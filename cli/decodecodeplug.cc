@@ -65,7 +65,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
                    << "':\n" << errorMessage;
         return -1;
       }
-    } else if (! codeplug.read(filename, err)) {
+    } else if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "' :\n" << err.format();
       return -1;
@@ -82,7 +82,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
                    << "': " << errorMessage;
         return -1;
       }
-    } else if (! codeplug.read(filename, err)) {
+    } else if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "' :\n" << err.format();
       return -1;
@@ -99,7 +99,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
                    << "':\n" << errorMessage;
         return -1;
       }
-    } else if (! codeplug.read(filename, err)) {
+    } else if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "' :\n" << err.format();
       return -1;
@@ -117,7 +117,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
                    << "':\n" << errorMessage;
         return -1;
       }
-    } else if (! codeplug.read(filename, err)) {
+    } else if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "' :\n" << err.format();
       return -1;
@@ -135,7 +135,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
                    << "':\n" << errorMessage;
         return -1;
       }
-    } else if (! codeplug.read(filename, err)) {
+    } else if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "':\n" << err.format();
       return -1;
@@ -153,7 +153,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
                    << "':\n" << errorMessage;
         return -1;
       }
-    } else if (! codeplug.read(filename, err)) {
+    } else if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "':\n" << err.format();
       return -1;
@@ -170,7 +170,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
       return -1;
     }
     OpenGD77Codeplug codeplug;
-    if (! codeplug.read(filename, err)) {
+    if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "':\n" << err.format();
       return -1;
@@ -187,7 +187,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
       return -1;
     }
     OpenRTXCodeplug codeplug;
-    if (! codeplug.read(filename, err)) {
+    if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "':\n" << err.format();
       return -1;
@@ -204,7 +204,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
                  << RadioInfo::byID(radio).name() << "'.";
       return -1;
     }
-    if (! codeplug.read(filename, err)) {
+    if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "':\n" << err.format();
       return -1;
@@ -221,7 +221,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
       return -1;
     }
     D878UVCodeplug codeplug;
-    if (! codeplug.read(filename, err)) {
+    if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "':\n" << err.format();
       return -1;
@@ -238,7 +238,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
       return -1;
     }
     D878UV2Codeplug codeplug;
-    if (! codeplug.read(filename, err)) {
+    if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename <<
                     "':\n" << err.format();
       return -1;
@@ -255,7 +255,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
       return -1;
     }
     D578UVCodeplug codeplug;
-    if (! codeplug.read(filename, err)) {
+    if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "':\n" << err.format();
       return -1;
@@ -272,7 +272,7 @@ int decodeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
       return -1;
     }
     DMR6X2UVCodeplug codeplug;
-    if (! codeplug.read(filename, err)) {
+    if (! codeplug.map(filename, err)) {
       logError() << "Cannot decode binary codeplug file '" << filename
                  << "':\n" << err.format();
       return -1;
@@ -43,6 +43,16 @@ int encodeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
     }
   }
 
+  CallsignDB::Selection selection;
+  if (parser.isSet("limit")) {
+    bool ok=true;
+    selection.setCountLimit(parser.value("limit").toUInt(&ok));
+    if (! ok) {
+      logError() << "Please specify a valid limit for the number of callsign db entries using the -n/--limit option.";
+      return -1;
+    }
+  }
+
   if (parser.isSet("id")) {
     QStringList prefixes_text = parser.value("id").split(",");
     QSet<unsigned> prefixes;
@@ -61,7 +71,7 @@ int encodeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
       prefixes_text.append(QString::number(prefix));
     }
     logDebug() << "Sort call-sign DB w.r.t. DMR ID(s) {" << prefixes_text.join(", ") << "}.";
-    userdb.sortUsers(prefixes);
+    userdb.sortUsers(prefixes, selection.hasCountLimit() ? int(selection.countLimit()) : -1);
   } else {
     logWarn() << "No ID is specified, a more or less random set of call-signs will be used "
               << "if the radio cannot hold the entire call-sign DB of " << userdb.count()
@@ -69,16 +79,6 @@ int encodeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
               << "select those entries 'closest' to you. I.e., DMR IDs with the same prefix.";
   }
 
-  CallsignDB::Selection selection;
-  if (parser.isSet("limit")) {
-    bool ok=true;
-    selection.setCountLimit(parser.value("limit").toUInt(&ok));
-    if (! ok) {
-      logError() << "Please specify a valid limit for the number of callsign db entries using the -n/--limit option.";
-      return -1;
-    }
-  }
-
   if (! parser.isSet("radio")) {
     logError() << "You have to specify the radio using the --radio option.";
     parser.showHelp(-1);
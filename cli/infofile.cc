@@ -17,7 +17,7 @@ int infoFile(QCommandLineParser &parser, QCoreApplication &app) {
   QString filename = parser.positionalArguments().at(1);
   DFUFile file;
   ErrorStack err;
-  if (! file.read(filename, err)) {
+  if (! file.map(filename, err)) {
     logError() << "Cannot read codeplug file '" << filename
                << "': " << err.format();
     return -1;
@@ -69,6 +69,7 @@ int verify(QCommandLineParser &parser, QCoreApplication &app)
   }
 
   RadioLimitContext ctx;
+  ctx.enableParallel();
   QString radio = parser.value("radio").toLower();
   if ("rd5r" == radio) {
     RD5R radio; radio.limits().verifyConfig(&config, ctx);
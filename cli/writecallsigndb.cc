@@ -33,6 +33,16 @@ int writeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
     }
   }
 
+  CallsignDB::Selection selection;
+  if (parser.isSet("limit")) {
+    bool ok=true;
+    selection.setCountLimit(parser.value("limit").toUInt(&ok));
+    if (! ok) {
+      logError() << "Please specify a valid limit for the number of callsign db entries using the -n/--limit option.";
+      return -1;
+    }
+  }
+
   if (parser.isSet("id")) {
     QStringList prefixes_text = parser.value("id").split(",");
     QSet<unsigned> prefixes;
@@ -51,7 +61,7 @@ int writeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
       prefixes_text.append(QString::number(prefix));
     }
     logDebug() << "Sort call-sign DB w.r.t. DMR ID(s) {" << prefixes_text.join(", ") << "}.";
-    userdb.sortUsers(prefixes);
+    userdb.sortUsers(prefixes, selection.hasCountLimit() ? int(selection.countLimit()) : -1);
   } else {
     logWarn() << "No ID is specified, a more or less random set of call-signs will be used "
               << "if the radio cannot hold the entire call-sign DB of " << userdb.count()
@@ -59,16 +69,6 @@ int writeCallsignDB(QCommandLineParser &parser, QCoreApplication &app) {
               << "select those entries 'closest' to you. I.e., DMR IDs with the same prefix.";
   }
 
-  CallsignDB::Selection selection;
-  if (parser.isSet("limit")) {
-    bool ok=true;
-    selection.setCountLimit(parser.value("limit").toUInt(&ok));
-    if (! ok) {
-      logError() << "Please specify a valid limit for the number of callsign db entries using the -n/--limit option.";
-      return -1;
-    }
-  }
-
   ErrorStack err;
   Radio *radio = autoDetect(parser, app, err);
   if (nullptr == radio) {
@@ -43,6 +43,7 @@ int writeCodeplug(QCommandLineParser &parser, QCoreApplication &app) {
   }
 
   RadioLimitContext ctx(parser.isSet("ignore-limits"));
+  ctx.enableParallel();
 
   bool verified = true;
   radio->limits().verifyConfig(&config, ctx);
@@ -1,5 +1,5 @@
 #include "addressmap.hh"
-#include <algorithm>
+#include <iterator>
 
 AddressMap::AddressMap()
   : _items()
@@ -25,26 +25,38 @@ AddressMap::clear() {
   _items.clear();
 }
 
+unsigned int
+AddressMap::count() const {
+  return _items.size();
+}
+
 bool
 AddressMap::add(uint32_t addr, uint32_t len, int idx) {
-  if (0 > idx)
+  if (_items.end() != _items.find(addr))
+    return false;
+
+  if ((0 > idx) || (uint32_t(idx) >= _items.size())) {
     idx = _items.size();
-  AddrMapItem item(addr, len, idx);
+  } else {
+    // Make room for inserted index
+    for (auto &item: _items) {
+      if (item.second.index >= uint32_t(idx))
+        item.second.index++;
+    }
+  }
 
-  std::vector<AddrMapItem>::iterator at = std::lower_bound(_items.begin(), _items.end(), item);
-  if (_items.end() == at)
-    _items.push_back(item);
-  else
-    _items.insert(at, item);
+  _items.emplace(addr, AddrMapItem(len, idx));
   return true;
 }
 
 bool
 AddressMap::rem(uint32_t idx) {
-  std::vector<AddrMapItem>::iterator at = _items.begin();
-  for (; at!=_items.end(); at++) {
-    if (at->index == idx)
-      break;
+  std::map<uint32_t, AddrMapItem>::iterator at = _items.end();
+  for (auto it=_items.begin(); it!=_items.end(); it++) {
+    if (it->second.index == idx)
+      at = it;
+    else if (it->second.index > idx)
+      it->second.index--;
   }
   if (_items.end() == at)
     return false;
@@ -59,13 +71,40 @@ AddressMap::contains(uint32_t addr) const {
 
 int
 AddressMap::find(uint32_t addr) const {
-  std::vector<AddrMapItem>::const_iterator at = std::lower_bound(_items.begin(), _items.end(), addr);
-  if (_items.end() == at)
-    return _items.back().contains(addr) ? _items.back().index : -1;
-  if (at->contains(addr))
-    return at->index;
-  if (_items.begin() == at)
+  auto at = first(addr);
+  if ((_items.end() == at) || (at->first > addr))
     return -1;
-  --at;
-  return at->contains(addr) ? at->index : -1;
+  return at->second.index;
+}
+
+bool
+AddressMap::overlaps(uint32_t addr, uint32_t len) const {
+  if (0 == len)
+    return false;
+  auto at = first(addr);
+  return (_items.end() != at) && ((uint64_t(addr)+len) > at->first);
+}
+
+std::vector<uint32_t>
+AddressMap::intersecting(uint32_t addr, uint32_t len) const {
+  std::vector<uint32_t> indices;
+  if (0 == len)
+    return indices;
+  uint64_t end = uint64_t(addr) + len;
+  for (auto at=first(addr); (_items.end() != at) && (at->first < end); at++)
+    indices.push_back(at->second.index);
+  return indices;
+}
+
+std::map<uint32_t, AddressMap::AddrMapItem>::const_iterator
+AddressMap::first(uint32_t addr) const {
+  // First item starting after the address
+  auto at = _items.upper_bound(addr);
+  // Check if the previous item contains the address
+  if (_items.begin() != at) {
+    auto prev = std::prev(at);
+    if ((uint64_t(prev->first)+prev->second.length) > addr)
+      return prev;
+  }
+  return at;
 }
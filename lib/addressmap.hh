@@ -2,12 +2,18 @@
 #define ADDRESSMAP_HH
 
 #include <cinttypes>
+#include <map>
 #include <vector>
 
 /** This class represents a memory map.
- * That is, it maintains a vector of memory regions (address and length) that can be searched
- * efficiently. This should speedup the generation of codeplugs consisting of many small memory
- * sections.
+ * That is, it maintains an ordered tree of memory regions (address and length) that can be
+ * searched efficiently. Finding regions and appending regions (i.e., adding them with the next
+ * index) is performed in O(log n). This should speedup the generation of codeplugs consisting of
+ * many small memory sections. Inserting a region at a specific index or removing a region renumbers
+ * the indices of the other regions and takes O(n).
+ *
+ * The memory regions are assumed not to overlap. Use @c overlaps to check whether a region would
+ * overlap with any of the regions within the map.
  *
  * @ingroup util */
 class AddressMap
@@ -23,46 +29,49 @@ public:
 
   /** Clears the address map. */
   void clear();
-  /** Adds an item to the address map. */
+  /** Returns the number of memory regions. */
+  unsigned int count() const;
+  /** Adds an item to the address map. If the index is negative, the index is set to the number of
+   * regions within the map. Otherwise, the indices of all items with an index equal or larger
+   * than the given one are incremented (i.e., the item gets inserted), which takes O(n).
+   * @returns @c false if there is already a region starting at the given address. In this case,
+   * the map is left unchanged. */
   bool add(uint32_t addr, uint32_t len, int idx=-1);
-  /** Removes an item from the address map associated with the given index. */
+  /** Removes an item from the address map associated with the given index. The indices of all
+   * items with a larger index are decremented, which takes O(n). */
   bool rem(uint32_t idx);
   /** Returns @c true if the given address is contained in any of the memory regions. */
   bool contains(uint32_t addr) const;
   /** Finds the index of the memory region containing the given address. If no such region is found,
    * -1 is returned. */
   int find(uint32_t addr) const;
+  /** Returns @c true if the given memory region overlaps with any of the regions within the
+   * map. */
+  bool overlaps(uint32_t addr, uint32_t len) const;
+  /** Returns the indices of all memory regions intersecting the given memory region [addr, addr+len),
+   * ordered by their address. */
+  std::vector<uint32_t> intersecting(uint32_t addr, uint32_t len) const;
 
 protected:
   /** Memory map item.
-   * That is, a collection of address, length and associated index. */
+   * That is, a collection of length and associated index. The address is the key of the map. */
   struct AddrMapItem {
-    uint32_t address;   ///< The start address of the item.
     uint32_t length;    ///< The size/length of the memory item.
     uint32_t index;     ///< The associated (element) index.
 
     /** Constructor. */
-    inline AddrMapItem(uint32_t addr, uint32_t len, uint32_t idx)
-      : address(addr), length(len), index(idx) {
+    inline AddrMapItem(uint32_t len, uint32_t idx)
+      : length(len), index(idx) {
       // pass...
     }
-    /** Comparison operator. */
-    inline bool operator<(const AddrMapItem &other) const {
-      return address < other.address;
-    }
-    /** Comparison operator. */
-    inline bool operator<(uint32_t addr) const {
-      return address < addr;
-    }
-    /** Returns @c true if the given address is contained within this memory region. */
-    inline bool contains(uint32_t addr) const {
-      return (address <= addr) && ((address+length) > addr);
-    }
   };
 
+  /** Returns the iterator to the first item, that may contain the given address or ends after it. */
+  std::map<uint32_t, AddrMapItem>::const_iterator first(uint32_t addr) const;
+
 protected:
-  /** Holds the vector of memory items, the order of these items is maintained. */
-  std::vector<AddrMapItem> _items;
+  /** Maps start addresses to memory items, ordered by address. */
+  std::map<uint32_t, AddrMapItem> _items;
 };
 
 #endif // ADDRESSMAP_HH
@@ -9,6 +9,8 @@
 using namespace Signaling;
 
 #define CUSTOM_CTCSS_TONE 0x33
+/** Size of the address range covered by the arena, holding the entire codeplug. */
+#define ARENA_SIZE 0x05000000
 
 Code _anytone_ctcss_num2code[52] = {
   SIGNALING_NONE, // 62.5 not supported
@@ -4500,6 +4502,9 @@ AnytoneCodeplug::clear() {
     remImage(0);
 
   addImage(_label);
+  // Hold all elements in a single arena covering the entire codeplug memory. The memory is only
+  // allocated once elements get added.
+  image(0).useArena(0x00000000, ARENA_SIZE);
 
   // Allocate bitmaps
   this->allocateBitmaps();
@@ -4613,5 +4618,11 @@ AnytoneCodeplug::decode(Config *config, const ErrorStack &err) {
   // Register table for FM APRS frequencies
   ctx.addTable(&AnytoneAPRSFrequency::staticMetaObject);
 
+  // Elements are created concurrently. Create the singletons referenced by new channels, scan
+  // lists etc. here, such that they belong to this thread. Tag registration itself is locked.
+  DefaultRadioID::get();
+  DefaultRoamingZone::get();
+  SelectedChannel::get();
+
   return this->decodeElements(ctx, err);
 }
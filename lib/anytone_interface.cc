@@ -1,9 +1,13 @@
 #include "anytone_interface.hh"
 #include "logger.hh"
 #include <QtEndian>
+#include <QVector>
+#include <algorithm>
 
 #define USB_VID 0x28e9
 #define USB_PID 0x018a
+/** Default number of requests kept in flight. */
+#define PIPELINE_DEPTH 8
 
 /* ********************************************************************************************* *
  * Implementation of AnytoneInterface::ReadRequest
@@ -86,7 +90,8 @@ AnytoneInterface::RadioVariant::isValid() const {
  * Implementation of AnytoneInterface
  * ********************************************************************************************* */
 AnytoneInterface::AnytoneInterface(const USBDeviceDescriptor &descriptor, const ErrorStack &err, QObject *parent)
-  : USBSerial(descriptor, err, parent), _state(STATE_INITIALIZED), _info()
+  : USBSerial(descriptor, err, parent), _state(STATE_INITIALIZED), _info(),
+    _pipelineDepth(PIPELINE_DEPTH)
 {
   if (isOpen()) {
     _state = STATE_OPEN;
@@ -192,6 +197,23 @@ AnytoneInterface::write(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes,
 
   //logDebug() << "Anytone: Write " << nbytes << "b to addr 0x" << QString::number(addr, 16) << "...";
 
+  int done = 0;
+  if (_pipelineDepth > 1) {
+    ErrorStack pipeErr;
+    if (write_pipelined(addr, data, nbytes, done, pipeErr))
+      return true;
+    // The reason has been logged already, continue with the remaining data in lock-step
+    logWarn() << "Anytone: Pipelined write failed at address 0x" << QString::number(addr+done, 16)
+              << ". Fall back to lock-step.";
+    drain();
+    _pipelineDepth = 1;
+  }
+
+  return write_lockstep(addr+done, data+done, nbytes-done, err);
+}
+
+bool
+AnytoneInterface::write_lockstep(uint32_t addr, uint8_t *data, int nbytes, const ErrorStack &err) {
   for (int i=0; i<nbytes; i+=16) {
     uint8_t ack;
     WriteRequest req(addr+i, (const char *)(data+i));
@@ -209,6 +231,39 @@ AnytoneInterface::write(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes,
   return true;
 }
 
+bool
+AnytoneInterface::write_pipelined(uint32_t addr, uint8_t *data, int nbytes, int &done, const ErrorStack &err) {
+  int nblocks = (nbytes+15)/16, sent = 0, acked = 0;
+  QByteArray requests;
+  done = 0;
+
+  while (acked < nblocks) {
+    // Fill window of in-flight requests
+    requests.clear();
+    while ((sent < nblocks) && ((sent-acked) < int(_pipelineDepth))) {
+      WriteRequest req(addr+16*sent, (const char *)(data+16*sent));
+      requests.append((const char *)&req, sizeof(WriteRequest));
+      sent++;
+    }
+    if ((! requests.isEmpty()) && (! send(requests.constData(), requests.size(), err)))
+      return false;
+
+    // Wait for the oldest request to be acknowledged
+    uint8_t ack;
+    if (! receive((char *)&ack, 1, err))
+      return false;
+    if (0x06 != ack) {
+      errMsg(err) << "Anytone: Cannot write data to device: Unexpected response "
+                  << (int)ack << ", expected 6.";
+      return false;
+    }
+    acked++;
+    done = std::min(nbytes, 16*acked);
+  }
+
+  return true;
+}
+
 bool
 AnytoneInterface::write_finish(const ErrorStack &err) {
   Q_UNUSED(err)
@@ -239,6 +294,23 @@ AnytoneInterface::read(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes,
 
   //logDebug() << "Anytone: Read " << nbytes << "b from addr 0x" << QString::number(addr, 16) << "...";
 
+  int done = 0;
+  if (_pipelineDepth > 1) {
+    ErrorStack pipeErr;
+    if (read_pipelined(addr, data, nbytes, done, pipeErr))
+      return true;
+    // The reason has been logged already, continue with the remaining data in lock-step
+    logWarn() << "Anytone: Pipelined read failed at address 0x" << QString::number(addr+done, 16)
+              << ". Fall back to lock-step.";
+    drain();
+    _pipelineDepth = 1;
+  }
+
+  return read_lockstep(addr+done, data+done, nbytes-done, err);
+}
+
+bool
+AnytoneInterface::read_lockstep(uint32_t addr, uint8_t *data, int nbytes, const ErrorStack &err) {
   for (int i=0; i<nbytes; i+=16) {
     ReadRequest req(addr + i);
     ReadResponse resp;
@@ -258,12 +330,70 @@ AnytoneInterface::read(uint32_t bank, uint32_t addr, uint8_t *data, int nbytes,
   return true;
 }
 
+bool
+AnytoneInterface::read_pipelined(uint32_t addr, uint8_t *data, int nbytes, int &done, const ErrorStack &err) {
+  int nblocks = (nbytes+15)/16, sent = 0, received = 0, complete = 0;
+  QVector<bool> receivedBlocks(nblocks, false);
+  QByteArray requests;
+  done = 0;
+
+  while (received < nblocks) {
+    // Fill window of in-flight requests
+    requests.clear();
+    while ((sent < nblocks) && ((sent-received) < int(_pipelineDepth))) {
+      ReadRequest req(addr + 16*sent);
+      requests.append((const char *)&req, sizeof(ReadRequest));
+      sent++;
+    }
+    if ((! requests.isEmpty()) && (! send(requests.constData(), requests.size(), err)))
+      return false;
+
+    // Receive next response and match it to an in-flight request by its address
+    ReadResponse resp;
+    if (! receive((char *)&resp, sizeof(ReadResponse), err))
+      return false;
+    uint32_t raddr = qFromBigEndian(resp.addr);
+    if ((raddr < addr) || ((raddr-addr) % 16) || (int((raddr-addr)/16) >= sent)
+        || receivedBlocks[(raddr-addr)/16]) {
+      errMsg(err) << "Anytone: Cannot read data from device: Unexpected response for address 0x"
+                  << QString::number(raddr, 16) << ".";
+      return false;
+    }
+    QString error_message;
+    if (! resp.check(raddr, error_message)) {
+      errMsg(err) << "Anytone: Cannot read data from device: " << error_message << ".";
+      return false;
+    }
+
+    int idx = (raddr-addr)/16;
+    memcpy(data+16*idx, resp.data, std::min(16, nbytes-16*idx));
+    receivedBlocks[idx] = true;
+    received++;
+    // Update number of bytes read without gap
+    while ((complete < nblocks) && receivedBlocks[complete])
+      complete++;
+    done = std::min(nbytes, 16*complete);
+  }
+
+  return true;
+}
+
 bool
 AnytoneInterface::read_finish(const ErrorStack &err) {
   Q_UNUSED(err)
   return true;
 }
 
+unsigned
+AnytoneInterface::pipelineDepth() const {
+  return _pipelineDepth;
+}
+
+void
+AnytoneInterface::setPipelineDepth(unsigned depth) {
+  _pipelineDepth = std::max(1u, depth);
+}
+
 bool
 AnytoneInterface::reboot(const ErrorStack &err) {
   if (STATE_PROGRAM == _state) {
@@ -360,36 +490,53 @@ AnytoneInterface::leave_program_mode(const ErrorStack &err) {
 
 bool
 AnytoneInterface::send_receive(const char *cmd, int clen, char *resp, int rlen, const ErrorStack &err) {
+  if ((! send(cmd, clen, err)) || (! receive(resp, rlen, err))) {
+    close();
+    _state = STATE_ERROR;
+    return false;
+  }
+
+  // done
+  return true;
+}
+
+bool
+AnytoneInterface::send(const char *cmd, int clen, const ErrorStack &err) {
   // Try to write command to device
   if (clen != QSerialPort::write(cmd, clen)) {
     errMsg(err) << "Cannot send command to device.";
-    close();
-    _state = STATE_ERROR;
     return false;
   }
+  return true;
+}
 
+bool
+AnytoneInterface::receive(char *resp, int rlen, const ErrorStack &err) {
   // Read from device until complete response has been read
   char *p = resp;
   int len = rlen;
   while (len > 0) {
     if (! waitForReadyRead(1000)) {
       errMsg(err) << "No response from device: Timeout.";
-      close();
-      _state = STATE_ERROR;
       return false;
     }
 
     int r = QSerialPort::read(p, len);
     if (r < 0) {
       errMsg(err) << "Cannot read response from device.";
-      close();
-      _state = STATE_ERROR;
       return false;
     }
     p += r;
     len-=r;
   }
 
-  // done
   return true;
 }
+
+void
+AnytoneInterface::drain() {
+  // Discard late responses to requests still in flight
+  while (waitForReadyRead(100))
+    QSerialPort::readAll();
+  clear(QSerialPort::Input);
+}
@@ -59,6 +59,14 @@ public:
 
   bool reboot(const ErrorStack &err=ErrorStack());
 
+  /** Returns the number of read/write requests kept in flight during transfers.
+   * A depth of 1 corresponds to the lock-step transfer, where each request waits for its
+   * response before the next one gets sent. */
+  unsigned pipelineDepth() const;
+  /** Sets the number of read/write requests kept in flight during transfers.
+   * Setting the depth to 0 or 1 disables the pipelined transfer. */
+  void setPipelineDepth(unsigned depth);
+
 public:
   /** Returns some information about this interface. */
   static USBDeviceInfo interfaceInfo();
@@ -74,6 +82,27 @@ protected:
   bool leave_program_mode(const ErrorStack &err=ErrorStack());
   /** Internal used method to send messages to and receive responses from radio. */
   bool send_receive(const char *cmd, int clen, char *resp, int rlen, const ErrorStack &err=ErrorStack());
+  /** Internal used method to send a message to the radio without waiting for a response. */
+  virtual bool send(const char *cmd, int clen, const ErrorStack &err=ErrorStack());
+  /** Internal used method to receive a response from the radio. In contrast to @c send_receive,
+   * a timeout does not close the interface. */
+  virtual bool receive(char *resp, int rlen, const ErrorStack &err=ErrorStack());
+
+  /** Reads the given number of bytes from the specified address, keeping up to
+   * @c pipelineDepth() read requests in flight. The responses are matched to the requests by
+   * their address. On error, @c done contains the number of bytes read successfully from the
+   * start of the block, the remaining may then be read in lock-step. */
+  bool read_pipelined(uint32_t addr, uint8_t *data, int nbytes, int &done, const ErrorStack &err=ErrorStack());
+  /** Reads the given number of bytes from the specified address in lock-step. */
+  bool read_lockstep(uint32_t addr, uint8_t *data, int nbytes, const ErrorStack &err=ErrorStack());
+  /** Writes the given number of bytes to the specified address, keeping up to
+   * @c pipelineDepth() write requests in flight. On error, @c done contains the number of bytes
+   * acknowledged by the device from the start of the block. */
+  bool write_pipelined(uint32_t addr, uint8_t *data, int nbytes, int &done, const ErrorStack &err=ErrorStack());
+  /** Writes the given number of bytes to the specified address in lock-step. */
+  bool write_lockstep(uint32_t addr, uint8_t *data, int nbytes, const ErrorStack &err=ErrorStack());
+  /** Discards any pending responses of a failed pipelined transfer. */
+  virtual void drain();
 
 protected:
   /** Binary representation of a read request to the radio. */
@@ -137,6 +166,8 @@ protected:
   State _state;
   /** Holds the radio info. */
   RadioVariant _info;
+  /** Holds the number of requests kept in flight. */
+  unsigned _pipelineDepth;
 };
 
 #endif // ANYTONEINTERFACE_HH
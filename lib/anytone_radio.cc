@@ -6,6 +6,8 @@
 
 #define RBSIZE 16
 #define WBSIZE 16
+/** Maximum gap between two elements, that gets read along to merge them into a single transfer. */
+#define RGAP   0x40
 
 
 AnytoneRadio::AnytoneRadio(const QString &name, AnytoneInterface *device, QObject *parent)
@@ -189,18 +191,12 @@ AnytoneRadio::download() {
     return false;
   }
 
-  logDebug() << "Download of " << _codeplug->image(0).numElements() << " bitmaps.";
-
   // Download bitmaps
-  for (int n=0; n<_codeplug->image(0).numElements(); n++) {
-    unsigned addr = _codeplug->image(0).element(n).address();
-    unsigned size = _codeplug->image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug->data(addr), size, _errorStack)) {
-      errMsg(_errorStack) << "Cannot download codeplug.";
-      return false;
-    }
-    emit downloadProgress(float(n*100)/_codeplug->image(0).numElements());
-  }
+  QVector<DFUFile::Extent> extents = _codeplug->image(0).extents(RGAP);
+  logDebug() << "Download of " << _codeplug->image(0).numElements() << " bitmaps in "
+             << extents.size() << " transfers.";
+  if (! readExtents(extents, 0, 50, "Cannot download codeplug."))
+    return false;
 
   // Allocate remaining memory sections
   unsigned nstart = _codeplug->image(0).numElements();
@@ -218,15 +214,11 @@ AnytoneRadio::download() {
   }
 
   // Download remaining memory sections
-  for (int n=nstart; n<_codeplug->image(0).numElements(); n++) {
-    unsigned addr = _codeplug->image(0).element(n).address();
-    unsigned size = _codeplug->image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug->data(addr), size, _errorStack)) {
-      errMsg(_errorStack) << "Cannot download codeplug.";
-      return false;
-    }
-    emit downloadProgress(float(n*100)/_codeplug->image(0).numElements());
-  }
+  extents = _codeplug->image(0).extents(RGAP, nstart);
+  logDebug() << "Download of " << (_codeplug->image(0).numElements()-nstart) << " elements in "
+             << extents.size() << " transfers.";
+  if (! readExtents(extents, 50, 50, "Cannot download codeplug."))
+    return false;
 
   return true;
 }
@@ -239,31 +231,21 @@ AnytoneRadio::upload() {
   }
 
   // Download bitmaps first
-  size_t nbitmaps = _codeplug->numImages();
-  for (int n=0; n<_codeplug->image(0).numElements(); n++) {
-    unsigned addr = _codeplug->image(0).element(n).address();
-    unsigned size = _codeplug->image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug->data(addr), size, _errorStack)) {
-      errMsg(_errorStack) << "Cannot read codeplug for update.";
-      return false;
-    }
-    emit uploadProgress(float(n*25)/_codeplug->image(0).numElements());
-  }
+  unsigned nbitmaps = _codeplug->image(0).numElements();
+  if (! readExtents(_codeplug->image(0).extents(RGAP), 0, 25, "Cannot read codeplug for update."))
+    return false;
 
   // Allocate all memory sections that must be read first
   // and written back to the device more or less untouched
   _codeplug->allocateUpdated();
 
   // Download new memory sections for update
-  for (int n=nbitmaps; n<_codeplug->image(0).numElements(); n++) {
-    unsigned addr = _codeplug->image(0).element(n).address();
-    unsigned size = _codeplug->image(0).element(n).data().size();
-    if (! _dev->read(0, addr, _codeplug->data(addr), size, _errorStack)) {
-      errMsg(_errorStack) << "Cannot read codeplug for update.";
-      return false;
-    }
-    emit uploadProgress(25+float(n*25)/_codeplug->image(0).numElements());
-  }
+  if (! readExtents(_codeplug->image(0).extents(RGAP, nbitmaps), 25, 25,
+                    "Cannot read codeplug for update."))
+    return false;
+
+  // Remember downloaded codeplug to upload modified blocks only
+  _codeplug->takeSnapshot();
 
   // Update binary codeplug from config
   if (! _codeplug->encode(_config, _codeplugFlags, _errorStack)) {
@@ -274,15 +256,50 @@ AnytoneRadio::upload() {
   // Sort all elements before uploading
   _codeplug->image(0).sort();
 
-  // Upload all elements back to the device
-  for (int n=0; n<_codeplug->image(0).numElements(); n++) {
-    unsigned addr = _codeplug->image(0).element(n).address();
-    unsigned size = _codeplug->image(0).element(n).data().size();
-    if (! _dev->write(0, addr, _codeplug->data(addr), size, _errorStack)) {
+  // Upload all modified blocks back to the device, merging adjacent ones
+  QVector<DFUFile::Extent> modified = DFUFile::coalesce(_codeplug->image(0).modified(WBSIZE));
+  size_t totb = 0, bcount = 0;
+  foreach (const DFUFile::Extent &e, modified)
+    totb += e.size;
+  logDebug() << "Upload " << totb << "b of " << _codeplug->memSize() << "b modified in "
+             << modified.size() << " transfers.";
+
+  QByteArray buffer;
+  foreach (const DFUFile::Extent &e, modified) {
+    buffer.resize(e.size);
+    _codeplug->image(0).gather(e.address, (uint8_t *)buffer.data(), e.size);
+    if (! _dev->write(0, e.address, (uint8_t *)buffer.data(), e.size, _errorStack)) {
       errMsg(_errorStack) << "Cannot write codeplug.";
       return false;
     }
-    emit uploadProgress(50+float(n*50)/_codeplug->image(0).numElements());
+    bcount += e.size;
+    emit uploadProgress(50+float(bcount*50)/totb);
+  }
+
+  return true;
+}
+
+bool
+AnytoneRadio::readExtents(const QVector<DFUFile::Extent> &extents, float progressOffset,
+                          float progressRange, const QString &errorMessage)
+{
+  size_t totb = 0, bcount = 0;
+  foreach (const DFUFile::Extent &e, extents)
+    totb += e.size;
+
+  QByteArray buffer;
+  foreach (const DFUFile::Extent &e, extents) {
+    buffer.resize(e.size);
+    if (! _dev->read(0, e.address, (uint8_t *)buffer.data(), e.size, _errorStack)) {
+      errMsg(_errorStack) << errorMessage;
+      return false;
+    }
+    _codeplug->image(0).scatter(e.address, (const uint8_t *)buffer.constData(), e.size);
+    bcount += e.size;
+    if (StatusDownload == _task)
+      emit downloadProgress(progressOffset + float(bcount)*progressRange/totb);
+    else
+      emit uploadProgress(progressOffset + float(bcount)*progressRange/totb);
   }
 
   return true;
@@ -70,6 +70,13 @@ private:
    * This method block until the upload is complete. */
   virtual bool uploadCallsigns();
 
+  /** Reads the given memory regions of the codeplug from the device.
+   * Any gaps between the elements within a region are read along but discarded. The progress
+   * is reported within the given range as download or upload progress depending on the current
+   * task. */
+  bool readExtents(const QVector<DFUFile::Extent> &extents, float progressOffset,
+                   float progressRange, const QString &errorMessage);
+
 protected:
   /** The device identifier. */
   QString _name;
@@ -1,4 +1,8 @@
 #include "callsigndb.hh"
+#include "userdatabase.hh"
+#include "taskgraph.hh"
+#include <QThread>
+#include <algorithm>
 
 
 /* ********************************************************************************************* *
@@ -51,3 +55,37 @@ CallsignDB::CallsignDB(QObject *parent)
 CallsignDB::~CallsignDB() {
   // pass...
 }
+
+QVector<int>
+CallsignDB::selectUsers(const UserDatabase *db, qint64 n) {
+  n = std::max(qint64(0), std::min(n, db->count()));
+  QVector<int> users(n);
+  for (int i=0; i<n; i++)
+    users[i] = i;
+  std::sort(users.begin(), users.end(), [db](int a, int b) {
+    return db->view(a).id() < db->view(b).id();
+  });
+  return users;
+}
+
+bool
+CallsignDB::encodeConcurrently(int n, const std::function<void(int first, int last)> &encode,
+                               const ErrorStack &err)
+{
+  int chunk = std::max(1024, n/(4*std::max(1, QThread::idealThreadCount())));
+  if (n <= chunk) {
+    encode(0, n);
+    return true;
+  }
+
+  TaskGraph tasks;
+  for (int first=0; first<n; first+=chunk) {
+    int last = std::min(n, first+chunk);
+    tasks.add([&encode, first, last](const ErrorStack &err) {
+      Q_UNUSED(err);
+      encode(first, last);
+      return true;
+    });
+  }
+  return tasks.run(err);
+}
@@ -2,6 +2,7 @@
 #define CALLSIGNDB_HH
 
 #include "dfufile.hh"
+#include <functional>
 
 // Forward decl.
 class UserDatabase;
@@ -50,6 +51,21 @@ public:
   /** Encodes the given user db into the device specific callsign db. */
   virtual bool encode(UserDatabase *db, const Selection &selection=Selection(),
                       const ErrorStack &err=ErrorStack()) = 0;
+
+protected:
+  /** Returns the indices of the first @c n users of the given database, ordered by their IDs.
+   * The users themselves are not copied. */
+  static QVector<int> selectUsers(const UserDatabase *db, qint64 n);
+  /** Calls @c encode for consecutive chunks [first, last) of @c n entries. A large number of
+   * entries gets split into several chunks, that are encoded concurrently. Hence @c encode must
+   * only write to the memory of the given entries. Returns @c false if the concurrent encoding
+   * failed.
+   *
+   * Only used by the AnyTone DBs (see @c D868UVCallsignDB). The GD77, OpenGD77 and TyT DBs are
+   * encoded serially: The former are small with entries of fixed size, the index of the latter
+   * depends on the previous entries. */
+  static bool encodeConcurrently(int n, const std::function<void(int first, int last)> &encode,
+                                 const ErrorStack &err=ErrorStack());
 };
 
 #endif // CALLSIGNDB_HH
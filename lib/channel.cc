@@ -6,6 +6,7 @@
 #include "scanlist.hh"
 #include "logger.hh"
 #include <QPushButton>
+#include <QMutex>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
@@ -947,6 +948,9 @@ SelectedChannel::clone() const {
 
 SelectedChannel *
 SelectedChannel::get() {
+  // May be called concurrently, e.g., by objects created while decoding a codeplug
+  static QMutex mutex;
+  QMutexLocker locker(&mutex);
   if (nullptr == SelectedChannel::_instance)
     SelectedChannel::_instance = new SelectedChannel();
   return SelectedChannel::_instance;
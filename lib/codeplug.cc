@@ -584,7 +584,7 @@ Codeplug::Element::writeUnicode(unsigned offset, const QString &txt, unsigned ma
  * Implementation of CodePlug::Context
  * ********************************************************************************************* */
 Codeplug::Context::Context(Config *config)
-  : _config(config), _tables()
+  : _config(config), _tables(), _tableIds()
 {
   // Add tables for common elements
   addTable(&DMRRadioID::staticMetaObject);
@@ -605,64 +605,108 @@ Codeplug::Context::config() const {
   return _config;
 }
 
+int
+Codeplug::Context::tableId(const QMetaObject *obj) const {
+  // Walk up the class hierarchy until a table or a resolved type is found
+  for (; nullptr != obj; obj = obj->superClass()) {
+    QHash<const QMetaObject *, int>::const_iterator id = _tableIds.constFind(obj);
+    if (_tableIds.constEnd() != id)
+      return *id;
+  }
+  return -1;
+}
+
+int
+Codeplug::Context::resolveTable(const QMetaObject *obj) {
+  QHash<const QMetaObject *, int>::const_iterator id = _tableIds.constFind(obj);
+  if (_tableIds.constEnd() != id)
+    return *id;
+  int tid = tableId(obj);
+  _tableIds.insert(obj, tid);
+  return tid;
+}
+
 bool
 Codeplug::Context::hasTable(const QMetaObject *obj) const {
-  // Find a matching table
-  if (_tables.contains(obj->className()))
-    return true;
-  else if (obj->superClass())
-    return hasTable(obj->superClass());
-  return false;
+  return 0 <= tableId(obj);
 }
 
-Codeplug::Context::Table &
-Codeplug::Context::getTable(const QMetaObject *obj) {
-  if (_tables.contains(obj->className()))
-    return _tables[obj->className()];
-  return getTable(obj->superClass());
+const Codeplug::Context::Table &
+Codeplug::Context::getTable(const QMetaObject *obj) const {
+  static const Table empty;
+  int tid = tableId(obj);
+  if (0 > tid)
+    return empty;
+  return _tables[tid];
 }
 
 bool
 Codeplug::Context::addTable(const QMetaObject *obj) {
   if (hasTable(obj))
     return false;
-  _tables.insert(obj->className(), Table());
+  // Drop resolved types, they may belong to the new table now
+  QHash<const QMetaObject *, int>::iterator id = _tableIds.begin();
+  while (_tableIds.end() != id) {
+    if ((0 > *id) || (_tables[*id].type != id.key()))
+      id = _tableIds.erase(id);
+    else
+      ++id;
+  }
+  _tableIds.insert(obj, _tables.size());
+  _tables.append(Table());
+  _tables.last().type = obj;
   return true;
 }
 
 ConfigItem *
-Codeplug::Context::obj(const QMetaObject *elementType, unsigned idx) {
-  if (! hasTable(elementType))
+Codeplug::Context::obj(const QMetaObject *elementType, unsigned idx) const {
+  int tid = tableId(elementType);
+  if (0 > tid)
     return nullptr;
-  return getTable(elementType).objects.value(idx, nullptr);
+  return _tables[tid].object(idx);
 }
 
 int
-Codeplug::Context::index(ConfigItem *obj) {
+Codeplug::Context::index(ConfigItem *obj) const {
   if (nullptr == obj)
     return -1;
-  if (! hasTable(obj->metaObject()))
+  int tid = tableId(obj->metaObject());
+  if (0 > tid)
     return -1;
-  return getTable(obj->metaObject()).indices.value(obj, -1);
+  return _tables[tid].indices.value(obj, -1);
 }
 
 bool
 Codeplug::Context::add(ConfigItem *obj, unsigned idx) {
-  if (!hasTable(obj->metaObject()))
+  int tid = resolveTable(obj->metaObject());
+  if (0 > tid)
     return false;
-  if (! getTable(obj->metaObject()).indices.contains(obj))
-    getTable(obj->metaObject()).indices.insert(obj, idx);
-  if (! getTable(obj->metaObject()).objects.contains(idx))
-    getTable(obj->metaObject()).objects.insert(idx, obj);
+  Table &table = _tables[tid];
+  if (! table.indices.contains(obj))
+    table.indices.insert(obj, idx);
+  table.insert(idx, obj);
   return true;
 }
 
+void
+Codeplug::Context::Table::insert(unsigned idx, ConfigItem *obj) {
+  // Indices within codeplugs are small, store them densely
+  if (idx < 0x10000) {
+    if (idx >= unsigned(objects.size()))
+      objects.resize(idx+1);
+    if (nullptr == objects[idx])
+      objects[idx] = obj;
+  } else if (! sparse.contains(idx)) {
+    sparse.insert(idx, obj);
+  }
+}
+
 
 /* ********************************************************************************************* *
  * Implementation of CodePlug
  * ********************************************************************************************* */
 Codeplug::Codeplug(QObject *parent)
-  : DFUFile(parent)
+  : DFUFile(parent), _pool(nullptr)
 {
 	// pass...
 }
@@ -670,3 +714,12 @@ Codeplug::Codeplug(QObject *parent)
 Codeplug::~Codeplug() {
 	// pass...
 }
+
+QThreadPool *
+Codeplug::threadPool() const {
+  return _pool;
+}
+void
+Codeplug::setThreadPool(QThreadPool *pool) {
+  _pool = pool;
+}
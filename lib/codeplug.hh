@@ -5,7 +5,11 @@
 #include "dfufile.hh"
 #include "userdatabase.hh"
 #include <QHash>
+#include <QThread>
+#include <functional>
+#include <algorithm>
 #include "config.hh"
+#include "taskgraph.hh"
 
 //class Config;
 class ConfigItem;
@@ -202,10 +206,10 @@ public:
 
     /** Resolves the given index for the specifies element type.
      * @returns @c nullptr if the index is not defined or the type is unknown. */
-    ConfigItem *obj(const QMetaObject *elementType, unsigned idx);
+    ConfigItem *obj(const QMetaObject *elementType, unsigned idx) const;
     /** Returns the index for the given object.
      * @returns -1 if no index is associated with the object or its type is unknown. */
-    int index(ConfigItem *obj);
+    int index(ConfigItem *obj) const;
     /** Associates the given object with the given index. */
     bool add(ConfigItem *obj, unsigned idx);
 
@@ -228,7 +232,7 @@ public:
 
     /** Returns the number of elements for the specified type. */
     template <class T>
-    unsigned int count() {
+    unsigned int count() const {
       return getTable(&T::staticMetaObject).indices.size();
     }
 
@@ -236,21 +240,44 @@ public:
     /** Internal used table type to associate objects and indices. */
     class Table {
     public:
-      /** The index->object map. */
-      QHash<unsigned, ConfigItem *> objects;
+      /** Returns the object for the given index or @c nullptr if not defined. */
+      inline ConfigItem *object(unsigned idx) const {
+        if (idx < unsigned(objects.size()))
+          return objects[idx];
+        return sparse.value(idx, nullptr);
+      }
+      /** Associates the given index with the given object, unless the index is already defined. */
+      void insert(unsigned idx, ConfigItem *obj);
+
+    public:
+      /** The type of the table. */
+      const QMetaObject *type = nullptr;
+      /** The index->object map for small indices, densely stored. */
+      QVector<ConfigItem *> objects;
+      /** The index->object map for large indices. */
+      QHash<unsigned, ConfigItem *> sparse;
       /** The object->index map. */
       QHash<ConfigItem *, unsigned> indices;
     };
 
   protected:
-    /** Returns a reference to the table for the given type. */
-    Table &getTable(const QMetaObject *obj);
+    /** Returns the index of the table for the given type or -1 if there is none. This lookup
+     * never modifies the context and thus may be used concurrently. */
+    int tableId(const QMetaObject *obj) const;
+    /** Same as @c tableId but caches the result for the given type. */
+    int resolveTable(const QMetaObject *obj);
+    /** Returns a reference to the table for the given type or to an empty table if there is none.
+     * This lookup never modifies the context and thus may be used concurrently. */
+    const Table &getTable(const QMetaObject *obj) const;
 
   protected:
     /** A weak reference to the config object. */
     Config *_config;
     /** Table of tables. */
-    QHash<QString, Table> _tables;
+    QVector<Table> _tables;
+    /** Maps types to table indices. Holds the types of the tables as well as the resolved
+     * derived types (-1 if there is no table for a type). */
+    QHash<const QMetaObject *, int> _tableIds;
   };
 
 protected:
@@ -273,6 +300,56 @@ public:
   /** Encodes a given abstract configuration (@c config) to the device specific binary code-plug.
    * This must be implemented by the device-specific codeplug. */
   virtual bool encode(Config *config, const Flags &flags=Flags(), const ErrorStack &err=ErrorStack()) = 0;
+
+  /** Returns the thread pool used for the concurrent encoding and decoding or @c nullptr for the
+   * global one. */
+  QThreadPool *threadPool() const;
+  /** Sets the thread pool used for the concurrent encoding and decoding. The ownership remains with the
+   * caller. If @c nullptr, the global thread pool is used. */
+  void setThreadPool(QThreadPool *pool);
+
+protected:
+  /** Calls @c create for each of the given indices concurrently and stores the created objects
+   * in @c objects in the order of the indices. Objects are created on threads of the codeplug
+   * thread pool and moved (including their references) into the @c target thread (usually the
+   * thread of the config).
+   *
+   * The @c create function must only read the codeplug and must not touch the config or the
+   * context. Adding the objects to the config and context is left to the caller, such that the
+   * result is identical to a serial decoding. On failure, the objects already created get
+   * deleted and @c false is returned. */
+  template <class T>
+  bool createConcurrently(const QVector<unsigned> &indices, QThread *target,
+                          const std::function<T *(unsigned)> &create, QVector<T *> &objects,
+                          const ErrorStack &err=ErrorStack()) const {
+    objects.fill(nullptr, indices.size());
+    T **result = objects.data();
+    // Split indices into chunks, large enough to keep the overhead small
+    int chunk = std::max(32, indices.size()/(4*std::max(1, QThread::idealThreadCount())));
+    TaskGraph tasks;
+    for (int first=0; first<indices.size(); first+=chunk) {
+      int last = std::min(indices.size(), first+chunk);
+      tasks.add([first, last, result, &indices, target, &create](const ErrorStack &err) {
+        Q_UNUSED(err);
+        for (int i=first; i<last; i++) {
+          result[i] = create(indices[i]);
+          if (result[i])
+            result[i]->moveTreeToThread(target);
+        }
+        return true;
+      });
+    }
+    if (! tasks.run(err, threadPool())) {
+      qDeleteAll(objects);
+      objects.fill(nullptr);
+      return false;
+    }
+    return true;
+  }
+
+protected:
+  /** The thread pool used for concurrent encoding and decoding, @c nullptr for the global one. */
+  QThreadPool *_pool;
 };
 
 #endif // CODEPLUG_HH
@@ -6,19 +6,25 @@
 #include "csvreader.hh"
 #include "userdatabase.hh"
 #include "logger.hh"
+#include "textstreambuffer.hh"
+#include "iodevicebuffer.hh"
+#include "yamlconfigreader.hh"
 
 #include <QTextStream>
 #include <QDateTime>
 #include <QFile>
 #include <QMetaProperty>
 #include <cmath>
+#include <ostream>
+#include <istream>
 
 
 /* ********************************************************************************************* *
  * Implementation of Config
  * ********************************************************************************************* */
 Config::Config(QObject *parent)
-  : ConfigItem(parent), _modified(false), _settings(new RadioSettings(this)),
+  : ConfigItem(parent), _modified(false), _updateDepth(0), _pendingModified(false),
+    _settings(new RadioSettings(this)),
     _radioIDs(new RadioIDList(this)), _contacts(new ContactList(this)),
     _rxGroupLists(new RXGroupLists(this)), _channels(new ChannelList(this)),
     _zones(new ZoneList(this)), _scanlists(new ScanLists(this)),
@@ -28,32 +34,50 @@ Config::Config(QObject *parent)
 {
   connect(_settings, SIGNAL(modified(ConfigItem*)), this, SLOT(onConfigModified()));
   connect(_radioIDs, SIGNAL(elementAdded(int)), this, SLOT(onConfigModified()));
+  connect(_radioIDs, SIGNAL(elementsAdded(int,int)), this, SLOT(onConfigModified()));
   connect(_radioIDs, SIGNAL(elementRemoved(int)), this, SLOT(onConfigModified()));
   connect(_radioIDs, SIGNAL(elementModified(int)), this, SLOT(onConfigModified()));
+  connect(_radioIDs, SIGNAL(elementsModified(int,int)), this, SLOT(onConfigModified()));
   connect(_contacts, SIGNAL(elementAdded(int)), this, SLOT(onConfigModified()));
+  connect(_contacts, SIGNAL(elementsAdded(int,int)), this, SLOT(onConfigModified()));
   connect(_contacts, SIGNAL(elementRemoved(int)), this, SLOT(onConfigModified()));
   connect(_contacts, SIGNAL(elementModified(int)), this, SLOT(onConfigModified()));
+  connect(_contacts, SIGNAL(elementsModified(int,int)), this, SLOT(onConfigModified()));
   connect(_rxGroupLists, SIGNAL(elementAdded(int)), this, SLOT(onConfigModified()));
+  connect(_rxGroupLists, SIGNAL(elementsAdded(int,int)), this, SLOT(onConfigModified()));
   connect(_rxGroupLists, SIGNAL(elementRemoved(int)), this, SLOT(onConfigModified()));
   connect(_rxGroupLists, SIGNAL(elementModified(int)), this, SLOT(onConfigModified()));
+  connect(_rxGroupLists, SIGNAL(elementsModified(int,int)), this, SLOT(onConfigModified()));
   connect(_channels, SIGNAL(elementAdded(int)), this, SLOT(onConfigModified()));
+  connect(_channels, SIGNAL(elementsAdded(int,int)), this, SLOT(onConfigModified()));
   connect(_channels, SIGNAL(elementRemoved(int)), this, SLOT(onConfigModified()));
   connect(_channels, SIGNAL(elementModified(int)), this, SLOT(onConfigModified()));
+  connect(_channels, SIGNAL(elementsModified(int,int)), this, SLOT(onConfigModified()));
   connect(_zones, SIGNAL(elementAdded(int)), this, SLOT(onConfigModified()));
+  connect(_zones, SIGNAL(elementsAdded(int,int)), this, SLOT(onConfigModified()));
   connect(_zones, SIGNAL(elementRemoved(int)), this, SLOT(onConfigModified()));
   connect(_zones, SIGNAL(elementModified(int)), this, SLOT(onConfigModified()));
+  connect(_zones, SIGNAL(elementsModified(int,int)), this, SLOT(onConfigModified()));
   connect(_scanlists, SIGNAL(elementAdded(int)), this, SLOT(onConfigModified()));
+  connect(_scanlists, SIGNAL(elementsAdded(int,int)), this, SLOT(onConfigModified()));
   connect(_scanlists, SIGNAL(elementRemoved(int)), this, SLOT(onConfigModified()));
   connect(_scanlists, SIGNAL(elementModified(int)), this, SLOT(onConfigModified()));
+  connect(_scanlists, SIGNAL(elementsModified(int,int)), this, SLOT(onConfigModified()));
   connect(_gpsSystems, SIGNAL(elementAdded(int)), this, SLOT(onConfigModified()));
+  connect(_gpsSystems, SIGNAL(elementsAdded(int,int)), this, SLOT(onConfigModified()));
   connect(_gpsSystems, SIGNAL(elementRemoved(int)), this, SLOT(onConfigModified()));
   connect(_gpsSystems, SIGNAL(elementModified(int)), this, SLOT(onConfigModified()));
+  connect(_gpsSystems, SIGNAL(elementsModified(int,int)), this, SLOT(onConfigModified()));
   connect(_roamingChannels, SIGNAL(elementAdded(int)), this, SLOT(onConfigModified()));
+  connect(_roamingChannels, SIGNAL(elementsAdded(int,int)), this, SLOT(onConfigModified()));
   connect(_roamingChannels, SIGNAL(elementRemoved(int)), this, SLOT(onConfigModified()));
   connect(_roamingChannels, SIGNAL(elementModified(int)), this, SLOT(onConfigModified()));
+  connect(_roamingChannels, SIGNAL(elementsModified(int,int)), this, SLOT(onConfigModified()));
   connect(_roamingZones, SIGNAL(elementAdded(int)), this, SLOT(onConfigModified()));
+  connect(_roamingZones, SIGNAL(elementsAdded(int,int)), this, SLOT(onConfigModified()));
   connect(_roamingZones, SIGNAL(elementRemoved(int)), this, SLOT(onConfigModified()));
   connect(_roamingZones, SIGNAL(elementModified(int)), this, SLOT(onConfigModified()));
+  connect(_roamingZones, SIGNAL(elementsModified(int,int)), this, SLOT(onConfigModified()));
 
   connect(_commercialExtension, SIGNAL(modified(ConfigItem*)), this, SLOT(onConfigModified()));
 }
@@ -97,66 +121,141 @@ Config::setModified(bool modified) {
   _modified = modified;
 }
 
+void
+Config::beginUpdate() {
+  if (0 == _updateDepth++)
+    _pendingModified = false;
+  _radioIDs->beginUpdate();
+  _contacts->beginUpdate();
+  _rxGroupLists->beginUpdate();
+  _channels->beginUpdate();
+  _zones->beginUpdate();
+  _scanlists->beginUpdate();
+  _gpsSystems->beginUpdate();
+  _roamingChannels->beginUpdate();
+  _roamingZones->beginUpdate();
+}
+
+void
+Config::endUpdate() {
+  if (0 == _updateDepth)
+    return;
+  // The range notifications of the lists are coalesced into the pending modification
+  _radioIDs->endUpdate();
+  _contacts->endUpdate();
+  _rxGroupLists->endUpdate();
+  _channels->endUpdate();
+  _zones->endUpdate();
+  _scanlists->endUpdate();
+  _gpsSystems->endUpdate();
+  _roamingChannels->endUpdate();
+  _roamingZones->endUpdate();
+  if ((0 == --_updateDepth) && _pendingModified) {
+    _pendingModified = false;
+    emit modified(this);
+  }
+}
+
+bool
+Config::isUpdating() const {
+  return 0 < _updateDepth;
+}
+
 bool
 Config::toYAML(QTextStream &stream, const ErrorStack &err) {
   ConfigItem::Context context;
   // Label all codeplug elements
   if (! this->label(context, err))
     return false;
-  // Serialize into YAML
-  YAML::Node doc = serialize(context, err);
-  if (doc.IsNull())
-    return false;
-  // Print YAML
-  YAML::Emitter emitter;
-  emitter << YAML::BeginDoc << doc << YAML::EndDoc;
-  stream << QString(emitter.c_str());
-  return true;
-}
 
-bool
-Config::populate(YAML::Node &node, const Context &context, const ErrorStack &err)
-{
-  node["version"] = VERSION_STRING;
+  // Serialize into YAML, element by element. This avoids building the node-tree of the entire
+  // codeplug in memory.
+  TextStreamBuffer buffer(stream);
+  std::ostream ostream(&buffer);
+  YAML::Emitter emitter(ostream);
+  emitter << YAML::BeginDoc << YAML::BeginMap;
+  emitter << YAML::Key << "version" << YAML::Value << VERSION_STRING;
 
-  if ((node["settings"]= _settings->serialize(context, err)).IsNull())
+  YAML::Node settings = serializeSettings(context, err);
+  if (settings.IsNull())
     return false;
+  emitter << YAML::Key << "settings" << YAML::Value << settings;
 
-  if (_radioIDs->defaultId() && context.contains(_radioIDs->defaultId()))
-    node["settings"]["defaultID"] = context.getId(_radioIDs->defaultId()).toStdString();
-
-  if ((node["radioIDs"] = _radioIDs->serialize(context, err)).IsNull())
-    return false;
+  foreach (const ListKey &entry, listKeys()) {
+    if (entry.optional && (0 == entry.list->count()))
+      continue;
+    if (! emitList(emitter, entry.key, entry.list, context, err))
+      return false;
+  }
 
-  if ((node["contacts"] = _contacts->serialize(context, err)).IsNull())
+  // Remaining (small) properties like extensions
+  YAML::Node rest(YAML::NodeType::Map);
+  if (! ConfigItem::populate(rest, context, err))
     return false;
+  for (YAML::const_iterator it=rest.begin(); it!=rest.end(); it++)
+    emitter << YAML::Key << it->first << YAML::Value << it->second;
 
-  if ((node["groupLists"] = _rxGroupLists->serialize(context, err)).IsNull())
+  emitter << YAML::EndMap << YAML::EndDoc;
+  if (! emitter.good()) {
+    errMsg(err) << "Cannot serialize codeplug: " << QString::fromStdString(emitter.GetLastError()) << ".";
     return false;
+  }
+  ostream.flush();
+  return true;
+}
 
-  if ((node["channels"] = _channels->serialize(context, err)).IsNull())
-    return false;
+QVector<Config::ListKey>
+Config::listKeys() const {
+  return QVector<ListKey>{
+    {"radioIDs", _radioIDs, false},
+    {"contacts", _contacts, false},
+    {"groupLists", _rxGroupLists, false},
+    {"channels", _channels, false},
+    {"zones", _zones, false},
+    {"scanLists", _scanlists, true},
+    {"positioning", _gpsSystems, true},
+    {"roamingChannels", _roamingChannels, true},
+    {"roamingZones", _roamingZones, true}
+  };
+}
 
-  if ((node["zones"] = _zones->serialize(context, err)).IsNull())
-    return false;
+YAML::Node
+Config::serializeSettings(const Context &context, const ErrorStack &err) {
+  YAML::Node settings = _settings->serialize(context, err);
+  if (settings.IsNull())
+    return settings;
+  if (_radioIDs->defaultId() && context.contains(_radioIDs->defaultId()))
+    settings["defaultID"] = context.getId(_radioIDs->defaultId()).toStdString();
+  return settings;
+}
 
-  if (_scanlists->count()) {
-    if ((node["scanLists"] = _scanlists->serialize(context, err)).IsNull())
+bool
+Config::emitList(YAML::Emitter &emitter, const char *key, ConfigObjectList *list,
+                 const Context &context, const ErrorStack &err)
+{
+  emitter << YAML::Key << key << YAML::Value << YAML::BeginSeq;
+  for (int i=0; i<list->count(); i++) {
+    YAML::Node node = list->get(i)->serialize(context, err);
+    if (node.IsNull())
       return false;
+    emitter << node;
   }
+  emitter << YAML::EndSeq;
+  return true;
+}
 
-  if (_gpsSystems->count()) {
-    if ((node["positioning"] = _gpsSystems->serialize(context, err)).IsNull())
-      return false;
-  }
+bool
+Config::populate(YAML::Node &node, const Context &context, const ErrorStack &err)
+{
+  node["version"] = VERSION_STRING;
 
-  if (_roamingChannels->count()) {
-    if ((node["roamingChannels"] = _roamingChannels->serialize(context, err)).IsNull())
-      return false;
-  }
+  if ((node["settings"] = serializeSettings(context, err)).IsNull())
+    return false;
 
-  if (_roamingZones->count()) {
-    if ((node["roamingZones"] = _roamingZones->serialize(context, err)).IsNull())
+  foreach (const ListKey &entry, listKeys()) {
+    if (entry.optional && (0 == entry.list->count()))
+      continue;
+    if ((node[entry.key] = entry.list->serialize(context, err)).IsNull())
       return false;
   }
 
@@ -299,6 +398,10 @@ Config::setTyTExtension(TyTConfigExtension *ext) {
 void
 Config::onConfigModified() {
   _modified = true;
+  if (_updateDepth) {
+    _pendingModified = true;
+    return;
+  }
   emit modified(this);
 }
 
@@ -314,7 +417,10 @@ Config::readCSV(const QString &filename, QString &errorMessage) {
 bool
 Config::readCSV(QTextStream &stream, QString &errorMessage)
 {
-  if (CSVReader::read(this, stream, errorMessage))
+  beginUpdate();
+  bool success = CSVReader::read(this, stream, errorMessage);
+  endUpdate();
+  if (success)
     _modified = false;
   else
     return false;
@@ -323,23 +429,9 @@ Config::readCSV(QTextStream &stream, QString &errorMessage)
 
 bool
 Config::readYAML(const QString &filename, const ErrorStack &err) {
-  YAML::Node node;
-  try {
-    QFile file(filename);
-    if (! file.open(QIODevice::ReadOnly)) {
-      errMsg(err) << "Cannot open file '" << filename << "': " << file.errorString() << ".";
-      errMsg(err) << "Cannot read YAML codeplug from file '" << filename << "'.";
-      return false;
-    }
-    QByteArray content = file.readAll();
-    node = YAML::Load(content.constData());
-  } catch (const YAML::Exception &exc) {
-    errMsg(err) << "Cannot read YAML codeplug from file '"<< filename
-                << "': " << QString::fromStdString(exc.msg) << ".";
-    return false;
-  }
-
-  if (! node) {
+  QFile file(filename);
+  if (! file.open(QIODevice::ReadOnly)) {
+    errMsg(err) << "Cannot open file '" << filename << "': " << file.errorString() << ".";
     errMsg(err) << "Cannot read YAML codeplug from file '" << filename << "'.";
     return false;
   }
@@ -347,13 +439,48 @@ Config::readYAML(const QString &filename, const ErrorStack &err) {
   clear();
   ConfigItem::Context context;
 
-  if (! parse(node, context, err))
-    return false;
+  // Coalesce the notifications of all created objects
+  beginUpdate();
+  bool success = false, syntaxError = false;
+  ErrorStack readErr;
+  try {
+    // Read the file in a single pass, creating the elements on the fly
+    IODeviceBuffer buffer(&file);
+    std::istream istream(&buffer);
+    YAMLConfigReader reader(this, context, readErr);
+    success = reader.read(istream);
+  } catch (const YAML::Exception &exc) {
+    errMsg(readErr) << exc.mark.line << ":" << exc.mark.column << ": "
+                    << QString::fromStdString(exc.msg) << ".";
+    syntaxError = true;
+  }
 
-  if (! link(node, context, err))
-    return false;
+  if ((! success) && (! syntaxError)) {
+    // The nodes built by the reader do not carry their location within the document. Load and
+    // read the document again at once, to report the error with its location.
+    clear();
+    ErrorStack locatedErr;
+    try {
+      file.seek(0);
+      IODeviceBuffer buffer(&file);
+      std::istream istream(&buffer);
+      YAML::Node doc = YAML::Load(istream);
+      ConfigItem::Context located;
+      if ((! parse(doc, located, locatedErr)) || (! link(doc, located, locatedErr)))
+        readErr = locatedErr;
+    } catch (const YAML::Exception &) {
+      // pass, keep the error of the reader
+    }
+    clear();
+  }
+  endUpdate();
 
-  return true;
+  if (! success) {
+    err.take(readErr);
+    errMsg(err) << "Cannot read YAML codeplug from file '" << filename << "'.";
+  }
+
+  return success;
 }
 
 bool
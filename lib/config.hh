@@ -95,6 +95,8 @@ class Config : public ConfigItem
   /** Represents the config extension for TyT devices. */
   Q_PROPERTY(TyTConfigExtension* tytExtension READ tytExtension WRITE setTyTExtension)
 
+  friend class YAMLConfigReader;
+
 public:
   /** Constructs an empty configuration. */
   explicit Config(QObject *parent = nullptr);
@@ -107,6 +109,17 @@ public:
   /** Sets the modified flag. */
   void setModified(bool modified);
 
+  /** Starts a batch of modifications, e.g., an import or mass-edit.
+   * Until the matching @c endUpdate call, the @c modified signal of the config is emitted at most
+   * once and the lists signal the modification of their elements once per range using
+   * @c AbstractConfigObjectList::elementsModified. Calls may be nested. */
+  void beginUpdate();
+  /** Ends a batch of modifications started by @c beginUpdate and emits the pending
+   * notifications. */
+  void endUpdate();
+  /** Returns @c true if a batch of modifications is in progress. */
+  bool isUpdating() const;
+
   /** Returns the radio wide settings. */
   RadioSettings *settings() const;
   /** Returns the list of radio IDs. */
@@ -154,18 +167,40 @@ public:
   /** Imports a configuration from the given text stream in text format. */
   bool readCSV(QTextStream &stream, QString &errorMessage);
 
-  /** Imports a configuration from the given YAML file. */
+  /** Imports a configuration from the given YAML file.
+   * The file is read in a single pass, creating the elements while reading (see
+   * @c YAMLConfigReader). Hence, the complete document is never held in memory. */
   bool readYAML(const QString &filename, const ErrorStack &err=ErrorStack());
 
   bool parse(const YAML::Node &node, Context &ctx, const ErrorStack &err=ErrorStack());
   bool link(const YAML::Node &node, const Context &ctx, const ErrorStack &err=ErrorStack());
 
 public:
-  /** Serializes the configuration into the given stream as text. */
+  /** Serializes the configuration into the given stream as text.
+   * The configuration is written element by element, hence the complete YAML document is never
+   * held in memory. On error, the stream may contain a partial document. */
   bool toYAML(QTextStream &stream, const ErrorStack &err=ErrorStack());
 
 protected:
+  /** Associates a top-level YAML key with an element list. */
+  struct ListKey {
+    /** The YAML key. */
+    const char *key;
+    /** The element list. */
+    ConfigObjectList *list;
+    /** If @c true, the key is omitted for empty lists. */
+    bool optional;
+  };
+
   bool populate(YAML::Node &node, const Context &context, const ErrorStack &err=ErrorStack());
+  /** Returns the element lists in document order. Shared by @c populate and @c toYAML, such that
+   * both produce the same document. */
+  QVector<ListKey> listKeys() const;
+  /** Serializes the radio wide settings including the default radio ID. */
+  YAML::Node serializeSettings(const Context &context, const ErrorStack &err=ErrorStack());
+  /** Serializes the elements of the given list one-by-one into the emitter. */
+  bool emitList(YAML::Emitter &emitter, const char *key, ConfigObjectList *list,
+                const Context &context, const ErrorStack &err=ErrorStack());
 
 protected slots:
   /** Iternal callback. */
@@ -174,6 +209,10 @@ protected slots:
 protected:
   /** If @c true, the configuration was modified. */
   bool _modified;
+  /** Nesting depth of @c beginUpdate calls. */
+  int _updateDepth;
+  /** If @c true, the config was modified during the current update. */
+  bool _pendingModified;
   /** Radio wide settings. */
   RadioSettings *_settings;
   /** The list of radio IDs. */
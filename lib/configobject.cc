@@ -7,6 +7,8 @@
 
 #include <QMetaProperty>
 #include <QMetaEnum>
+#include <QReadWriteLock>
+#include <algorithm>
 
 // Helper function to extract key names for a QMetaEnum
 inline QStringList enumKeys(const QMetaEnum &e) {
@@ -34,9 +36,11 @@ QHash<QString, QHash<QString, ConfigObject *>> ConfigObject::Context::_tagObject
     QHash<QString, QHash<QString, ConfigObject *>>();
 QHash<QString, QHash<ConfigObject *, QString>> ConfigObject::Context::_tagNames =
     QHash<QString, QHash<ConfigObject *, QString>>();
+QReadWriteLock ConfigObject::Context::_tagLock;
 
 ConfigItem::Context::Context()
-  : _version(), _objects(), _ids()
+  : _version(), _objects(), _ids(), _counters(), _deferReferences(false), _pending(),
+    _pendingRows()
 {
   // pass...
 }
@@ -83,49 +87,215 @@ ConfigItem::Context::add(const QString &id, ConfigObject *obj) {
   return true;
 }
 
+QString
+ConfigItem::Context::newId(const QString &prefix) {
+  // Continue with the last number used for this prefix. Probing is only needed to skip IDs
+  // that were added explicitly (e.g., read from a file).
+  unsigned &n = _counters[prefix];
+  QString id = prefix + QString::number(++n);
+  while (contains(id))
+    id = prefix + QString::number(++n);
+  return id;
+}
+
 bool
 ConfigItem::Context::hasTag(const QString &className, const QString &property, const QString &tag) {
   QString qname = className+"::"+property;
-  return _tagObjects.contains(qname) && _tagObjects[qname].contains(tag);
+  QReadLocker locker(&_tagLock);
+  return _tagObjects.value(qname).contains(tag);
 }
 
 bool
 ConfigItem::Context::hasTag(const QString &className, const QString &property, ConfigObject *obj) {
   QString qname = className+"::"+property;
-  return _tagNames.contains(qname) && _tagNames[qname].contains(obj);
+  QReadLocker locker(&_tagLock);
+  return _tagNames.value(qname).contains(obj);
 }
 
 ConfigObject *
 ConfigItem::Context::getTag(const QString &className, const QString &property, const QString &tag) {
   //logDebug() << "Request " << tag << " for " << property << " in " << className << ".";
   QString qname = className+"::"+property;
-  if (! _tagObjects.contains(qname))
-    return nullptr;
-  return _tagObjects[qname].value(tag, nullptr);
+  QReadLocker locker(&_tagLock);
+  return _tagObjects.value(qname).value(tag, nullptr);
 }
 
 QString
 ConfigItem::Context::getTag(const QString &className, const QString &property, ConfigObject *obj) {
   //logDebug() << "Request tag for " << property << " in " << className << ".";
   QString qname = className+"::"+property;
-  if (! _tagNames.contains(qname))
-    return nullptr;
-  return _tagNames[qname].value(obj);
+  QReadLocker locker(&_tagLock);
+  return _tagNames.value(qname).value(obj);
 }
 
 void
 ConfigItem::Context::setTag(const QString &className, const QString &property, const QString &tag, ConfigObject *obj) {
   //logDebug() << "Register tag " << tag << " for " << property << " in " << className << ".";
   QString qname = className+"::"+property;
-  if (! _tagObjects.contains(qname))
-    _tagObjects[qname] = QHash<QString, ConfigObject*>();
+  QWriteLocker locker(&_tagLock);
   _tagObjects[qname].insert(tag, obj);
-  if (! _tagNames.contains(qname))
-    _tagNames[qname] = QHash<ConfigObject*, QString>();
   _tagNames[qname].insert(obj, tag);
 }
 
 
+void
+ConfigItem::Context::deferReferences(bool enable) {
+  _deferReferences = enable;
+}
+
+bool
+ConfigItem::Context::defersReferences() const {
+  return _deferReferences;
+}
+
+void
+ConfigItem::Context::deferReference(ConfigObjectReference *ref, const QString &id,
+                                    const QString &name, const YAML::Mark &mark) const
+{
+  _pending.append(PendingReference{ref, nullptr, -1, id, name, mark, Resolver()});
+}
+
+void
+ConfigItem::Context::deferReference(ConfigObjectRefList *list, const QString &id,
+                                    const QString &name, const YAML::Mark &mark) const
+{
+  // References are resolved in order, hence all preceding ones are present by then
+  int row = list->count() + (_pendingRows[list]++);
+  _pending.append(PendingReference{nullptr, list, row, id, name, mark, Resolver()});
+}
+
+void
+ConfigItem::Context::deferReference(ConfigObjectRefList *list, const QString &id,
+                                    const QString &name, const YAML::Mark &mark,
+                                    const Resolver &resolve) const
+{
+  int row = list->count() + (_pendingRows[list]++);
+  _pending.append(PendingReference{nullptr, list, row, id, name, mark, resolve});
+}
+
+unsigned int
+ConfigItem::Context::deferredReferences() const {
+  return _pending.size();
+}
+
+bool
+ConfigItem::Context::resolveReferences(const ErrorStack &err) {
+  QVector<PendingReference> pending;
+  std::swap(pending, _pending);
+  _pendingRows.clear();
+
+  foreach (const PendingReference &item, pending) {
+    if (! contains(item.id)) {
+      errMsg(err) << item.mark.line << ":" << item.mark.column
+                  << ": Cannot link " << item.name << ": Reference '" << item.id << "' not defined.";
+      return false;
+    }
+    ConfigObject *obj = getObj(item.id);
+    if (item.ref && (! item.ref->set(obj))) {
+      errMsg(err) << item.mark.line << ":" << item.mark.column
+                  << ": Cannot link " << item.name << ": Cannot set reference to '" << item.id << "'.";
+      return false;
+    } else if (item.resolve && (! item.resolve(obj, item.row, err))) {
+      errMsg(err) << item.mark.line << ":" << item.mark.column
+                  << ": Cannot link " << item.name << ".";
+      return false;
+    } else if (item.list && (! item.resolve) && (0 > item.list->add(obj, item.row))) {
+      errMsg(err) << item.mark.line << ":" << item.mark.column
+                  << ": Cannot link " << item.name << ": Cannot add reference to '" << item.id
+                  << "' to list.";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of ConfigItem::Schema
+ * ********************************************************************************************* */
+ConfigItem::Schema::Schema(const QMetaObject *meta)
+  : _meta(meta), _properties(),
+    _description(meta->indexOfClassInfo("description")),
+    _longDescription(meta->indexOfClassInfo("longDescription"))
+{
+  for (int p=QObject::staticMetaObject.propertyCount(); p<meta->propertyCount(); p++) {
+    QMetaProperty prop = meta->property(p);
+    if (! prop.isValid())
+      continue;
+
+    Property info;
+    info.prop = prop;
+    info.kind = Kind::Unknown;
+    if (prop.isEnumType()) {
+      info.kind = Kind::Enum;
+    } else if (QVariant::Bool == prop.type()) {
+      info.kind = Kind::Bool;
+    } else if (QVariant::Int == prop.type()) {
+      info.kind = Kind::Int;
+    } else if (QVariant::UInt == prop.type()) {
+      info.kind = Kind::UInt;
+    } else if (QVariant::Double == prop.type()) {
+      info.kind = Kind::Double;
+    } else if (QVariant::String == prop.type()) {
+      info.kind = Kind::String;
+    } else if (0 == strcmp("Frequency", prop.typeName())) {
+      info.kind = Kind::Frequency;
+    } else if (0 == strcmp("Interval", prop.typeName())) {
+      info.kind = Kind::Interval;
+    } else if (QMetaType::UnknownType != prop.userType()) {
+      QMetaType type(prop.userType());
+      const QMetaObject *propType = type.metaObject();
+      if ((QMetaType::PointerToQObject & type.flags()) && propType) {
+        if (propType->inherits(&ConfigObjectReference::staticMetaObject))
+          info.kind = Kind::Reference;
+        else if (propType->inherits(&ConfigObjectRefList::staticMetaObject))
+          info.kind = Kind::RefList;
+        else if (propType->inherits(&ConfigObjectList::staticMetaObject))
+          info.kind = Kind::List;
+        else if (propType->inherits(&ConfigItem::staticMetaObject))
+          info.kind = Kind::Item;
+      }
+    }
+
+    QByteArray name(prop.name());
+    info.description = meta->indexOfClassInfo((name+"Description").constData());
+    info.longDescription = meta->indexOfClassInfo((name+"LongDescription").constData());
+    _properties.append(info);
+  }
+}
+
+const ConfigItem::Schema &
+ConfigItem::Schema::get(const QMetaObject *meta) {
+  static QReadWriteLock lock;
+  static QHash<const QMetaObject *, Schema *> schemata;
+
+  {
+    QReadLocker locker(&lock);
+    if (Schema *schema = schemata.value(meta, nullptr))
+      return *schema;
+  }
+
+  QWriteLocker locker(&lock);
+  if (! schemata.contains(meta))
+    schemata.insert(meta, new Schema(meta));
+  return *schemata[meta];
+}
+
+const ConfigItem::Schema::Property *
+ConfigItem::Schema::property(const QMetaProperty &prop) const {
+  int idx = prop.propertyIndex() - QObject::staticMetaObject.propertyCount();
+  // Properties are stored in order, unless some are invalid
+  if ((0 <= idx) && (idx < _properties.size()) && (0 == strcmp(_properties[idx].prop.name(), prop.name())))
+    return &_properties[idx];
+  for (int i=0; i<_properties.size(); i++) {
+    if (0 == strcmp(_properties[i].prop.name(), prop.name()))
+      return &_properties[i];
+  }
+  return nullptr;
+}
+
+
 /* ********************************************************************************************* *
  * Implementation of ConfigItem
  * ********************************************************************************************* */
@@ -147,53 +317,40 @@ ConfigItem::copy(const ConfigItem &other) {
   // clear this instance
   this->clear();
 
-  // Iterate over all properties
-  const QMetaObject *meta = metaObject();
-  for (int p=QObject::staticMetaObject.propertyCount(); p<meta->propertyCount(); p++) {
-    // This property
-    QMetaProperty prop = meta->property(p);
-    // the same property over at other
-    QMetaProperty oprop = other.metaObject()->property(p);
-
-    // Should never happen
-    if (! prop.isValid()) {
-      logWarn() << "Invalid property " << prop.name() << ". This should not happen.";
-      continue;
-    }
-
-    // true if the property is a basic type
-    bool isBasicType = ( prop.isEnumType() || (QVariant::Bool==prop.type()) ||
-                         (QVariant::Int==prop.type()) || (QVariant::UInt==prop.type()) ||
-                         (QVariant::Double==prop.type()) || (QVariant::String==prop.type()) ||
-                         (QString("Frequency")==prop.typeName()) ||
-                         (QString("Interval")==prop.typeName()) );
+  // Iterate over all properties, other has the same type, hence the same properties
+  foreach (const Schema::Property &info, schema().properties()) {
+    // This property, the same property over at other
+    const QMetaProperty &prop = info.prop, &oprop = info.prop;
 
     // If a basic type -> simply copy value
-    if (isBasicType && prop.isWritable() && (prop.type()==oprop.type())) {
+    if (info.isBasic() && prop.isWritable()) {
       if (! prop.write(this, oprop.read(&other))) {
         logError() << "Cannot set property '" << prop.name() << "' of "
                    << this->metaObject()->className() << ".";
         return false;
       }
-    } else if (ConfigObjectReference *ref = prop.read(this).value<ConfigObjectReference *>()) {
-      if (! ref->copy(oprop.read(&other).value<ConfigObjectReference*>())) {
+    } else if (Schema::Kind::Reference == info.kind) {
+      ConfigObjectReference *ref = prop.read(this).value<ConfigObjectReference *>();
+      if (ref && (! ref->copy(oprop.read(&other).value<ConfigObjectReference*>()))) {
         logError() << "Cannot copy object reference '" << prop.name() << "' of "
                    << this->metaObject()->className() << ".";
         return false;
       }
-    } else if (ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>()) {
-      if (! lst->copy(*oprop.read(&other).value<ConfigObjectList*>())) {
+    } else if (Schema::Kind::List == info.kind) {
+      ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>();
+      if (lst && (! lst->copy(*oprop.read(&other).value<ConfigObjectList*>()))) {
         logError() << "Cannot copy object list '" << prop.name() << "' of "
                    << this->metaObject()->className() << ".";
         return false;
       }
-    } else if (ConfigObjectRefList *lst = prop.read(this).value<ConfigObjectRefList *>()) {
-      if (! lst->copy(*oprop.read(&other).value<ConfigObjectRefList*>())) {
+    } else if (Schema::Kind::RefList == info.kind) {
+      ConfigObjectRefList *lst = prop.read(this).value<ConfigObjectRefList *>();
+      if (lst && (! lst->copy(*oprop.read(&other).value<ConfigObjectRefList*>()))) {
         logError() << "Cannot copy reference list '" << prop.name() << "' of "
                    << this->metaObject()->className() << ".";
         return false;
       }
-    } else if (propIsInstance<ConfigItem>(prop)) {
+    } else if (Schema::Kind::Item == info.kind) {
       // If the item is owned by this item
       if (prop.isWritable()) {
         // If the owned item is writeable -> clone if set in other
@@ -241,71 +398,74 @@ ConfigItem::compare(const ConfigItem &other) const {
     return strcmp(metaObject()->className(), other.metaObject()->className());
 
   // Compare by properties
-  const QMetaObject *meta = metaObject();
-  for (int p=QObject::staticMetaObject.propertyCount(); p<meta->propertyCount(); p++) {
-    // This property
-    QMetaProperty prop = meta->property(p);
-    // the same property over at other
-    QMetaProperty oprop = other.metaObject()->property(p);
-
-    // Should never happen
-    if (! prop.isValid())
-      continue;
+  foreach (const Schema::Property &info, schema().properties()) {
+    // This property, the same property over at other
+    const QMetaProperty &prop = info.prop, &oprop = info.prop;
 
     // Handle comparison of basic types
-    if ((prop.isEnumType()) || (QVariant::Bool == prop.type()) || (QVariant::Int == prop.type()) || (QVariant::UInt == prop.type())) {
+    if ((Schema::Kind::Enum == info.kind) || (Schema::Kind::Bool == info.kind) ||
+        (Schema::Kind::Int == info.kind) || (Schema::Kind::UInt == info.kind)) {
       int a=prop.read(this).toInt(), b=oprop.read(&other).toInt();
       if (a<b) return -1;
       if (a>b) return 1;
       continue;
     }
 
-    if (QVariant::Double == prop.type()) {
+    if (Schema::Kind::Double == info.kind) {
       double a=prop.read(this).toDouble(), b=oprop.read(&other).toDouble();
       if (a<b) return -1;
       if (a>b) return 1;
       continue;
     }
 
-    if (QVariant::String == prop.type()) {
+    if (Schema::Kind::String == info.kind) {
       int cmp = QString::compare(prop.read(this).toString(), oprop.read(&other).toString());
       if (cmp) return cmp;
       continue;
     }
 
-    if (QString("Frequency") == prop.typeName()) {
+    if (Schema::Kind::Frequency == info.kind) {
       Frequency a = prop.read(this).value<Frequency>(), b = oprop.read(&other).value<Frequency>();
       if (a<b) return -1;
       if (b<a) return 1;
       continue;
     }
 
-    if (QString("Interval") == prop.typeName()) {
+    if (Schema::Kind::Interval == info.kind) {
       Interval a = prop.read(this).value<Interval>(), b = oprop.read(&other).value<Interval>();
       if (a<b) return -1;
       if (b<a) return 1;
       continue;
     }
 
-    if (ConfigObjectReference *ref = prop.read(this).value<ConfigObjectReference *>()) {
+    if (Schema::Kind::Reference == info.kind) {
+      ConfigObjectReference *ref = prop.read(this).value<ConfigObjectReference *>();
+      if (nullptr == ref)
+        continue;
       int cmp = ref->compare(*oprop.read(&other).value<ConfigObjectReference*>());
       if (cmp) return cmp;
       continue;
     }
 
-    if (ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>()) {
+    if (Schema::Kind::List == info.kind) {
+      ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>();
+      if (nullptr == lst)
+        continue;
       int cmp = lst->compare(*oprop.read(&other).value<ConfigObjectList*>());
       if (cmp) return cmp;
       continue;
     }
 
-    if (ConfigObjectRefList *lst = prop.read(this).value<ConfigObjectRefList *>()) {
+    if (Schema::Kind::RefList == info.kind) {
+      ConfigObjectRefList *lst = prop.read(this).value<ConfigObjectRefList *>();
+      if (nullptr == lst)
+        continue;
       int cmp = lst->compare(*oprop.read(&other).value<ConfigObjectRefList*>());
       if (cmp) return cmp;
       continue;
     }
 
-    if (propIsInstance<ConfigItem>(prop)) {
+    if (Schema::Kind::Item == info.kind) {
       // If the owned item is writeable -> clone if set in other
       if (prop.read(&other).isNull() && !oprop.read(&other).isNull())
         return -1;
@@ -326,19 +486,14 @@ ConfigItem::compare(const ConfigItem &other) const {
 bool
 ConfigItem::label(ConfigObject::Context &context, const ErrorStack &err) {
   // Label properties owning config objects, that is of type ConfigObject or ConfigObjectList
-  const QMetaObject *meta = metaObject();
-
-  for (int p=QObject::staticMetaObject.propertyCount(); p<meta->propertyCount(); p++) {
-    QMetaProperty prop = meta->property(p);
-    if (! prop.isValid())
-      continue;
-    if (prop.read(this).value<ConfigObjectList *>()) {
-      ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>();
-      if (! lst->label(context, err))
+  foreach (const Schema::Property &info, schema().properties()) {
+    if (Schema::Kind::List == info.kind) {
+      ConfigObjectList *lst = info.prop.read(this).value<ConfigObjectList *>();
+      if (lst && (! lst->label(context, err)))
         return false;
-    } else if (prop.read(this).value<ConfigItem *>()) {
-      ConfigItem *obj = prop.read(this).value<ConfigItem *>();
-      if (! obj->label(context, err))
+    } else if (Schema::Kind::Item == info.kind) {
+      ConfigItem *obj = info.prop.read(this).value<ConfigItem *>();
+      if (obj && (! obj->label(context, err)))
         return false;
     }
   }
@@ -360,37 +515,60 @@ ConfigItem::clear() {
   emit beginClear();
 
   // Delete or clear all object owned by properties, that is ConfigObjectList and ConfigObject
-  const QMetaObject *meta = metaObject();
-  for (int p=QObject::staticMetaObject.propertyCount(); p<meta->propertyCount(); p++) {
-    QMetaProperty prop = meta->property(p);
-    if (! prop.isValid())
-      continue;
-    if (propIsInstance<ConfigItem>(prop) && prop.isWritable()) {
+  foreach (const Schema::Property &info, schema().properties()) {
+    const QMetaProperty &prop = info.prop;
+    if ((Schema::Kind::Item == info.kind) && prop.isWritable()) {
       if (ConfigItem *item = prop.read(this).value<ConfigItem*>())
         item->deleteLater();
       prop.write(this, QVariant::fromValue<ConfigItem*>(nullptr));
-    } else if (ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>()) {
-      lst->clear();
+    } else if (Schema::Kind::List == info.kind) {
+      if (ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>())
+        lst->clear();
     }
   }
 
   emit endClear();
 }
 
+void
+ConfigItem::moveTreeToThread(QThread *thread) {
+  // Only root objects can be moved, children follow their parent
+  if ((nullptr == parent()) && (thread != this->thread()))
+    moveToThread(thread);
+
+  foreach (const Schema::Property &info, schema().properties()) {
+    const QMetaProperty &prop = info.prop;
+    QObject *member = nullptr;
+    if (Schema::Kind::Item == info.kind) {
+      ConfigItem *item = prop.read(this).value<ConfigItem*>();
+      if (item && ((this == item->parent()) || (nullptr == item->parent())))
+        item->moveTreeToThread(thread);
+    } else if (Schema::Kind::Reference == info.kind) {
+      member = prop.read(this).value<ConfigObjectReference *>();
+    } else if (Schema::Kind::List == info.kind) {
+      ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>();
+      member = lst;
+      for (int i=0; lst && (i<lst->count()); i++)
+        lst->get(i)->moveTreeToThread(thread);
+    } else if (Schema::Kind::RefList == info.kind) {
+      member = prop.read(this).value<ConfigObjectRefList *>();
+    }
+    if (member && (nullptr == member->parent()) && (thread != member->thread()))
+      member->moveToThread(thread);
+  }
+}
+
 bool
 ConfigItem::populate(YAML::Node &node, const Context &context, const ErrorStack &err){
   // Serialize all properties
-  const QMetaObject *meta = metaObject();
-  for (int p=QObject::staticMetaObject.propertyCount(); p<meta->propertyCount(); p++) {
-    QMetaProperty prop = meta->property(p);
-    if (! prop.isValid())
-      continue;
+  foreach (const Schema::Property &info, schema().properties()) {
+    const QMetaProperty &prop = info.prop;
     if (! prop.isScriptable()) {
       /*logDebug() << "Do not serialize property '"
                  << prop.name() << "': Marked as not scriptable.";*/
       continue;
     }
-    if (prop.isEnumType()) {
+    if (Schema::Kind::Enum == info.kind) {
       QMetaEnum e = prop.enumerator();
       QVariant value = prop.read(this);
       const char *key = e.valueToKey(value.toInt());
@@ -403,22 +581,23 @@ ConfigItem::populate(YAML::Node &node, const Context &context, const ErrorStack
         continue;
       }
       node[prop.name()] = key;
-    } else if (QString("bool") == prop.typeName()) {
-      node[prop.name()] = this->property(prop.name()).toBool();
-    } else if (QString("int") == prop.typeName()) {
-      node[prop.name()] = this->property(prop.name()).toInt();
-    } else if (QString("uint") == prop.typeName()) {
-      node[prop.name()] = this->property(prop.name()).toUInt();
-    } else if (QString("double") == prop.typeName()) {
-      node[prop.name()] = this->property(prop.name()).toDouble();
-    } else if (QString("QString") == prop.typeName()) {
-      node[prop.name()] = this->property(prop.name()).toString().toStdString();
-    } else if (QString("Frequency") == prop.typeName()) {
-      node[prop.name()] = this->property(prop.name()).value<Frequency>();
-    } else if (QString("Interval") == prop.typeName()) {
-      node[prop.name()] = this->property(prop.name()).value<Interval>();
-    } else if (ConfigObjectReference *ref = prop.read(this).value<ConfigObjectReference *>()) {
-      ConfigObject *obj = ref->as<ConfigObject>();
+    } else if (Schema::Kind::Bool == info.kind) {
+      node[prop.name()] = prop.read(this).toBool();
+    } else if (Schema::Kind::Int == info.kind) {
+      node[prop.name()] = prop.read(this).toInt();
+    } else if (Schema::Kind::UInt == info.kind) {
+      node[prop.name()] = prop.read(this).toUInt();
+    } else if (Schema::Kind::Double == info.kind) {
+      node[prop.name()] = prop.read(this).toDouble();
+    } else if (Schema::Kind::String == info.kind) {
+      node[prop.name()] = prop.read(this).toString().toStdString();
+    } else if (Schema::Kind::Frequency == info.kind) {
+      node[prop.name()] = prop.read(this).value<Frequency>();
+    } else if (Schema::Kind::Interval == info.kind) {
+      node[prop.name()] = prop.read(this).value<Interval>();
+    } else if (Schema::Kind::Reference == info.kind) {
+      ConfigObjectReference *ref = prop.read(this).value<ConfigObjectReference *>();
+      ConfigObject *obj = ref ? ref->as<ConfigObject>() : nullptr;
       if (nullptr == obj)
         continue;
       if (context.hasTag(prop.enclosingMetaObject()->className(), prop.name(), obj)) {
@@ -432,7 +611,10 @@ ConfigItem::populate(YAML::Node &node, const Context &context, const ErrorStack
         return false;
       }
       node[prop.name()] = context.getId(obj).toStdString();
-    } else if (ConfigObjectRefList *refs = prop.read(this).value<ConfigObjectRefList *>()) {
+    } else if (Schema::Kind::RefList == info.kind) {
+      ConfigObjectRefList *refs = prop.read(this).value<ConfigObjectRefList *>();
+      if (nullptr == refs)
+        continue;
       //logDebug() << "Serialize obj ref list w/ " << refs->count() << " elements." ;
       YAML::Node list = YAML::Node(YAML::NodeType::Sequence);
       list.SetStyle(YAML::EmitterStyle::Flow);
@@ -452,14 +634,15 @@ ConfigItem::populate(YAML::Node &node, const Context &context, const ErrorStack
         list.push_back(context.getId(obj).toStdString());
       }
       node[prop.name()] = list;
-    } else if (propIsInstance<ConfigItem>(prop)) {
+    } else if (Schema::Kind::Item == info.kind) {
       ConfigItem *obj = prop.read(this).value<ConfigItem *>();
       // Serialize config objects in-place.
       if (obj)
         node[prop.name()] = obj->serialize(context);
-    } else if (ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>()) {
+    } else if (Schema::Kind::List == info.kind) {
       // Serialize config object lists in-place.
-      node[prop.name()] = lst->serialize(context);
+      if (ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>())
+        node[prop.name()] = lst->serialize(context);
     } else {
       logDebug() << "Unhandled property " << prop.name()
                  << " of unknown type " << prop.typeName() << ".";
@@ -511,11 +694,8 @@ ConfigItem::parse(const YAML::Node &node, ConfigItem::Context &ctx, const ErrorS
   }
 
   const QMetaObject *meta = this->metaObject();
-  for (int p=QObject::staticMetaObject.propertyOffset(); p<meta->propertyCount(); p++) {
-    QMetaProperty prop = meta->property(p);
-
-    if (! prop.isValid())
-      continue;
+  foreach (const Schema::Property &info, schema().properties()) {
+    QMetaProperty prop = info.prop;
     // If marked as non-scriptable, skip that property.
     // It is handled separately or not at all.
     if (! prop.isScriptable())
@@ -524,7 +704,7 @@ ConfigItem::parse(const YAML::Node &node, ConfigItem::Context &ctx, const ErrorS
     /// @todo With Qt 5.15, we can use the REQUIRED flag to check for mandatory properties.
     /// However, Ubuntu 20.04 (Focal) comes with Qt 5.12.
 
-    if (prop.isEnumType()) {
+    if (Schema::Kind::Enum == info.kind) {
       // If property is not set -> skip
       if (! node[prop.name()])
         continue;
@@ -546,7 +726,7 @@ ConfigItem::parse(const YAML::Node &node, ConfigItem::Context &ctx, const ErrorS
       }
       // finally set property
       prop.write(this, value);
-    } else if (QString("bool") == prop.typeName()) {
+    } else if (Schema::Kind::Bool == info.kind) {
       // If property is not set -> skip
       if (! node[prop.name()])
         continue;
@@ -558,7 +738,7 @@ ConfigItem::parse(const YAML::Node &node, ConfigItem::Context &ctx, const ErrorS
         return false;
       }
       prop.write(this, node[prop.name()].as<bool>());
-    } else if (QString("int") == prop.typeName()) {
+    } else if (Schema::Kind::Int == info.kind) {
       // If property is not set -> skip
       if (! node[prop.name()])
         continue;
@@ -570,7 +750,7 @@ ConfigItem::parse(const YAML::Node &node, ConfigItem::Context &ctx, const ErrorS
         return false;
       }
       prop.write(this, node[prop.name()].as<int>());
-    } else if (QString("uint") == prop.typeName()) {
+    } else if (Schema::Kind::UInt == info.kind) {
       // If property is not set -> skip
       if (! node[prop.name()])
         continue;
@@ -582,7 +762,7 @@ ConfigItem::parse(const YAML::Node &node, ConfigItem::Context &ctx, const ErrorS
         return false;
       }
       prop.write(this, node[prop.name()].as<unsigned>());
-    } else if (QString("double") == prop.typeName()) {
+    } else if (Schema::Kind::Double == info.kind) {
       // If property is not set -> skip
       if (! node[prop.name()])
         continue;
@@ -594,7 +774,7 @@ ConfigItem::parse(const YAML::Node &node, ConfigItem::Context &ctx, const ErrorS
         return false;
       }
       prop.write(this, node[prop.name()].as<double>());
-    } else if (QString("QString") == prop.typeName()) {
+    } else if (Schema::Kind::String == info.kind) {
       // If property is not set -> skip
       if (! node[prop.name()])
         continue;
@@ -606,7 +786,7 @@ ConfigItem::parse(const YAML::Node &node, ConfigItem::Context &ctx, const ErrorS
         return false;
       }
       prop.write(this, QString::fromStdString(node[prop.name()].as<std::string>()));
-    } else if (QString("Frequency") == prop.typeName()) {
+    } else if (Schema::Kind::Frequency == info.kind) {
       // If property is not set -> skip
       if (! node[prop.name()])
         continue;
@@ -619,7 +799,7 @@ ConfigItem::parse(const YAML::Node &node, ConfigItem::Context &ctx, const ErrorS
       }
       Frequency f = node[prop.name()].as<Frequency>();
       prop.write(this, QVariant::fromValue(f));
-    } else if (QString("Interval") == prop.typeName()) {
+    } else if (Schema::Kind::Interval == info.kind) {
       // If property is not set -> skip
       if (! node[prop.name()])
         continue;
@@ -631,13 +811,13 @@ ConfigItem::parse(const YAML::Node &node, ConfigItem::Context &ctx, const ErrorS
         return false;
       }
       prop.write(this, QVariant::fromValue(node[prop.name()].as<Interval>()));
-    } else if (prop.read(this).value<ConfigObjectReference *>()) {
+    } else if (Schema::Kind::Reference == info.kind) {
       // references are linked later
       continue;
-    } else if (prop.read(this).value<ConfigObjectRefList *>()) {
+    } else if (Schema::Kind::RefList == info.kind) {
       // reference lists are linked later
       continue;
-    } else if (propIsInstance<ConfigItem>(prop)) {
+    } else if (Schema::Kind::Item == info.kind) {
       if (! node[prop.name()])
         continue;
       // check type
@@ -677,7 +857,7 @@ ConfigItem::parse(const YAML::Node &node, ConfigItem::Context &ctx, const ErrorS
           obj->deleteLater();
         return false;
       }
-    } else if (prop.read(this).value<ConfigObjectList *>()) {
+    } else if (Schema::Kind::List == info.kind) {
       if (! node[prop.name()])
         continue;
       // check type
@@ -746,21 +926,18 @@ ConfigItem::link(const YAML::Node &node, const ConfigItem::Context &ctx, const E
 
   const QMetaObject *meta = this->metaObject();
 
-  for (int p=QObject::staticMetaObject.propertyOffset(); p<meta->propertyCount(); p++) {
-    QMetaProperty prop = meta->property(p);
-    if (! prop.isValid())
-      continue;
-
+  foreach (const Schema::Property &info, schema().properties()) {
+    const QMetaProperty &prop = info.prop;
     if (! prop.isScriptable()) {
       //logDebug() << "Do not link property '" << prop.name() << "': Marked as not scriptable.";
       continue;
     }
-    if ((prop.isEnumType()) || (QString("bool") == prop.typeName()) || (QString("int") == prop.typeName()) ||
-        (QString("uint") == prop.typeName()) || (QString("double") == prop.typeName()) || (QString("QString") == prop.typeName()) ) {
+    if (info.isBasic()) {
       continue;
-    } else if (ConfigObjectReference *ref = prop.read(this).value<ConfigObjectReference *>()) {
+    } else if (Schema::Kind::Reference == info.kind) {
+      ConfigObjectReference *ref = prop.read(this).value<ConfigObjectReference *>();
       // If not set -> skip
-      if (! node[prop.name()])
+      if ((nullptr == ref) || (! node[prop.name()]))
         continue;
       // check type
       if (! node[prop.name()].IsScalar()) {
@@ -782,7 +959,11 @@ ConfigItem::link(const YAML::Node &node, const ConfigItem::Context &ctx, const E
       }
       // set reference
       QString id = QString::fromStdString(node[prop.name()].as<std::string>());
-      if (! ctx.contains(id)) {
+      if ((! ctx.contains(id)) && ctx.defersReferences()) {
+        ctx.deferReference(ref, id, QString("%1 of %2").arg(prop.name()).arg(meta->className()),
+                           node[prop.name()].Mark());
+        continue;
+      } else if (! ctx.contains(id)) {
         errMsg(err) << node[prop.name()].Mark().line << ":" << node[prop.name()].Mark().column
                     << ": Cannot link reference to '" << id << "', element not defined.";
         return false;
@@ -796,9 +977,10 @@ ConfigItem::link(const YAML::Node &node, const ConfigItem::Context &ctx, const E
       /*logDebug() << "Linked reference " << prop.name() << "='" << id
                  << "' to " << ctx.getObj(id)->metaObject()->className()
                  << " '" << ctx.getObj(id)->name() << "'.";*/
-    } else if (ConfigObjectRefList *lst = prop.read(this).value<ConfigObjectRefList *>()) {
+    } else if (Schema::Kind::RefList == info.kind) {
+      ConfigObjectRefList *lst = prop.read(this).value<ConfigObjectRefList *>();
       // If not set -> skip
-      if (! node[prop.name()])
+      if ((nullptr == lst) || (! node[prop.name()]))
         continue;
       // check type
       if (! node[prop.name()].IsSequence()) {
@@ -826,7 +1008,11 @@ ConfigItem::link(const YAML::Node &node, const ConfigItem::Context &ctx, const E
           continue;
         }
         QString id = QString::fromStdString(it->as<std::string>());
-        if (! ctx.contains(id)) {
+        if ((! ctx.contains(id)) && ctx.defersReferences()) {
+          ctx.deferReference(lst, id, QString("%1 of %2").arg(prop.name()).arg(meta->className()),
+                             it->Mark());
+          continue;
+        } else if (! ctx.contains(id)) {
           errMsg(err) << it->Mark().line << ":" << it->Mark().column
                       << ": Cannot link " << prop.name() << " of " << meta->className()
                       << ": Reference '" << id << "' not defined.";
@@ -840,9 +1026,10 @@ ConfigItem::link(const YAML::Node &node, const ConfigItem::Context &ctx, const E
         }
       }
 
-    } else if (ConfigItem *obj = prop.read(this).value<ConfigItem *>()) {
+    } else if (Schema::Kind::Item == info.kind) {
+      ConfigItem *obj = prop.read(this).value<ConfigItem *>();
       // If not set -> skip
-      if (! node[prop.name()])
+      if ((nullptr == obj) || (! node[prop.name()]))
         continue;
 
       // check type
@@ -858,9 +1045,10 @@ ConfigItem::link(const YAML::Node &node, const ConfigItem::Context &ctx, const E
                     << ": Cannot link " << prop.name() << " of " << meta->className() << ".";
         return false;
       }
-    } else if (ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>()) {
+    } else if (Schema::Kind::List == info.kind) {
+      ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>();
       // If not set -> skip
-      if (! node[prop.name()])
+      if ((nullptr == lst) || (! node[prop.name()]))
         continue;
 
       // check type
@@ -895,89 +1083,76 @@ ConfigItem::config() const {
 
 void
 ConfigItem::findItemsOfTypes(const QStringList &typeNames, QSet<ConfigItem *> &items) const {
-  // Do not check yourself
-  const QMetaObject *meta = metaObject();
-
-  // Visit all properties
-  for (int p=QObject::staticMetaObject.propertyCount(); p<meta->propertyCount(); p++) {
-    QMetaProperty prop = meta->property(p);
-    if (! prop.isValid())
-      continue;
-    if (! prop.isReadable())
+  // Visit all properties, do not check yourself
+  foreach (const Schema::Property &info, schema().properties()) {
+    if (! info.prop.isReadable())
       continue;
 
-    if (ConfigItem *obj = prop.read(this).value<ConfigItem *>()) {
-      if (isInstanceOf(obj, typeNames))
-        items.insert(obj);
-      obj->findItemsOfTypes(typeNames, items);
-    } else if (ConfigObjectList *lst = prop.read(this).value<ConfigObjectList *>()) {
-      lst->findItemsOfTypes(typeNames, items);
+    if (Schema::Kind::Item == info.kind) {
+      if (ConfigItem *obj = info.prop.read(this).value<ConfigItem *>()) {
+        if (isInstanceOf(obj, typeNames))
+          items.insert(obj);
+        obj->findItemsOfTypes(typeNames, items);
+      }
+    } else if (Schema::Kind::List == info.kind) {
+      if (ConfigObjectList *lst = info.prop.read(this).value<ConfigObjectList *>())
+        lst->findItemsOfTypes(typeNames, items);
     }
   }
 }
 
 bool
 ConfigItem::hasDescription() const {
-  const QMetaObject *meta = metaObject();
-  return (0 <= meta->indexOfClassInfo("description"));
+  return 0 <= schema().description();
 }
 
 bool
 ConfigItem::hasLongDescription() const {
-  const QMetaObject *meta = metaObject();
-  return (0 <= meta->indexOfClassInfo("longDescription"));
+  return 0 <= schema().longDescription();
 }
 
 bool
 ConfigItem::hasDescription(const QMetaProperty &prop) const {
   if (! prop.isValid())
     return false;
-  QString infoName = QString("%1Description").arg(prop.name());
-  const QMetaObject *meta = metaObject();
-  return (0 <= meta->indexOfClassInfo(infoName.toLocal8Bit().constData()));
+  const Schema::Property *info = schema().property(prop);
+  return info && (0 <= info->description);
 }
 
 bool
 ConfigItem::hasLongDescription(const QMetaProperty &prop) const {
   if (! prop.isValid())
     return false;
-  QString infoName = QString("%1LongDescription").arg(prop.name());
-  const QMetaObject *meta = metaObject();
-  return (0 <= meta->indexOfClassInfo(infoName.toLocal8Bit().constData()));
+  const Schema::Property *info = schema().property(prop);
+  return info && (0 <= info->longDescription);
 }
 
 QString
 ConfigItem::description() const {
   if (! hasDescription())
     return metaObject()->className();
-  const QMetaObject *meta = metaObject();
-  return meta->classInfo(meta->indexOfClassInfo("description")).value();
+  return metaObject()->classInfo(schema().description()).value();
 }
 
 QString
 ConfigItem::longDescription() const {
   if (! hasLongDescription())
     return QString();
-  const QMetaObject *meta = metaObject();
-  return meta->classInfo(meta->indexOfClassInfo("longDescription")).value();
+  return metaObject()->classInfo(schema().longDescription()).value();
 }
 
 QString
 ConfigItem::description(const QMetaProperty &prop) const {
   if (! hasDescription(prop))
     return QString();
-  QString infoName = QString("%1Description").arg(prop.name());
-  const QMetaObject *meta = metaObject();
-  return meta->classInfo(meta->indexOfClassInfo(infoName.toLocal8Bit().constData())).value();
+  return metaObject()->classInfo(schema().property(prop)->description).value();
 }
 
 QString
 ConfigItem::longDescription(const QMetaProperty &prop) const {
   if (! hasLongDescription(prop))
     return QString();
-  QString infoName = QString("%1LongDescription").arg(prop.name());
-  const QMetaObject *meta = metaObject();
-  return meta->classInfo(meta->indexOfClassInfo(infoName.toLocal8Bit().constData())).value();
+  return metaObject()->classInfo(schema().property(prop)->longDescription).value();
 }
 
 
@@ -1016,13 +1191,7 @@ ConfigObject::idPrefix() const {
 
 bool
 ConfigObject::label(ConfigObject::Context &context, const ErrorStack &err) {
-  unsigned n=1;
-  QString prefix = this->idPrefix();
-  QString id=QString("%1%2").arg(prefix).arg(n);
-  while (context.contains(id)) {
-    id=QString("%1%2").arg(prefix).arg(++n);
-  }
-
+  QString id = context.newId(this->idPrefix());
   if (! context.add(id, this)) {
     if (context.contains(this))
       errMsg(err) << "Object already in context with id '" << context.getId(this) << "'.";
@@ -1088,13 +1257,15 @@ ConfigExtension::ConfigExtension(QObject *parent)
  * Implementation of AbstractConfigObjectList
  * ********************************************************************************************* */
 AbstractConfigObjectList::AbstractConfigObjectList(const QMetaObject &elementType, QObject *parent)
-  : QObject(parent), _elementTypes(), _items()
+  : QObject(parent), _elementTypes(), _items(), _indices(), _batchAdd(false), _updateDepth(0),
+    _modifiedFirst(-1), _modifiedLast(-1)
 {
   _elementTypes.append(elementType);
 }
 
 AbstractConfigObjectList::AbstractConfigObjectList(const std::initializer_list<QMetaObject> &elementTypes, QObject *parent)
-  : QObject(parent), _elementTypes(elementTypes), _items()
+  : QObject(parent), _elementTypes(elementTypes), _items(), _indices(), _batchAdd(false),
+    _updateDepth(0), _modifiedFirst(-1), _modifiedLast(-1)
 {
   // pass...
 }
@@ -1115,12 +1286,13 @@ AbstractConfigObjectList::count() const {
 
 int
 AbstractConfigObjectList::indexOf(ConfigObject *obj) const {
-  return _items.indexOf(obj);
+  return _indices.value(obj, -1);
 }
 
 void
 AbstractConfigObjectList::clear() {
   for (int i=(count()-1); i>=0; i--) {
+    _indices.remove(_items.back());
     _items.pop_back();
     emit elementRemoved(i);
   }
@@ -1177,13 +1349,28 @@ int AbstractConfigObjectList::add(ConfigObject *obj, int row) {
     return -1;
   }
   _items.insert(row, obj);
+  updateIndices(row);
   // Otherwise connect to object
   connect(obj, SIGNAL(destroyed(QObject*)), this, SLOT(onElementDeleted(QObject*)));
   connect(obj, SIGNAL(modified(ConfigItem*)), this, SLOT(onElementModified(ConfigItem*)));
-  emit elementAdded(row);
+  if (! _batchAdd)
+    emit elementAdded(row);
   return row;
 }
 
+int
+AbstractConfigObjectList::addAll(const QVector<ConfigObject *> &objs) {
+  int first = count();
+  _batchAdd = true;
+  foreach (ConfigObject *obj, objs)
+    add(obj);
+  _batchAdd = false;
+  int last = count()-1;
+  if (first <= last)
+    emit elementsAdded(first, last);
+  return last-first+1;
+}
+
 bool
 AbstractConfigObjectList::take(ConfigObject *obj) {
   // Ignore nullptr
@@ -1193,6 +1380,8 @@ AbstractConfigObjectList::take(ConfigObject *obj) {
   if (0 > idx)
     return false;
   _items.remove(idx, 1);
+  _indices.remove(obj);
+  updateIndices(idx);
   emit elementRemoved(idx);
   // Otherwise disconnect from
   disconnect(obj, nullptr, this, nullptr);
@@ -1209,6 +1398,8 @@ AbstractConfigObjectList::moveUp(int row) {
   if ((row <= 0) || (row>=count()))
     return false;
   std::swap(_items[row-1], _items[row]);
+  updateIndices(row-1, row);
+  emit elementsMoved(row-1, row);
   return true;
 }
 
@@ -1218,6 +1409,8 @@ AbstractConfigObjectList::moveUp(int first, int last) {
     return false;
   for (int row=first; row<=last; row++)
     std::swap(_items[row-1], _items[row]);
+  updateIndices(first-1, last);
+  emit elementsMoved(first-1, last);
   return true;
 }
 
@@ -1226,6 +1419,8 @@ AbstractConfigObjectList::moveDown(int row) {
   if ((row >= (count()-1)) || (0 > row))
     return false;
   std::swap(_items[row+1], _items[row]);
+  updateIndices(row, row+1);
+  emit elementsMoved(row, row+1);
   return true;
 }
 
@@ -1235,6 +1430,8 @@ AbstractConfigObjectList::moveDown(int first, int last) {
     return false;
   for (int row=last; row>=first; row--)
     std::swap(_items[row+1], _items[row]);
+  updateIndices(first, last+1);
+  emit elementsMoved(first, last+1);
   return true;
 }
 
@@ -1252,11 +1449,39 @@ AbstractConfigObjectList::classNames() const {
   return cls;
 }
 
+void
+AbstractConfigObjectList::beginUpdate() {
+  _updateDepth++;
+}
+
+void
+AbstractConfigObjectList::endUpdate() {
+  if ((0 == _updateDepth) || (0 < --_updateDepth))
+    return;
+  // Elements may have been removed in the meantime
+  int first = _modifiedFirst, last = std::min(_modifiedLast, count()-1);
+  _modifiedFirst = _modifiedLast = -1;
+  if ((0 <= first) && (first <= last))
+    emit elementsModified(first, last);
+}
+
+bool
+AbstractConfigObjectList::isUpdating() const {
+  return 0 < _updateDepth;
+}
+
 void
 AbstractConfigObjectList::onElementModified(ConfigItem *obj) {
   int idx = indexOf(obj->as<ConfigObject>());
-  if (0 >= idx)
-    emit elementModified(idx);
+  if (0 > idx)
+    return;
+  if (_updateDepth) {
+    // Just record the range of modified elements
+    _modifiedFirst = (0 > _modifiedFirst) ? idx : std::min(_modifiedFirst, idx);
+    _modifiedLast = std::max(_modifiedLast, idx);
+    return;
+  }
+  emit elementModified(idx);
 }
 
 void
@@ -1266,10 +1491,20 @@ AbstractConfigObjectList::onElementDeleted(QObject *obj) {
   int idx = indexOf(reinterpret_cast<ConfigObject *>(obj));
   if (0 <= idx) {
     _items.remove(idx);
+    _indices.remove(reinterpret_cast<ConfigObject *>(obj));
+    updateIndices(idx);
     emit elementRemoved(idx);
   }
 }
 
+void
+AbstractConfigObjectList::updateIndices(int first, int last) {
+  if (0 > last)
+    last = _items.size()-1;
+  for (int i=first; i<=last; i++)
+    _indices[_items[i]] = i;
+}
+
 
 /* ********************************************************************************************* *
  * Implementation of ConfigObjectList
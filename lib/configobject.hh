@@ -6,6 +6,9 @@
 #include <QHash>
 #include <QVector>
 #include <QMetaProperty>
+#include <QThread>
+#include <QReadWriteLock>
+#include <functional>
 
 #include <yaml-cpp/yaml.h>
 
@@ -15,6 +18,8 @@
 class Config;
 class ConfigObject;
 class ConfigExtension;
+class ConfigObjectReference;
+class ConfigObjectRefList;
 
 /** Helper function to test property type. */
 template <class T>
@@ -69,6 +74,9 @@ public:
 
     /** Associates the given object with the given ID. */
     virtual bool add(const QString &id, ConfigObject *);
+    /** Returns a new, unused ID with the given prefix. IDs are numbered consecutively per prefix,
+     * hence generating N IDs takes linear time. */
+    QString newId(const QString &prefix);
 
     /** Returns @c true if the property of the class has the specified tag associated. */
     static bool hasTag(const QString &className, const QString &property, const QString &tag);
@@ -81,6 +89,53 @@ public:
     /** Associates the given object with the tag for the property of the given class. */
     static void setTag(const QString &className, const QString &property, const QString &tag, ConfigObject *obj);
 
+    /** If enabled, references to IDs not defined yet are not an error while linking. Instead,
+     * they are recorded and resolved later by @c resolveReferences. This allows to link
+     * objects while reading a document, before all objects are known. Disabled by default. */
+    void deferReferences(bool enable);
+    /** Returns @c true if unresolved references are deferred. */
+    bool defersReferences() const;
+    /** Records a reference to the object with the given ID, to be set by @c resolveReferences.
+     * The context is not modified otherwise, hence this method may be called while linking. */
+    void deferReference(ConfigObjectReference *ref, const QString &id, const QString &name,
+                        const YAML::Mark &mark) const;
+    /** Records a reference to the object with the given ID, to be inserted into the list by
+     * @c resolveReferences at the position it appeared in the document. */
+    void deferReference(ConfigObjectRefList *list, const QString &id, const QString &name,
+                        const YAML::Mark &mark) const;
+    /** Function adding a resolved reference to a list at the given position. */
+    typedef std::function<bool(ConfigObject *obj, int row, const ErrorStack &err)> Resolver;
+    /** Records a reference to the object with the given ID, to be added to the list by calling
+     * @c resolve once the object is defined. Allows items to handle their references themselves
+     * (e.g., converting the referenced object), keeping its position in the document. */
+    void deferReference(ConfigObjectRefList *list, const QString &id, const QString &name,
+                        const YAML::Mark &mark, const Resolver &resolve) const;
+    /** Returns the number of deferred references not resolved yet. */
+    unsigned int deferredReferences() const;
+    /** Resolves all deferred references in the order they were recorded. Fails if any ID is
+     * still undefined. */
+    bool resolveReferences(const ErrorStack &err=ErrorStack());
+
+  protected:
+    /** A reference to an object that was not defined yet. Either @c ref or @c list is set. If
+     * @c resolve is set, it adds the object to the list. */
+    struct PendingReference {
+      /** The reference to set. */
+      ConfigObjectReference *ref;
+      /** The list to insert the reference into. */
+      ConfigObjectRefList *list;
+      /** The position within the list. */
+      int row;
+      /** The ID of the referenced object. */
+      QString id;
+      /** Name of the property and class, for error messages. */
+      QString name;
+      /** Location of the reference in the document. */
+      YAML::Mark mark;
+      /** Adds the object to the list, if set. */
+      Resolver resolve;
+    };
+
   protected:
     /** The version string. */
     QString _version;
@@ -88,10 +143,92 @@ public:
     QHash<QString, ConfigObject *> _objects;
     /** OBJ->ID look-up table. */
     QHash<ConfigObject*, QString> _ids;
+    /** The last number used for each ID prefix. */
+    QHash<QString, unsigned> _counters;
+    /** If @c true, unresolved references are deferred. */
+    bool _deferReferences;
+    /** The deferred references. Recorded while linking, where the context is constant. */
+    mutable QVector<PendingReference> _pending;
+    /** Number of deferred references per list, to compute their final position. */
+    mutable QHash<ConfigObjectRefList *, int> _pendingRows;
     /** Maps tags to singleton objects. */
     static QHash<QString, QHash<QString, ConfigObject *>> _tagObjects;
     /** Maps singleton objects to tags. */
     static QHash<QString, QHash<ConfigObject *, QString>> _tagNames;
+    /** Guards the tags, objects may be created concurrently (e.g., while decoding a codeplug). */
+    static QReadWriteLock _tagLock;
+  };
+
+  /** Reflection information about the properties of a config item class.
+   * The schema is built once per class and shared by all algorithms iterating over the
+   * properties of config items (copy, compare, serialize, parse, link etc.). This avoids
+   * rediscovering the property types for every instance. Schemata are never deleted, hence
+   * references to them remain valid. */
+  class Schema
+  {
+  public:
+    /** The kinds of properties handled by config items. */
+    enum class Kind {
+      Unknown,      ///< Unhandled type.
+      Enum,         ///< Any enum type.
+      Bool,         ///< A boolean value.
+      Int,          ///< A signed integer.
+      UInt,         ///< An unsigned integer.
+      Double,       ///< A double precision float.
+      String,       ///< A string.
+      Frequency,    ///< A @c Frequency value.
+      Interval,     ///< An @c Interval value.
+      Reference,    ///< A @c ConfigObjectReference.
+      RefList,      ///< A @c ConfigObjectRefList.
+      Item,         ///< An owned @c ConfigItem.
+      List          ///< An owned @c ConfigObjectList.
+    };
+
+    /** Cached information about a single property. */
+    class Property {
+    public:
+      /** The property itself. */
+      QMetaProperty prop;
+      /** The kind of the property. */
+      Kind kind;
+      /** Index of the class info "[PropertyName]Description" or -1. */
+      int description;
+      /** Index of the class info "[PropertyName]LongDescription" or -1. */
+      int longDescription;
+
+      /** Returns @c true if the property holds a basic (value) type. */
+      inline bool isBasic() const {
+        return (Kind::Enum <= kind) && (Kind::Interval >= kind);
+      }
+    };
+
+  protected:
+    /** Builds the schema for the given class. */
+    explicit Schema(const QMetaObject *meta);
+
+  public:
+    /** Returns the schema for the given class. Thread-safe. */
+    static const Schema &get(const QMetaObject *meta);
+
+    /** Returns the properties of the class, excluding those of QObject. */
+    inline const QVector<Property> &properties() const { return _properties; }
+    /** Returns the cached information about the given property or @c nullptr if the property
+     * does not belong to this class. */
+    const Property *property(const QMetaProperty &prop) const;
+    /** Returns the index of the class info "description" or -1. */
+    inline int description() const { return _description; }
+    /** Returns the index of the class info "longDescription" or -1. */
+    inline int longDescription() const { return _longDescription; }
+
+  protected:
+    /** The class. */
+    const QMetaObject *_meta;
+    /** The properties. */
+    QVector<Property> _properties;
+    /** Index of the class info "description" or -1. */
+    int _description;
+    /** Index of the class info "longDescription" or -1. */
+    int _longDescription;
   };
 
 protected:
@@ -137,6 +274,11 @@ public:
   /** Clears the config object. */
   virtual void clear();
 
+  /** Moves this item to the given thread. Unlike @c QObject::moveToThread, this also moves all
+   * un-parented members held by properties (references, lists) of this item and of its child
+   * items. Must be called from the thread the item currently lives in. */
+  void moveTreeToThread(QThread *thread);
+
   /** Returns the config, the item belongs to or @c nullptr if not part of a config. */
   virtual const Config *config() const;
   /** Searches the config tree to find all instances of the given type names. */
@@ -160,6 +302,9 @@ public:
     return qobject_cast<Object *>(this);
   }
 
+  /** Returns the property schema of this instance. */
+  inline const Schema &schema() const { return Schema::get(metaObject()); }
+
   /** Returns @c true if there is a class info "description" for this instance. */
   bool hasDescription() const;
   /** Returns @c true if there is a class info "longDescription" for this instance. */
@@ -292,6 +437,10 @@ public:
   virtual ConfigObject *get(int idx) const;
   /** Adds an element to the list. */
   virtual int add(ConfigObject *obj, int row=-1);
+  /** Appends all given elements to the list. In contrast to calling @c add for each element, only
+   * a single @c elementsAdded signal is emitted for the entire range of added elements.
+   * @returns The number of elements added. */
+  virtual int addAll(const QVector<ConfigObject *> &objs);
   /** Removes an element from the list. */
   virtual bool take(ConfigObject *obj);
   /** Removes an element from the list (and deletes it if owned). */
@@ -311,13 +460,31 @@ public:
   /** Returns a list of all class names. */
   QStringList classNames() const;
 
+  /** Starts a batch of modifications. While updating, the modification of elements is not
+   * signaled element by element. Instead, @c endUpdate emits a single @c elementsModified signal
+   * for the range of modified elements. Calls may be nested. */
+  void beginUpdate();
+  /** Ends a batch of modifications started by @c beginUpdate. */
+  void endUpdate();
+  /** Returns @c true if a batch of modifications is in progress. */
+  bool isUpdating() const;
+
 signals:
   /** Gets emitted if an element was added to the list. */
   void elementAdded(int idx);
+  /** Gets emitted if the elements @c first to @c last (inclusive) were added at once using
+   * @c addAll. */
+  void elementsAdded(int first, int last);
   /** Gets emitted if one of the lists elements gets modified. */
   void elementModified(int idx);
+  /** Gets emitted at the end of a batch of modifications, if any of the elements @c first to
+   * @c last (inclusive) were modified. */
+  void elementsModified(int first, int last);
   /** Gets emitted if one of the lists elements gets deleted. */
   void elementRemoved(int idx);
+  /** Gets emitted if the elements @c first to @c last (inclusive) were reordered using
+   * @c moveUp or @c moveDown. */
+  void elementsMoved(int first, int last);
 
 private slots:
   /** Internal used callback to handle modified elements. */
@@ -325,11 +492,26 @@ private slots:
   /** Internal used callback to handle deleted elements. */
   void onElementDeleted(QObject *obj);
 
+private:
+  /** Updates the positions of the items @c first to @c last (inclusive). If @c last is negative,
+   * all items starting at @c first are updated. */
+  void updateIndices(int first, int last=-1);
+
 protected:
   /** Holds the static QMetaObject of the element type. */
   QList<QMetaObject> _elementTypes;
   /** Holds the list items. */
   QVector<ConfigObject *> _items;
+  /** Maps list items to their position within the list. */
+  QHash<ConfigObject *, int> _indices;
+  /** If @c true, @c add does not emit @c elementAdded, used by @c addAll. */
+  bool _batchAdd;
+  /** Nesting depth of @c beginUpdate calls. */
+  int _updateDepth;
+  /** Index of the first element modified during the update or -1. */
+  int _modifiedFirst;
+  /** Index of the last element modified during the update or -1. */
+  int _modifiedLast;
 };
 
 
@@ -36,14 +36,14 @@ ConfigObjectReference::clear() {
 
 bool
 ConfigObjectReference::set(ConfigObject *object) {
-  if (_object)
-    disconnect(_object, SIGNAL(destroyed(QObject*)), this, SLOT(onReferenceDeleted(QObject*)));
-
   if (nullptr == object) {
-    _object = nullptr;
+    clear();
     return true;
   }
 
+  if (_object)
+    disconnect(_object, SIGNAL(destroyed(QObject*)), this, SLOT(onReferenceDeleted(QObject*)));
+
   // Check type
   bool typeCheck = false;
   foreach (const QString &cname, _elementTypes) {
@@ -0,0 +1,490 @@
+#include "configsnapshot.hh"
+#include "config.hh"
+#include "configobject.hh"
+#include "configreference.hh"
+#include "frequency.hh"
+#include "interval.hh"
+#include <QSet>
+
+// Utility function to capture the value of a basic property
+inline QVariant capture_value(const ConfigItem::Schema::Property &info, const ConfigItem *item) {
+  typedef ConfigItem::Schema::Kind Kind;
+  if (Kind::Enum == info.kind)
+    return info.prop.read(item).toInt();
+  if (Kind::Frequency == info.kind)
+    return QVariant::fromValue<qulonglong>(info.prop.read(item).value<Frequency>().inHz());
+  if (Kind::Interval == info.kind)
+    return QVariant::fromValue<qulonglong>(info.prop.read(item).value<Interval>().milliseconds());
+  return info.prop.read(item);
+}
+
+// Utility function to restore the value of a basic property
+inline bool restore_value(const ConfigItem::Schema::Property &info, ConfigItem *item, const QVariant &value) {
+  typedef ConfigItem::Schema::Kind Kind;
+  if (Kind::Frequency == info.kind)
+    return info.prop.write(item, QVariant::fromValue(Frequency::fromHz(value.toULongLong())));
+  if (Kind::Interval == info.kind)
+    return info.prop.write(item, QVariant::fromValue(Interval::fromMilliseconds(value.toULongLong())));
+  return info.prop.write(item, value);
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of ConfigSnapshot::Value and ConfigSnapshot::State
+ * ********************************************************************************************* */
+bool
+ConfigSnapshot::Value::operator==(const Value &other) const {
+  if (value != other.value)
+    return false;
+  if ((item != other.item) && (item.isNull() || other.item.isNull() || !(*item == *other.item)))
+    return false;
+  if (list.size() != other.list.size())
+    return false;
+  for (int i=0; i<list.size(); i++) {
+    if (list.at(i).id != other.list.at(i).id)
+      return false;
+    if ((list.at(i).state != other.list.at(i).state) && !(*list.at(i).state == *other.list.at(i).state))
+      return false;
+  }
+  return true;
+}
+
+bool
+ConfigSnapshot::State::operator==(const State &other) const {
+  return (type == other.type) && (values == other.values);
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of ConfigSnapshot
+ * ********************************************************************************************* */
+ConfigSnapshot::ConfigSnapshot()
+  : _state()
+{
+  // pass...
+}
+
+ConfigSnapshot::ConfigSnapshot(const StatePtr &state)
+  : _state(state)
+{
+  // pass...
+}
+
+bool
+ConfigSnapshot::isNull() const {
+  return _state.isNull();
+}
+
+ConfigSnapshot::StatePtr
+ConfigSnapshot::state() const {
+  return _state;
+}
+
+/** Compares two lists of elements by their IDs. */
+static void
+diffList(const QString &property, const QVector<ConfigSnapshot::Element> &from,
+         const QVector<ConfigSnapshot::Element> &to, QVector<ConfigSnapshot::Difference> &diffs)
+{
+  typedef ConfigSnapshot::Difference::Type Type;
+
+  // Unmodified lists share their elements
+  if (from.constData() == to.constData())
+    return;
+
+  QHash<QString, int> before, after;
+  for (int i=0; i<from.size(); i++)
+    before.insert(from.at(i).id, i);
+  for (int i=0; i<to.size(); i++)
+    after.insert(to.at(i).id, i);
+
+  for (int i=0; i<from.size(); i++) {
+    if (! after.contains(from.at(i).id))
+      diffs.append({Type::Removed, property, from.at(i).id, i});
+  }
+
+  // Elements present in both snapshots must keep their relative order
+  int lastIndex = -1; bool reordered = false;
+  for (int i=0; i<to.size(); i++) {
+    auto prev = before.constFind(to.at(i).id);
+    if (before.constEnd() == prev) {
+      diffs.append({Type::Added, property, to.at(i).id, i});
+      continue;
+    }
+    reordered |= (prev.value() < lastIndex);
+    lastIndex = prev.value();
+    const ConfigSnapshot::StatePtr &a = from.at(prev.value()).state, &b = to.at(i).state;
+    if ((a != b) && !(*a == *b))
+      diffs.append({Type::Modified, property, to.at(i).id, i});
+  }
+
+  if (reordered)
+    diffs.append({Type::Reordered, property, QString(), -1});
+}
+
+QVector<ConfigSnapshot::Difference>
+ConfigSnapshot::diff(const ConfigSnapshot &from, const ConfigSnapshot &to) {
+  QVector<Difference> diffs;
+  if (from.isNull() || to.isNull() || (from._state->type != to._state->type))
+    return diffs;
+
+  const QVector<ConfigItem::Schema::Property> &props =
+      ConfigItem::Schema::get(to._state->type).properties();
+  for (int i=0; i<props.size(); i++) {
+    const Value &a = from._state->values.at(i), &b = to._state->values.at(i);
+    QString name = props.at(i).prop.name();
+    if (ConfigItem::Schema::Kind::List == props.at(i).kind)
+      diffList(name, a.list, b.list, diffs);
+    else if (! (a == b))
+      diffs.append({Difference::Type::Modified, name, QString(), -1});
+  }
+
+  return diffs;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of ConfigSnapshotter
+ * ********************************************************************************************* */
+ConfigSnapshotter::ConfigSnapshotter(Config *config, QObject *parent)
+  : QObject(parent), _config(config), _context(), _ids(), _objects(), _states(), _lists(),
+    _owners(), _captured(0)
+{
+  // pass...
+}
+
+ConfigSnapshot
+ConfigSnapshotter::take() {
+  _captured = 0;
+  if (_config.isNull())
+    return ConfigSnapshot();
+  return ConfigSnapshot(capture(_config.data(), nullptr));
+}
+
+bool
+ConfigSnapshotter::restore(const ConfigSnapshot &snapshot, const ErrorStack &err) {
+  if (_config.isNull() || snapshot.isNull()) {
+    errMsg(err) << "Cannot restore config: Null snapshot or config.";
+    return false;
+  }
+
+  // Re-create deleted elements first, such that references to them can be restored.
+  if (! createElements(*snapshot.state(), err)) {
+    errMsg(err) << "Cannot restore config.";
+    return false;
+  }
+
+  _config->beginUpdate();
+  bool ok = apply(_config.data(), *snapshot.state(), err);
+  _config->endUpdate();
+
+  if (! ok)
+    errMsg(err) << "Cannot restore config.";
+  return ok;
+}
+
+unsigned
+ConfigSnapshotter::captured() const {
+  return _captured;
+}
+
+ConfigObject *
+ConfigSnapshotter::object(const QString &id) const {
+  return _objects.value(id).data();
+}
+
+QString
+ConfigSnapshotter::id(const ConfigObject *obj) {
+  if (nullptr == obj)
+    return QString();
+  auto known = _ids.constFind(obj);
+  if (_ids.constEnd() != known)
+    return known.value();
+
+  QString id = _context.newId(obj->idPrefix());
+  _ids.insert(obj, id);
+  _objects.insert(id, const_cast<ConfigObject *>(obj));
+  connect(obj, SIGNAL(destroyed(QObject*)), this, SLOT(onDeleted(QObject*)), Qt::UniqueConnection);
+  return id;
+}
+
+ConfigSnapshot::StatePtr
+ConfigSnapshotter::capture(const ConfigItem *item, const QObject *owner) {
+  typedef ConfigItem::Schema::Kind Kind;
+
+  QSharedPointer<ConfigSnapshot::State> state(new ConfigSnapshot::State());
+  state->type = item->metaObject();
+  const QVector<ConfigItem::Schema::Property> &props = item->schema().properties();
+  state->values.resize(props.size());
+
+  for (int i=0; i<props.size(); i++) {
+    const ConfigItem::Schema::Property &info = props.at(i);
+    ConfigSnapshot::Value &value = state->values[i];
+    if (Kind::Unknown == info.kind) {
+      continue;
+    } else if (info.isBasic()) {
+      value.value = capture_value(info, item);
+    } else if (Kind::Reference == info.kind) {
+      ConfigObjectReference *ref = info.prop.read(item).value<ConfigObjectReference *>();
+      if (ref && owner)
+        track(ref, SIGNAL(modified()), owner);
+      value.value = id(ref ? ref->as<ConfigObject>() : nullptr);
+    } else if (Kind::RefList == info.kind) {
+      ConfigObjectRefList *lst = info.prop.read(item).value<ConfigObjectRefList *>();
+      if (lst && owner) {
+        track(lst, SIGNAL(elementAdded(int)), owner);
+        track(lst, SIGNAL(elementsAdded(int,int)), owner);
+        track(lst, SIGNAL(elementRemoved(int)), owner);
+        track(lst, SIGNAL(elementsMoved(int,int)), owner);
+      }
+      QStringList ids;
+      for (int j=0; lst && (j<lst->count()); j++)
+        ids.append(id(lst->get(j)));
+      value.value = ids;
+    } else if (Kind::Item == info.kind) {
+      ConfigItem *sub = info.prop.read(item).value<ConfigItem *>();
+      if (sub)
+        value.item = capture(sub, owner);
+    } else if (Kind::List == info.kind) {
+      ConfigObjectList *lst = info.prop.read(item).value<ConfigObjectList *>();
+      if (lst)
+        value.list = captureList(lst, owner);
+    }
+  }
+
+  return state;
+}
+
+QVector<ConfigSnapshot::Element>
+ConfigSnapshotter::captureList(const ConfigObjectList *list, const QObject *owner) {
+  auto cached = _lists.constFind(list);
+  if ((_lists.constEnd() != cached) && cached.value().valid)
+    return cached.value().elements;
+
+  // Modified elements signal their list, hence only structural changes are tracked here.
+  track(list, SIGNAL(elementAdded(int)), owner);
+  track(list, SIGNAL(elementsAdded(int,int)), owner);
+  track(list, SIGNAL(elementRemoved(int)), owner);
+  track(list, SIGNAL(elementsMoved(int,int)), owner);
+
+  QVector<ConfigSnapshot::Element> elements;
+  elements.reserve(list->count());
+  for (int i=0; i<list->count(); i++) {
+    ConfigObject *obj = list->get(i);
+    elements.append({id(obj), captureElement(obj, list)});
+  }
+
+  _lists.insert(list, {elements, true});
+  return elements;
+}
+
+ConfigSnapshot::StatePtr
+ConfigSnapshotter::captureElement(const ConfigObject *obj, const QObject *list) {
+  _owners.insert(obj, list);
+  auto cached = _states.constFind(obj);
+  if (_states.constEnd() != cached)
+    return cached.value();
+
+  ConfigSnapshot::StatePtr state = capture(obj, obj);
+  _states.insert(obj, state);
+  _captured++;
+  track(obj, SIGNAL(modified(ConfigItem*)), list);
+
+  return state;
+}
+
+void
+ConfigSnapshotter::track(const QObject *obj, const char *signal, const QObject *owner) {
+  if (owner)
+    _owners.insert(obj, owner);
+  connect(obj, signal, this, SLOT(onModified()), Qt::UniqueConnection);
+  connect(obj, SIGNAL(destroyed(QObject*)), this, SLOT(onDeleted(QObject*)), Qt::UniqueConnection);
+}
+
+void
+ConfigSnapshotter::invalidate(const QObject *obj) {
+  for (; nullptr != obj; obj = _owners.value(obj, nullptr)) {
+    _states.remove(obj);
+    auto list = _lists.find(obj);
+    if (_lists.end() != list)
+      list.value().valid = false;
+  }
+}
+
+bool
+ConfigSnapshotter::createElements(const ConfigSnapshot::State &state, const ErrorStack &err) {
+  foreach (const ConfigSnapshot::Value &value, state.values) {
+    if (value.item && (! createElements(*value.item, err)))
+      return false;
+    foreach (const ConfigSnapshot::Element &element, value.list) {
+      if (_objects.value(element.id).isNull()) {
+        ConfigObject *obj = qobject_cast<ConfigObject *>(
+              element.state->type->newInstance(Q_ARG(QObject *, this)));
+        if (nullptr == obj) {
+          errMsg(err) << "Cannot re-create element '" << element.id << "' of type "
+                      << element.state->type->className() << ".";
+          return false;
+        }
+        _ids.insert(obj, element.id);
+        _objects.insert(element.id, obj);
+        connect(obj, SIGNAL(destroyed(QObject*)), this, SLOT(onDeleted(QObject*)));
+      }
+      if (! createElements(*element.state, err))
+        return false;
+    }
+  }
+  return true;
+}
+
+bool
+ConfigSnapshotter::apply(ConfigItem *item, const ConfigSnapshot::State &state, const ErrorStack &err) {
+  typedef ConfigItem::Schema::Kind Kind;
+
+  if (item->metaObject() != state.type) {
+    errMsg(err) << "Cannot restore " << state.type->className() << " into "
+                << item->metaObject()->className() << ".";
+    return false;
+  }
+
+  const QVector<ConfigItem::Schema::Property> &props = item->schema().properties();
+  for (int i=0; i<props.size(); i++) {
+    const ConfigItem::Schema::Property &info = props.at(i);
+    const ConfigSnapshot::Value &value = state.values.at(i);
+    if (Kind::Unknown == info.kind) {
+      continue;
+    } else if (info.isBasic()) {
+      if ((! info.prop.isWritable()) || (capture_value(info, item) == value.value))
+        continue;
+      if (! restore_value(info, item, value.value)) {
+        errMsg(err) << "Cannot restore property '" << info.prop.name() << "' of "
+                    << item->metaObject()->className() << ".";
+        return false;
+      }
+    } else if (Kind::Reference == info.kind) {
+      ConfigObjectReference *ref = info.prop.read(item).value<ConfigObjectReference *>();
+      QString target = value.value.toString();
+      if ((nullptr == ref) || (id(ref->as<ConfigObject>()) == target))
+        continue;
+      if (target.isEmpty()) {
+        ref->clear();
+      } else if ((nullptr == object(target)) || (! ref->set(object(target)))) {
+        errMsg(err) << "Cannot restore reference '" << info.prop.name() << "' of "
+                    << item->metaObject()->className() << " to '" << target << "'.";
+        return false;
+      }
+    } else if (Kind::RefList == info.kind) {
+      ConfigObjectRefList *lst = info.prop.read(item).value<ConfigObjectRefList *>();
+      QStringList ids = value.value.toStringList(), current;
+      for (int j=0; lst && (j<lst->count()); j++)
+        current.append(id(lst->get(j)));
+      if ((nullptr == lst) || (current == ids))
+        continue;
+      lst->clear();
+      foreach (const QString &target, ids) {
+        if (0 > lst->add(object(target))) {
+          errMsg(err) << "Cannot restore reference to '" << target << "' in '"
+                      << info.prop.name() << "' of " << item->metaObject()->className() << ".";
+          return false;
+        }
+      }
+    } else if (Kind::Item == info.kind) {
+      ConfigItem *sub = info.prop.read(item).value<ConfigItem *>();
+      if (value.item.isNull()) {
+        if (sub && info.prop.isWritable() &&
+            (! info.prop.write(item, QVariant::fromValue<ConfigItem *>(nullptr)))) {
+          errMsg(err) << "Cannot delete item '" << info.prop.name() << "' of "
+                      << item->metaObject()->className() << ".";
+          return false;
+        }
+      } else if (sub && (sub->metaObject() == value.item->type)) {
+        if (! apply(sub, *value.item, err))
+          return false;
+      } else if (info.prop.isWritable()) {
+        ConfigItem *created = qobject_cast<ConfigItem *>(
+              value.item->type->newInstance(Q_ARG(QObject *, nullptr)));
+        if ((nullptr == created) || (! apply(created, *value.item, err)) ||
+            (! info.prop.write(item, QVariant::fromValue(created)))) {
+          errMsg(err) << "Cannot restore item '" << info.prop.name() << "' of "
+                      << item->metaObject()->className() << ".";
+          if (created)
+            created->deleteLater();
+          return false;
+        }
+      } else {
+        errMsg(err) << "Cannot restore fixed item '" << info.prop.name() << "' of "
+                    << item->metaObject()->className() << ".";
+        return false;
+      }
+    } else if (Kind::List == info.kind) {
+      ConfigObjectList *lst = info.prop.read(item).value<ConfigObjectList *>();
+      if (lst && (! applyList(lst, value.list, err)))
+        return false;
+    }
+  }
+
+  return true;
+}
+
+bool
+ConfigSnapshotter::applyList(ConfigObjectList *list, const QVector<ConfigSnapshot::Element> &elements,
+                             const ErrorStack &err)
+{
+  QVector<ConfigObject *> objs; QSet<ConfigObject *> keep;
+  objs.reserve(elements.size());
+  foreach (const ConfigSnapshot::Element &element, elements) {
+    ConfigObject *obj = object(element.id);
+    if (nullptr == obj) {
+      errMsg(err) << "Cannot restore deleted element '" << element.id << "'.";
+      return false;
+    }
+    objs.append(obj);
+    keep.insert(obj);
+  }
+
+  // Remove elements added since. These are kept by the snapshotter, hence restoring a later
+  // snapshot re-inserts the very same objects.
+  for (int i=list->count()-1; i>=0; i--) {
+    ConfigObject *obj = list->get(i);
+    if (keep.contains(obj))
+      continue;
+    list->take(obj);
+    obj->setParent(this);
+  }
+
+  // Restore order and re-insert removed elements
+  for (int i=0; i<objs.size(); i++) {
+    if (list->get(i) == objs.at(i))
+      continue;
+    if (list->has(objs.at(i)))
+      list->take(objs.at(i));
+    if (0 > list->add(objs.at(i), i)) {
+      errMsg(err) << "Cannot restore element '" << elements.at(i).id << "' of list.";
+      return false;
+    }
+  }
+
+  // Restore elements modified since. An unmodified element still holds the captured state.
+  for (int i=0; i<objs.size(); i++) {
+    if (_states.value(objs.at(i)) == elements.at(i).state)
+      continue;
+    if (! apply(objs.at(i), *elements.at(i).state, err)) {
+      errMsg(err) << "Cannot restore element '" << elements.at(i).id << "'.";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void
+ConfigSnapshotter::onModified() {
+  invalidate(sender());
+}
+
+void
+ConfigSnapshotter::onDeleted(QObject *obj) {
+  // The object is already destroyed, only its address is used here.
+  invalidate(_owners.take(obj));
+  _states.remove(obj);
+  _lists.remove(obj);
+  _ids.remove(obj);
+}
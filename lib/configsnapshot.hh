@@ -0,0 +1,214 @@
+#ifndef CONFIGSNAPSHOT_HH
+#define CONFIGSNAPSHOT_HH
+
+#include <QObject>
+#include <QVariant>
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+#include <QPointer>
+
+#include "configobject.hh"
+
+class Config;
+
+
+/** An immutable snapshot of the state of a configuration.
+ *
+ * A snapshot captures the values of all properties of the config and of all its objects. Each
+ * object is captured in an immutable state, that can be shared between snapshots. Snapshots are
+ * taken by a @c ConfigSnapshotter, which only captures the objects modified since its previous
+ * snapshot.
+ *
+ * Objects are identified by IDs assigned by the snapshotter (e.g., "ch1"). These IDs are stable
+ * for the lifetime of the snapshotter. That is, an object keeps its ID, even if it gets deleted
+ * and is re-created by restoring a snapshot. References between objects are captured by these
+ * IDs. Hence, modifying a referenced object does not modify the state of the referring one.
+ * Snapshots taken by different snapshotters cannot be compared.
+ *
+ * Two snapshots can be compared using @c diff, e.g., to find the lists of the config, that were
+ * modified.
+ *
+ * @ingroup conf */
+class ConfigSnapshot
+{
+public:
+  class State;
+  /** Shared pointer to an immutable state. */
+  typedef QSharedPointer<const State> StatePtr;
+
+  /** An element of a list. */
+  struct Element {
+    /** The ID of the element. */
+    QString id;
+    /** The state of the element. */
+    StatePtr state;
+  };
+
+  /** The captured value of a single property. */
+  struct Value {
+    /** The value of basic properties, the ID of referenced objects or a list of these for
+     * reference lists. */
+    QVariant value;
+    /** The state of an owned item, if set. */
+    StatePtr item;
+    /** The elements of an owned list. */
+    QVector<Element> list;
+
+    /** Compares two values. */
+    bool operator==(const Value &other) const;
+  };
+
+  /** The captured state of a config item. */
+  class State
+  {
+  public:
+    /** The type of the item. */
+    const QMetaObject *type;
+    /** The values of all properties in the order of @c ConfigItem::Schema::properties. */
+    QVector<Value> values;
+
+    /** Compares two states. */
+    bool operator==(const State &other) const;
+  };
+
+  /** Represents a single difference between two snapshots. */
+  struct Difference {
+    /** The kind of difference. */
+    enum class Type {
+      Modified,  ///< A property of the config or a list element was modified.
+      Added,     ///< An element was added to a list.
+      Removed,   ///< An element was removed from a list.
+      Reordered  ///< The elements of a list were reordered.
+    };
+
+    /** The kind of difference. */
+    Type type;
+    /** The name of the config property (e.g., "channels" or "settings"). */
+    QString property;
+    /** The ID of the affected list element or an empty string if the property itself is
+     * affected. See @c ConfigSnapshotter::object. */
+    QString id;
+    /** The index of the affected element within the list of the later snapshot. For removed
+     * elements, the index within the earlier snapshot. Otherwise -1. */
+    int index;
+  };
+
+public:
+  /** Empty constructor, constructs a null snapshot. */
+  ConfigSnapshot();
+
+  /** Returns @c true if the snapshot is null. */
+  bool isNull() const;
+  /** Returns the state of the config itself. */
+  StatePtr state() const;
+
+  /** Returns the differences between the two snapshots. The differences are ordered by the
+   * properties of the config and the positions of the elements. Both snapshots must be taken by
+   * the same snapshotter. */
+  static QVector<Difference> diff(const ConfigSnapshot &from, const ConfigSnapshot &to);
+
+protected:
+  /** Constructs a snapshot from the given state. */
+  explicit ConfigSnapshot(const StatePtr &state);
+
+protected:
+  /** The state of the config. */
+  StatePtr _state;
+
+  friend class ConfigSnapshotter;
+};
+
+
+/** Takes snapshots of a configuration and restores them.
+ *
+ * The snapshotter observes all captured objects, their references and all owned lists. Once an
+ * element gets modified or deleted or one of its references changes, its state is dropped and
+ * captured again with the next snapshot. Likewise, an owned list is only walked again, if an
+ * element was added, removed, moved or modified. All other states are shared with the previous
+ * snapshot, hence taking a snapshot only costs in the number of modified objects. The config
+ * itself and its owned items (e.g., settings) are captured with every snapshot.
+ *
+ * Restoring a snapshot re-creates deleted elements, removes added ones, restores the order of
+ * all owned lists and writes the properties of all elements modified since. The default radio ID
+ * is not a property of the config, hence it is not captured.
+ *
+ * @ingroup conf */
+class ConfigSnapshotter: public QObject
+{
+  Q_OBJECT
+
+public:
+  /** Constructs a snapshotter for the given config. */
+  explicit ConfigSnapshotter(Config *config, QObject *parent=nullptr);
+
+  /** Takes a snapshot of the current state of the config. */
+  ConfigSnapshot take();
+  /** Restores the config to the state of the given snapshot, taken by this snapshotter. */
+  bool restore(const ConfigSnapshot &snapshot, const ErrorStack &err=ErrorStack());
+
+  /** Returns the number of elements captured by the last snapshot. */
+  unsigned captured() const;
+
+  /** Returns the object with the given ID or @c nullptr, if the object was deleted. */
+  ConfigObject *object(const QString &id) const;
+  /** Returns the ID of the given object. Assigns a new ID if the object was not captured yet. */
+  QString id(const ConfigObject *obj);
+
+protected:
+  /** The cached elements of an owned list. */
+  struct ListCache {
+    /** The captured elements. */
+    QVector<ConfigSnapshot::Element> elements;
+    /** If @c false, the list was modified since captured. */
+    bool valid;
+  };
+
+  /** Captures the state of the given item. Modifications of references are tracked for the
+   * given owner (the list element, the item belongs to) or not at all, if @c nullptr. */
+  ConfigSnapshot::StatePtr capture(const ConfigItem *item, const QObject *owner);
+  /** Captures the elements of an owned list, reuses the cached elements if still valid. */
+  QVector<ConfigSnapshot::Element> captureList(const ConfigObjectList *list, const QObject *owner);
+  /** Captures the state of a list element, reuses the cached state if still valid. */
+  ConfigSnapshot::StatePtr captureElement(const ConfigObject *obj, const QObject *list);
+  /** Starts tracking the given object. Once the object gets modified, the states of the object
+   * and of all its owners get dropped. */
+  void track(const QObject *obj, const char *signal, const QObject *owner);
+  /** Drops the cached state of the given object and of all its owners. */
+  void invalidate(const QObject *obj);
+
+  /** Creates the elements of all lists within the given state, that were deleted. */
+  bool createElements(const ConfigSnapshot::State &state, const ErrorStack &err);
+  /** Writes the given state into the item. */
+  bool apply(ConfigItem *item, const ConfigSnapshot::State &state, const ErrorStack &err);
+  /** Restores the elements of the given list. */
+  bool applyList(ConfigObjectList *list, const QVector<ConfigSnapshot::Element> &elements,
+                 const ErrorStack &err);
+
+protected slots:
+  /** Gets called whenever a tracked object gets modified. */
+  void onModified();
+  /** Gets called whenever a tracked object gets deleted. */
+  void onDeleted(QObject *obj);
+
+protected:
+  /** The config. */
+  QPointer<Config> _config;
+  /** Used to assign IDs to the objects. */
+  ConfigItem::Context _context;
+  /** Maps objects to their IDs. */
+  QHash<const QObject *, QString> _ids;
+  /** Maps IDs to their objects. Deleted objects keep their ID. */
+  QHash<QString, QPointer<ConfigObject>> _objects;
+  /** The states of the list elements. */
+  QHash<const QObject *, ConfigSnapshot::StatePtr> _states;
+  /** The elements of the owned lists. */
+  QHash<const QObject *, ListCache> _lists;
+  /** Maps tracked objects to their owner, i.e., elements to their list, references to their
+   * element. */
+  QHash<const QObject *, const QObject *> _owners;
+  /** Number of elements captured by the last snapshot. */
+  unsigned _captured;
+};
+
+#endif // CONFIGSNAPSHOT_HH
@@ -190,7 +190,10 @@ DMRContact::type() const {
 
 void
 DMRContact::setType(DMRContact::Type type) {
+  if (type == _type)
+    return;
   _type = type;
+  emit modified(this);
 }
 
 unsigned
@@ -1,4 +1,17 @@
 #include "crc32.hh"
+#include <QtEndian>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CRC32_HAVE_PCLMUL 1
+#elif defined(__aarch64__) && (defined(__linux__) || defined(__APPLE__))
+#include <arm_acle.h>
+#define CRC32_HAVE_ARMV8 1
+#ifdef __linux__
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
 
 static const uint32_t _crc_table[256] = {
   /* CRC polynomial 0xedb88320 */
@@ -48,6 +61,189 @@ static const uint32_t _crc_table[256] = {
 };
 
 
+/** Signature of the CRC implementations. They take the current CRC state and return the updated
+ * one. */
+typedef uint32_t (*crc_update_t)(uint32_t crc, const uint8_t *buf, size_t n);
+
+/** The tables for the slice-by-8 implementation. The first table is the classic byte-wise table,
+ * the @c k-th table advances the CRC of a byte by another @c k zero bytes. */
+typedef struct {
+  uint32_t table[8][256];
+} crc_slice_tables_t;
+
+static const crc_slice_tables_t &
+crc_slice_tables() {
+  static crc_slice_tables_t tables = []() {
+    crc_slice_tables_t t;
+    for (unsigned i=0; i<256; i++)
+      t.table[0][i] = _crc_table[i];
+    for (unsigned k=1; k<8; k++)
+      for (unsigned i=0; i<256; i++)
+        t.table[k][i] = (t.table[k-1][i] >> 8) ^ _crc_table[t.table[k-1][i] & 0xff];
+    return t;
+  }();
+  return tables;
+}
+
+/** Byte-wise reference implementation. */
+static uint32_t
+crc_update_bytewise(uint32_t crc, const uint8_t *buf, size_t n) {
+  for (size_t i=0; i<n; i++)
+    crc = ( _crc_table[(crc ^ buf[i]) & 0xFF] ^ (crc >> 8) );
+  return crc;
+}
+
+/** Portable slice-by-8 implementation, processes 8 bytes per iteration. */
+static uint32_t
+crc_update_slice8(uint32_t crc, const uint8_t *buf, size_t n) {
+  const uint32_t (&t)[8][256] = crc_slice_tables().table;
+  while (n >= 8) {
+    uint32_t lo = qFromLittleEndian<quint32>(buf) ^ crc;
+    uint32_t hi = qFromLittleEndian<quint32>(buf+4);
+    crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+        t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    buf += 8; n -= 8;
+  }
+  return crc_update_bytewise(crc, buf, n);
+}
+
+#ifdef CRC32_HAVE_PCLMUL
+/** Folds the data using carry-less multiplications, see "Fast CRC Computation for Generic
+ * Polynomials Using PCLMULQDQ Instruction" by Gopal et al. (Intel, 2009). Requires @c n to be at
+ * least 64 and a multiple of 16. */
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t
+crc_fold_pclmul(uint32_t crc, const uint8_t *buf, size_t n) {
+  // Constants for the bit-reflected polynomial 0xedb88320
+  alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+  alignas(16) static const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+  alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+  alignas(16) static const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+
+  __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+  x1 = _mm_loadu_si128((const __m128i *)(buf + 0x00));
+  x2 = _mm_loadu_si128((const __m128i *)(buf + 0x10));
+  x3 = _mm_loadu_si128((const __m128i *)(buf + 0x20));
+  x4 = _mm_loadu_si128((const __m128i *)(buf + 0x30));
+  x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(int(crc)));
+  x0 = _mm_load_si128((const __m128i *)k1k2);
+  buf += 64; n -= 64;
+
+  // Fold 4x128 bits in parallel
+  while (n >= 64) {
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+    x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+    x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+    x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)(buf + 0x00)));
+    x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *)(buf + 0x10)));
+    x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *)(buf + 0x20)));
+    x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *)(buf + 0x30)));
+    buf += 64; n -= 64;
+  }
+
+  // Fold into 128 bits
+  x0 = _mm_load_si128((const __m128i *)k3k4);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+  x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+  x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+  // Fold remaining 128 bit blocks
+  while (n >= 16) {
+    x2 = _mm_loadu_si128((const __m128i *)buf);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    buf += 16; n -= 16;
+  }
+
+  // Fold 128 into 64 bits
+  x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+  x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+  x1 = _mm_srli_si128(x1, 8);
+  x1 = _mm_xor_si128(x1, x2);
+  x0 = _mm_loadl_epi64((const __m128i *)k5k0);
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_and_si128(x1, x3);
+  x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduction to 32 bits
+  x0 = _mm_load_si128((const __m128i *)poly);
+  x2 = _mm_and_si128(x1, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+  x2 = _mm_and_si128(x2, x3);
+  x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  return uint32_t(_mm_extract_epi32(x1, 1));
+}
+
+/** Uses the PCLMULQDQ implementation for the bulk and slice-by-8 for the rest. */
+static uint32_t
+crc_update_pclmul(uint32_t crc, const uint8_t *buf, size_t n) {
+  if (n >= 64) {
+    size_t m = n & ~size_t(15);
+    crc = crc_fold_pclmul(crc, buf, m);
+    buf += m; n -= m;
+  }
+  return crc_update_slice8(crc, buf, n);
+}
+#endif
+
+#ifdef CRC32_HAVE_ARMV8
+#ifdef __clang__
+#define CRC32_TARGET_ARMV8 __attribute__((target("crc")))
+#else
+#define CRC32_TARGET_ARMV8 __attribute__((target("+crc")))
+#endif
+
+/** Uses the ARMv8 CRC32 instructions, processes 8 bytes per instruction. */
+CRC32_TARGET_ARMV8
+static uint32_t
+crc_update_armv8(uint32_t crc, const uint8_t *buf, size_t n) {
+  while (n >= 8) {
+    crc = __crc32d(crc, qFromLittleEndian<quint64>(buf));
+    buf += 8; n -= 8;
+  }
+  while (n--)
+    crc = __crc32b(crc, *buf++);
+  return crc;
+}
+#endif
+
+/** Selects the fastest implementation supported by the CPU. */
+static crc_update_t
+crc_select_update() {
+#ifdef CRC32_HAVE_PCLMUL
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"))
+    return crc_update_pclmul;
+#endif
+#ifdef CRC32_HAVE_ARMV8
+#ifdef __APPLE__
+  // All 64bit Apple CPUs implement the CRC32 instructions
+  return crc_update_armv8;
+#else
+  if (getauxval(AT_HWCAP) & HWCAP_CRC32)
+    return crc_update_armv8;
+#endif
+#endif
+  return crc_update_slice8;
+}
+
+
 CRC32::CRC32()
   : _crc(0xFFFFFFFF)
 {
@@ -61,8 +257,8 @@ CRC32::update(uint8_t c) {
 
 void
 CRC32::update(const uint8_t *buf, size_t n) {
-	for (size_t i=0; i<n; i++)
-    _crc = ( _crc_table[(_crc ^ buf[i]) & 0xFF] ^ (_crc >> 8) );
+  static const crc_update_t impl = crc_select_update();
+  _crc = impl(_crc, buf, n);
 }
 
 void
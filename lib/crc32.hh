@@ -4,6 +4,10 @@
 #include <QByteArray>
 
 /** Implements the CRC32 checksum as used in DFU files.
+ *
+ * Bulk updates use the carry-less multiplication (PCLMULQDQ) or CRC32 instructions of the CPU if
+ * available and fall back to a portable slice-by-8 table implementation otherwise. All
+ * implementations yield identical results.
  *
  * @ingroup util */
 class CRC32
@@ -13,7 +17,7 @@ public:
 	CRC32();
   /** Update CRC with given byte. */
 	void update(uint8_t c);
-  /** Update CRC with given data. */
+  /** Update CRC with given data. Prefer this over the byte-wise update for larger blocks. */
 	void update(const uint8_t *c, size_t n);
   /** Update CRC with given data. */
 	void update(const QByteArray &data);
@@ -1915,22 +1915,36 @@ D578UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStac
 
 bool
 D578UVCodeplug::createChannels(Context &ctx, const ErrorStack &err) {
-  Q_UNUSED(err)
-
   ChannelBitmapElement channel_bitmap(data(Offset::channelBitmap()));
 
-  // Create channels
+  // Collect enabled channels
+  QVector<unsigned> indices;
   for (uint16_t i=0; i<Limit::numChannels(); i++) {
-    // Check if channel is enabled:
+    if (channel_bitmap.isEncoded(i))
+      indices.append(i);
+  }
+
+  // Create channels concurrently
+  QVector<Channel *> channels;
+  if (! createConcurrently<Channel>(
+        indices, ctx.config()->thread(), [this, &ctx](unsigned i) {
     uint16_t bank = i/Limit::channelsPerBank(), idx = i%Limit::channelsPerBank();
-    if (! channel_bitmap.isEncoded(i))
-      continue;
     ChannelElement ch(data(Offset::channelBanks() + bank*Offset::betweenChannelBanks()
                            + idx*ChannelElement::size()));
-    if (Channel *obj = ch.toChannelObj(ctx)) {
-      ctx.config()->channelList()->add(obj); ctx.add(obj, i);
+    return ch.toChannelObj(ctx);
+  }, channels, err)) {
+    errMsg(err) << "Cannot create channels.";
+    return false;
+  }
+
+  // Add them in order
+  QVector<ConfigObject *> objs; objs.reserve(channels.size());
+  for (int j=0; j<indices.size(); j++) {
+    if (Channel *obj = channels[j]) {
+      objs.append(obj); ctx.add(obj, indices[j]);
     }
   }
+  ctx.config()->channelList()->addAll(objs);
   return true;
 }
 
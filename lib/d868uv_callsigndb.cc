@@ -72,6 +72,52 @@ D868UVCallsignDB::EntryElement::fromUser(const UserDatabase::User &user) {
   return size(user);
 }
 
+unsigned
+D868UVCallsignDB::EntryElement::fromUser(const UserDatabase::UserView &user) {
+  typedef UserDatabase::Field Field;
+  clear();
+  setCallType(DMRContact::PrivateCall);
+  setNumber(user.id());
+  setRingTone(RingTone::Off);
+  unsigned addr = 0x0006;
+  addr += writeUTF8(addr, user.utf8(Field::Name), 16) + 1;
+  addr += writeUTF8(addr, user.utf8(Field::City), 15) + 1;
+  addr += writeUTF8(addr, user.utf8(Field::Call), 8) + 1;
+  addr += writeUTF8(addr, user.utf8(Field::State), 16) + 1;
+  addr += writeUTF8(addr, user.utf8(Field::Country), 16) + 1;
+  // no comment but 0x00 terminator
+  setUInt8(addr, 0); addr++;
+  return addr;
+}
+
+unsigned
+D868UVCallsignDB::EntryElement::writeUTF8(unsigned offset, const QByteArray &utf8, unsigned maxlen) {
+  // Decodes the string into UTF-16 code units, just like QString would do. Hence, the number of
+  // characters written matches UserDatabase::UserView::length.
+  const uchar *str = reinterpret_cast<const uchar *>(utf8.constData());
+  unsigned len = 0;
+  for (int i=0; (i<utf8.size()) && (len<maxlen); ) {
+    uchar c = str[i];
+    if (c < 0x80) {
+      _data[offset+len++] = c; i++;
+    } else if (c < 0xe0) {
+      unsigned code = (unsigned(c & 0x1f) << 6) | ((i+1)<utf8.size() ? (str[i+1] & 0x3f) : 0);
+      _data[offset+len++] = (code <= 0xff) ? code : 0x00; i += 2;
+    } else if (c < 0xf0) {
+      // Outside of Latin-1
+      _data[offset+len++] = 0x00; i += 3;
+    } else {
+      // Surrogate pair, outside of Latin-1
+      _data[offset+len++] = 0x00;
+      if (len < maxlen)
+        _data[offset+len++] = 0x00;
+      i += 4;
+    }
+  }
+  _data[offset+len] = 0x00;
+  return len;
+}
+
 unsigned
 D868UVCallsignDB::EntryElement::size(const UserDatabase::User &user) {
   return 6 // header
@@ -83,6 +129,18 @@ D868UVCallsignDB::EntryElement::size(const UserDatabase::User &user) {
       + 1; // no comment but 0x00 terminator
 }
 
+unsigned
+D868UVCallsignDB::EntryElement::size(const UserDatabase::UserView &user) {
+  typedef UserDatabase::Field Field;
+  return 6 // header
+      + std::min(16, user.length(Field::Name))+1 // name
+      + std::min(15, user.length(Field::City))+1 // city
+      + std::min( 8, user.length(Field::Call))+1 // call
+      + std::min(16, user.length(Field::State))+1 // state
+      + std::min(16, user.length(Field::Country))+1 // country
+      + 1; // no comment but 0x00 terminator
+}
+
 
 
 /* ********************************************************************************************* *
@@ -145,98 +203,84 @@ D868UVCallsignDB::D868UVCallsignDB(QObject *parent)
 }
 
 bool D868UVCallsignDB::encode(UserDatabase *db, const Selection &selection, const ErrorStack &err) {
-  Q_UNUSED(err)
+  if (! encodeEntries(db, selection, Limit::entries(), Offset::callsigns(), Offset::limits(), err)) {
+    errMsg(err) << "Cannot encode call-sign DB.";
+    return false;
+  }
+  return true;
+}
 
+bool
+D868UVCallsignDB::encodeEntries(UserDatabase *db, const Selection &selection, unsigned maxEntries,
+                                unsigned callsignsAddr, unsigned limitsAddr, const ErrorStack &err)
+{
   // Determine size of call-sign DB in memory
-  qint64 n = std::min(db->count(), qint64(Limit::entries()));
+  qint64 n = std::min(db->count(), qint64(maxEntries));
   // If DB size is limited by settings
   if (selection.hasCountLimit())
     n = std::min(n, (qint64)selection.countLimit());
 
-  // Select n users and sort them in ascending order of their IDs
-  QVector<UserDatabase::User> users;
-  users.reserve(n);
-  for (unsigned i=0; i<n; i++)
-    users.append(db->user(i));
-  std::sort(users.begin(), users.end(),
-            [](const UserDatabase::User &a, const UserDatabase::User &b) { return a.id < b.id; });
+  // Select n users in ascending order of their IDs
+  QVector<int> users = selectUsers(db, n);
 
-  // Compute total size of callsign db entries
-  size_t dbSize = 0;
-  size_t indexSize = n*IndexEntryElement::size();
+  // Compute the offsets of all entries once. The offset of the entry is not the real memory
+  // offset, but a virtual one without the gaps between the banks.
+  QVector<uint32_t> offsets(n+1);
+  offsets[0] = 0;
   for (qint64 i=0; i<n; i++)
-    dbSize += EntryElement::size(users[i]);
+    offsets[i+1] = offsets[i] + EntryElement::size(db->view(users[i]));
+  size_t dbSize = offsets[n];
+  size_t indexSize = n*IndexEntryElement::size();
 
   // Allocate DB limits
-  image(0).addElement(Offset::limits(), LimitsElement::size());
+  image(0).addElement(limitsAddr, LimitsElement::size());
   // Store DB limits
-  LimitsElement limits(data(Offset::limits()));
+  LimitsElement limits(data(limitsAddr));
   limits.clear();
   limits.setCount(n);
   limits.setTotalSize(dbSize);
 
   // Allocate index banks
+  QVector<uint8_t *> indexBanks;
   for (int i=0; 0<indexSize; i++, indexSize-=std::min(indexSize, size_t(IndexBankElement::size()))) {
     size_t addr = Offset::index() + i*Offset::betweenIndexBanks();
     size_t size = align_size(std::min(indexSize, size_t(IndexBankElement::size())), 16);
     image(0).addElement(addr, size);
     memset(data(addr), 0xff, size);
+    indexBanks.append(data(addr));
   }
 
   // Allocate entry banks
+  QVector<uint8_t *> entryBanks;
   for (int i=0; 0<dbSize; i++, dbSize-=std::min(dbSize, size_t(EntryBankElement::size()))) {
-    size_t addr = Offset::callsigns() + i*Offset::betweenCallsignBanks();
+    size_t addr = callsignsAddr + i*Offset::betweenCallsignBanks();
     size_t size = align_size(std::min(dbSize, size_t(EntryBankElement::size())), 16);
     image(0).addElement(addr, size);
     memset(data(addr), 0x00, size);
+    entryBanks.append(data(addr));
   }
 
-  // Fill index, the offset of the entry is not the real memory offset,
-  // but a virtual one without the gaps.
-  uint32_t entry_offset = 0;
-  uint32_t index_offset = 0;
-  uint32_t index_bank   = 0;
-  for (qint64 i=0; i<n; i++, index_offset+=IndexEntryElement::size()) {
-    if (IndexBankElement::size() <= index_offset) {
-      index_offset = 0; index_bank += 1;
-    }
-    IndexEntryElement index(data(Offset::index()+index_bank*Offset::betweenIndexBanks()+index_offset));
-    index.setID(users[i].id, false);
-    index.setIndex(entry_offset);
-    entry_offset += EntryElement::size(users[i]);
-  }
+  // Fill index and store DB entries. Every entry only touches its own memory, hence the entries
+  // can be encoded concurrently.
+  const unsigned indexEntriesPerBank = IndexBankElement::size()/IndexEntryElement::size();
+  return encodeConcurrently(n, [&](int first, int last) {
+    for (int i=first; i<last; i++) {
+      // Read the fields of the user directly from the database columns
+      UserDatabase::UserView user = db->view(users[i]);
+      IndexEntryElement index(indexBanks[i/indexEntriesPerBank]
+                              + (i%indexEntriesPerBank)*IndexEntryElement::size());
+      index.setID(user.id(), false);
+      index.setIndex(offsets[i]);
 
-  // Then store DB entries
-  uint32_t entry_bank = 0;
-  entry_offset = 0;
-  for (qint64 i=0; i<n; i++) {
-    // Get size of current entry
-    uint32_t entry_size = EntryElement::size(users[i]);
-    // Check if entry fits into bank
-    if (EntryBankElement::size() < (entry_offset+entry_size)) {
-      // If not, split
-      uint8_t buffer[100]; EntryElement(buffer).fromUser(users[i]);
-      uint32_t n1 = (EntryBankElement::size()-entry_offset);
-      uint32_t n2 = entry_size-n1;
-      if (0 != n1) {
-        // Copy first half
-        uint8_t *ptr = data(Offset::callsigns()+entry_bank*Offset::betweenCallsignBanks()+entry_offset);
-        memcpy(ptr, buffer, n1);
+      uint8_t buffer[100];
+      uint32_t entry_size = EntryElement(buffer).fromUser(user);
+      // Copy entry, split it if it does not fit into the current bank
+      for (uint32_t offset=offsets[i], done=0; done<entry_size; ) {
+        uint32_t bank = offset/EntryBankElement::size(), bank_offset = offset%EntryBankElement::size();
+        uint32_t len = std::min(entry_size-done, EntryBankElement::size()-bank_offset);
+        memcpy(entryBanks[bank]+bank_offset, buffer+done, len);
+        done += len; offset += len;
       }
-      // advance bank counter
-      entry_bank++; entry_offset = 0;
-      // copy second half
-      uint8_t *ptr = data(Offset::callsigns()+entry_bank*Offset::betweenCallsignBanks()+entry_offset);
-      memcpy(ptr, buffer+n1, n2);
-      // Update offset
-      entry_offset += n2;
-    } else {
-      // when it fits, just add
-      EntryElement(data(Offset::callsigns()+entry_bank*Offset::betweenCallsignBanks()+entry_offset))
-          .fromUser(users[i]);
-      entry_offset += entry_size;
     }
-  }
-
-  return true;
+  }, err);
 }
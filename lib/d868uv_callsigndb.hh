@@ -71,9 +71,21 @@ public:
     /** Constructs a database entry from the given user.
      * @returns The size of the entry. */
     virtual unsigned fromUser(const UserDatabase::User &user);
+    /** Constructs a database entry from the given view of a user. The fields are read from the
+     * database directly, without copying the user. Gives the same entry as the @c User variant.
+     * @returns The size of the entry. */
+    unsigned fromUser(const UserDatabase::UserView &user);
 
     /** Computes the size of the database entry for the given user. */
     static unsigned size(const UserDatabase::User &user);
+    /** Computes the size of the database entry for the given user. */
+    static unsigned size(const UserDatabase::UserView &user);
+
+  protected:
+    /** Writes at most @c maxlen characters of the given UTF-8 string followed by a 0x00
+     * terminator. Like @c writeASCII, characters outside of Latin-1 are written as 0x00.
+     * @returns The number of characters written, excluding the terminator. */
+    unsigned writeUTF8(unsigned offset, const QByteArray &utf8, unsigned maxlen);
   };
 
   /** Represents a bank of call-sign DB entries. */
@@ -163,6 +175,12 @@ public:
   bool encode(UserDatabase *db, const Selection &selection=Selection(),
               const ErrorStack &err=ErrorStack());
 
+protected:
+  /** Encodes the index, limits and entries of the selected users. The offsets of the entry banks
+   * and the limits differ between the radios. */
+  bool encodeEntries(UserDatabase *db, const Selection &selection, unsigned maxEntries,
+                     unsigned callsignsAddr, unsigned limitsAddr, const ErrorStack &err=ErrorStack());
+
 public:
   /** Some limits for the call-sign DB. */
   struct Limit {
@@ -1409,40 +1409,48 @@ D868UVCodeplug::setBitmaps(Context& ctx)
 bool
 D868UVCodeplug::encodeElements(const Flags &flags, Context &ctx, const ErrorStack &err)
 {
-  if (! this->encodeRadioID(flags, ctx, err))
-    return false;
-
-  if (! this->encodeGeneralSettings(flags, ctx, err))
-    return false;
-
-  if (! this->encodeRepeaterOffsetFrequencies(flags, ctx, err))
-    return false;
-
-  if (! this->encodeBootSettings(flags, ctx, err))
-    return false;
-
-  if (! this->encodeChannels(flags, ctx, err))
-    return false;
-
-  if (! this->encodeContacts(flags, ctx, err))
-    return false;
-
-  if (! this->encodeAnalogContacts(flags, ctx, err))
-    return false;
-
-  if (! this->encodeRXGroupLists(flags, ctx, err))
-    return false;
-
-  if (! this->encodeZones(flags, ctx, err))
-    return false;
-
-  if (! this->encodeScanLists(flags, ctx, err))
-    return false;
-
-  if (! this->encodeGPSSystems(flags, ctx, err))
-    return false;
+  TaskGraph tasks;
+  this->addEncodingTasks(tasks, flags, ctx);
+  return tasks.run(err, threadPool());
+}
 
-  return true;
+void
+D868UVCodeplug::addEncodingTasks(TaskGraph &tasks, const Flags &flags, Context &ctx) {
+  // All elements are encoded into separate memory regions and the context is complete, once the
+  // codeplug got indexed. Hence there are no dependencies between these tasks.
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeRadioID(flags, ctx, err);
+  });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeGeneralSettings(flags, ctx, err);
+  });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeRepeaterOffsetFrequencies(flags, ctx, err);
+  });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeBootSettings(flags, ctx, err);
+  });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeChannels(flags, ctx, err);
+  });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeContacts(flags, ctx, err);
+  });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeAnalogContacts(flags, ctx, err);
+  });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeRXGroupLists(flags, ctx, err);
+  });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeZones(flags, ctx, err);
+  });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeScanLists(flags, ctx, err);
+  });
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeGPSSystems(flags, ctx, err);
+  });
 }
 
 bool
@@ -1541,21 +1549,36 @@ D868UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStac
 
 bool
 D868UVCodeplug::createChannels(Context &ctx, const ErrorStack &err) {
-  Q_UNUSED(err)
   ChannelBitmapElement channel_bitmap(data(Offset::channelBitmap()));
 
-  // Create channels
+  // Collect enabled channels
+  QVector<unsigned> indices;
   for (uint16_t i=0; i<Limit::numChannels(); i++) {
-    // Check if channel is enabled:
+    if (channel_bitmap.isEncoded(i))
+      indices.append(i);
+  }
+
+  // Create channels concurrently
+  QVector<Channel *> channels;
+  if (! createConcurrently<Channel>(
+        indices, ctx.config()->thread(), [this, &ctx](unsigned i) {
     uint16_t bank = i/Limit::channelsPerBank(), idx = i%Limit::channelsPerBank();
-    if (! channel_bitmap.isEncoded(i))
-      continue;
     ChannelElement ch(data(Offset::channelBanks() + bank*Offset::betweenChannelBanks()
                            + idx*ChannelElement::size()));
-    if (Channel *obj = ch.toChannelObj(ctx)) {
-      ctx.config()->channelList()->add(obj); ctx.add(obj, i);
+    return ch.toChannelObj(ctx);
+  }, channels, err)) {
+    errMsg(err) << "Cannot create channels.";
+    return false;
+  }
+
+  // Add them in order
+  QVector<ConfigObject *> objs; objs.reserve(channels.size());
+  for (int j=0; j<indices.size(); j++) {
+    if (Channel *obj = channels[j]) {
+      objs.append(obj); ctx.add(obj, indices[j]);
     }
   }
+  ctx.config()->channelList()->addAll(objs);
   return true;
 }
 
@@ -1644,21 +1667,35 @@ D868UVCodeplug::encodeContacts(const Flags &flags, Context &ctx, const ErrorStac
 
 bool
 D868UVCodeplug::createContacts(Context &ctx, const ErrorStack &err) {
-  Q_UNUSED(err)
-
-  // Create digital contacts
+  // Collect enabled digital contacts
   ContactBitmapElement contact_bitmap(data(Offset::contactBitmap()));
+  QVector<unsigned> indices;
   for (uint16_t i=0; i<Limit::numContacts(); i++) {
-    // Check if contact is enabled:
-    if (! contact_bitmap.isEncoded(i))
-      continue;
+    if (contact_bitmap.isEncoded(i))
+      indices.append(i);
+  }
+
+  // Create digital contacts concurrently
+  QVector<DMRContact *> contacts;
+  if (! createConcurrently<DMRContact>(
+        indices, ctx.config()->thread(), [this, &ctx](unsigned i) {
     uint32_t bank_addr = Offset::contactBanks() + (i/Limit::contactsPerBank())*Offset::betweenContactBanks();
     uint32_t addr = bank_addr + (i%Limit::contactsPerBank())*ContactElement::size();
     ContactElement con(data(addr));
-    if (DMRContact *obj = con.toContactObj(ctx)) {
-      ctx.config()->contacts()->add(obj); ctx.add(obj, i);
+    return con.toContactObj(ctx);
+  }, contacts, err)) {
+    errMsg(err) << "Cannot create digital contacts.";
+    return false;
+  }
+
+  // Add them in order
+  QVector<ConfigObject *> objs; objs.reserve(contacts.size());
+  for (int j=0; j<indices.size(); j++) {
+    if (DMRContact *obj = contacts[j]) {
+      objs.append(obj); ctx.add(obj, indices[j]);
     }
   }
+  ctx.config()->contacts()->addAll(objs);
   return true;
 }
 
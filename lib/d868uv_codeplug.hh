@@ -4,6 +4,7 @@
 #include <QDateTime>
 
 #include "anytone_codeplug.hh"
+#include "taskgraph.hh"
 #include "signaling.hh"
 
 class Channel;
@@ -654,6 +655,11 @@ protected:
   virtual bool encodeElements(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
   virtual bool decodeElements(Context &ctx, const ErrorStack &err=ErrorStack());
 
+  /** Adds the tasks encoding the elements to the given graph. Once allocated, the elements are
+   * encoded into disjoint memory regions and the context is only read. Hence the tasks may run
+   * concurrently, unless they depend on each other. */
+  virtual void addEncodingTasks(TaskGraph &tasks, const Flags &flags, Context &ctx);
+
   /** Allocate channels from bitmap. */
   virtual void allocateChannels();
   /** Encode channels into codeplug. */
@@ -3432,17 +3432,19 @@ D878UVCodeplug::setBitmaps(Context& ctx)
   roaming_ch_bitmap.clear(); roaming_ch_bitmap.enableFirst(num_roaming_channel);
 }
 
-bool
-D878UVCodeplug::encodeElements(const Flags &flags, Context &ctx, const ErrorStack &err)
-{
+void
+D878UVCodeplug::addEncodingTasks(TaskGraph &tasks, const Flags &flags, Context &ctx) {
   // Encode everything common between d868uv and d878uv radios.
-  if (! D868UVCodeplug::encodeElements(flags, ctx, err))
-    return false;
+  D868UVCodeplug::addEncodingTasks(tasks, flags, ctx);
 
-  if (! this->encodeRoaming(flags, ctx, err))
-    return false;
-
-  return true;
+  // Encoding roaming channels may extend the context, hence it must not run concurrently with
+  // tasks reading it.
+  QList<int> dependencies;
+  for (int i=0; i<tasks.count(); i++)
+    dependencies.append(i);
+  tasks.add([this, &flags, &ctx](const ErrorStack &err) {
+    return this->encodeRoaming(flags, ctx, err);
+  }, dependencies);
 }
 
 
@@ -3500,21 +3502,36 @@ D878UVCodeplug::encodeChannels(const Flags &flags, Context &ctx, const ErrorStac
 
 bool
 D878UVCodeplug::createChannels(Context &ctx, const ErrorStack &err) {
-  Q_UNUSED(err)
-
-  // Create channels
   ChannelBitmapElement channel_bitmap(data(Offset::channelBitmap()));
+
+  // Collect enabled channels
+  QVector<unsigned> indices;
   for (uint16_t i=0; i<Limit::numChannels(); i++) {
-    // Check if channel is enabled:
+    if (channel_bitmap.isEncoded(i))
+      indices.append(i);
+  }
+
+  // Create channels concurrently
+  QVector<Channel *> channels;
+  if (! createConcurrently<Channel>(
+        indices, ctx.config()->thread(), [this, &ctx](unsigned i) {
     uint16_t bank = i/Limit::channelsPerBank(), idx = i%Limit::channelsPerBank();
-    if (! channel_bitmap.isEncoded(i))
-      continue;
     ChannelElement ch(data(Offset::channelBanks() + bank*Offset::betweenChannelBanks()
                            + idx*ChannelElement::size()));
-    if (Channel *obj = ch.toChannelObj(ctx)) {
-      ctx.config()->channelList()->add(obj); ctx.add(obj, i);
+    return ch.toChannelObj(ctx);
+  }, channels, err)) {
+    errMsg(err) << "Cannot create channels.";
+    return false;
+  }
+
+  // Add them in order
+  QVector<ConfigObject *> objs; objs.reserve(channels.size());
+  for (int j=0; j<indices.size(); j++) {
+    if (Channel *obj = channels[j]) {
+      objs.append(obj); ctx.add(obj, indices[j]);
     }
   }
+  ctx.config()->channelList()->addAll(objs);
   return true;
 }
 
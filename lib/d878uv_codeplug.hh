@@ -1891,7 +1891,7 @@ protected:
   void allocateForEncoding();
 
   bool decodeElements(Context &ctx, const ErrorStack &err=ErrorStack());
-  bool encodeElements(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
+  void addEncodingTasks(TaskGraph &tasks, const Flags &flags, Context &ctx);
 
   void allocateChannels();
   bool encodeChannels(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
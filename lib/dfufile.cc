@@ -1,6 +1,16 @@
 #include "dfufile.hh"
 #include <QFile>
 #include <QtEndian>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <sys/uio.h>
+#include <limits.h>
+#include <errno.h>
+#endif
 
 #include "crc32.hh"
 #include "logger.hh"
@@ -39,15 +49,139 @@ typedef struct __attribute((packed)) {
 } element_prefix_t;
 
 
+/* ********************************************************************************************* *
+ * Implementation of DFUFile::Writer
+ * ********************************************************************************************* */
+class DFUFile::Writer
+{
+public:
+  /** Constructs an empty writer. */
+  Writer();
+
+  /** Appends a header. The header gets copied. */
+  void header(const void *data, qint64 size, bool updateCRC=true);
+  /** Appends some data. The data is not copied and must outlive the writer. */
+  void data(const void *data, qint64 size);
+  /** Returns the current CRC. */
+  uint32_t crc();
+  /** Writes all chunks to the given file at once. */
+  bool flush(QFile &file, QString &errorMessage);
+
+protected:
+  /** A single chunk of the serialized file. */
+  struct Chunk {
+    const char *data; ///< Points to the data or @c nullptr, if the chunk is held in the headers.
+    qint64 offset;    ///< Offset of the chunk within the header buffer.
+    qint64 size;      ///< Size of the chunk.
+  };
+
+protected:
+  /** Holds all headers. */
+  QByteArray _headers;
+  /** The sequence of chunks. */
+  QVector<Chunk> _chunks;
+  /** The CRC over all chunks. */
+  CRC32 _crc;
+};
+
+DFUFile::Writer::Writer()
+  : _headers(), _chunks(), _crc()
+{
+  // pass...
+}
+
+void
+DFUFile::Writer::header(const void *data, qint64 size, bool updateCRC) {
+  if (0 >= size)
+    return;
+  if (updateCRC)
+    _crc.update((const uint8_t *)data, size);
+  // Merge consecutive headers into a single chunk
+  if (_chunks.size() && (nullptr == _chunks.last().data))
+    _chunks.last().size += size;
+  else
+    _chunks.append(Chunk{nullptr, _headers.size(), size});
+  _headers.append((const char *)data, size);
+}
+
+void
+DFUFile::Writer::data(const void *data, qint64 size) {
+  if (0 >= size)
+    return;
+  _crc.update((const uint8_t *)data, size);
+  _chunks.append(Chunk{(const char *)data, 0, size});
+}
+
+uint32_t
+DFUFile::Writer::crc() {
+  return _crc.get();
+}
+
+bool
+DFUFile::Writer::flush(QFile &file, QString &errorMessage) {
+#ifdef Q_OS_UNIX
+  if (file.flush() && (0 <= file.handle())) {
+    std::vector<struct iovec> iov(_chunks.size());
+    for (int i=0; i<_chunks.size(); i++) {
+      const char *data = _chunks[i].data ? _chunks[i].data : (_headers.constData()+_chunks[i].offset);
+      iov[i].iov_base = (void *)data;
+      iov[i].iov_len  = _chunks[i].size;
+    }
+
+    qint64 pos = file.pos(), total = 0;
+    size_t first = 0;
+    while (first < iov.size()) {
+      ssize_t n = ::writev(file.handle(), iov.data()+first, std::min(iov.size()-first, size_t(IOV_MAX)));
+      if ((0 > n) && (EINTR == errno))
+        continue;
+      if (0 > n) {
+        errorMessage = tr("Cannot write to file '%1': %2").arg(file.fileName()).arg(strerror(errno));
+        return false;
+      }
+      total += n;
+      // Skip written chunks and advance partially written one
+      while ((first < iov.size()) && (size_t(n) >= iov[first].iov_len)) {
+        n -= iov[first].iov_len; first++;
+      }
+      if (n) {
+        iov[first].iov_base = ((char *)iov[first].iov_base) + n;
+        iov[first].iov_len -= n;
+      }
+    }
+
+    // Keep QFile in sync with the file descriptor
+    file.seek(pos+total);
+    return true;
+  }
+#endif
+
+  foreach (const Chunk &chunk, _chunks) {
+    const char *data = chunk.data ? chunk.data : (_headers.constData()+chunk.offset);
+    if (chunk.size != file.write(data, chunk.size)) {
+      errorMessage = tr("Cannot write to file '%1': %2").arg(file.fileName()).arg(file.errorString());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
 /* ********************************************************************************************* *
  * Implementation of DFUFile
  * ********************************************************************************************* */
 DFUFile::DFUFile(QObject *parent)
-  : QObject(parent)
+  : QObject(parent), _images(), _mapped(nullptr), _mapping(nullptr)
 {
   // pass...
 }
 
+DFUFile::~DFUFile() {
+  // Drop images first, no need to copy their data
+  _images.clear();
+  unmap();
+}
+
 uint32_t
 DFUFile::size() const {
   uint32_t size = sizeof(file_prefix_t);
@@ -104,6 +238,43 @@ DFUFile::isAligned(unsigned blocksize) const {
   return true;
 }
 
+void
+DFUFile::takeSnapshot() {
+  for (int i=0; i<_images.size(); i++)
+    _images[i].takeSnapshot();
+}
+
+void
+DFUFile::clearSnapshot() {
+  for (int i=0; i<_images.size(); i++)
+    _images[i].clearSnapshot();
+}
+
+QVector<DFUFile::Extent>
+DFUFile::coalesce(QVector<Extent> extents, unsigned gap) {
+  if (extents.isEmpty())
+    return extents;
+
+  std::sort(extents.begin(), extents.end(), [](const Extent &a, const Extent &b) {
+    return a.address < b.address;
+  });
+
+  QVector<Extent> merged;
+  merged.append(extents.first());
+  for (int i=1; i<extents.size(); i++) {
+    Extent &last = merged.last();
+    uint64_t lastEnd = uint64_t(last.address) + last.size;
+    if (uint64_t(extents[i].address) <= (lastEnd+gap)) {
+      uint64_t end = std::max(lastEnd, uint64_t(extents[i].address)+extents[i].size);
+      last.size = end - last.address;
+    } else {
+      merged.append(extents[i]);
+    }
+  }
+
+  return merged;
+}
+
 bool
 DFUFile::read(const QString &filename, const ErrorStack &err) {
   QFile file(filename);
@@ -127,6 +298,7 @@ DFUFile::read(QFile &file, const ErrorStack &err)
   CRC32 crc;
 
   _images.clear();
+  unmap();
 
   file_prefix_t prefix;
   if (sizeof(file_prefix_t) != file.read((char *)&prefix, sizeof(file_prefix_t))) {
@@ -204,28 +376,17 @@ DFUFile::write(const QString &filename, const ErrorStack &err) {
 
 bool
 DFUFile::write(QFile &file, const ErrorStack &err) {
+  Writer writer;
+
   file_prefix_t prefix;
   memcpy(prefix.signature, "DfuSe", 5);
   prefix.version = 0x01;
   prefix.image_size = qToLittleEndian(uint32_t(size()-sizeof(file_suffix_t)));
   prefix.n_targets = _images.size();
+  writer.header(&prefix, sizeof(file_prefix_t));
 
-  if (sizeof(file_prefix_t) != file.write((char *)&prefix, sizeof(file_prefix_t))) {
-    errMsg(err) << "Cannot write DFU prefix to '" << file.fileName()
-                << "': " << file.errorString() << ".";
-    return false;
-  }
-
-  CRC32 crc;
-  crc.update((uint8_t *)&prefix, sizeof(file_prefix_t));
-
-  foreach (const Image &i, _images) {
-    QString errorMessage;
-    if (! i.write(file, crc, errorMessage)) {
-      errMsg(err) << errorMessage;
-      return false;
-    }
-  }
+  foreach (const Image &i, _images)
+    i.write(writer);
 
   file_suffix_t suffix;
   suffix.device_id = qToLittleEndian((uint16_t)0xffff);
@@ -235,13 +396,127 @@ DFUFile::write(QFile &file, const ErrorStack &err) {
   suffix.DFUhi = 0x01;
   memcpy(suffix.signature, "UFD", 3);
   suffix.size = 16;
+  writer.header(&suffix, sizeof(file_suffix_t)-4);
+
+  uint32_t crc = qToLittleEndian(writer.crc());
+  writer.header(&crc, sizeof(uint32_t), false);
+
+  QString errorMessage;
+  if (! writer.flush(file, errorMessage)) {
+    errMsg(err) << errorMessage;
+    errMsg(err) << "Cannot write DFU file '" << file.fileName() << "'.";
+    return false;
+  }
+
+  return true;
+}
+
+bool
+DFUFile::map(const QString &filename, const ErrorStack &err) {
+  _images.clear();
+  unmap();
+
+  QFile *file = new QFile(filename);
+  if (! file->open(QIODevice::ReadOnly)) {
+    errMsg(err) << "Cannot read DFU file '" << filename << "': " << file->errorString() << ".";
+    delete file;
+    return false;
+  }
+
+  qint64 size = file->size();
+  if (qint64(sizeof(file_prefix_t)+sizeof(file_suffix_t)) > size) {
+    errMsg(err) << "Cannot read DFU file '" << filename << "': File too small.";
+    delete file;
+    return false;
+  }
 
-  crc.update((uint8_t *) &suffix, sizeof(file_suffix_t)-4);
-  suffix.crc = qToLittleEndian(crc.get());
+  // A private mapping allows to modify the content without altering the file
+  uchar *mapping = file->map(0, size, QFileDevice::MapPrivateOption);
+  if (nullptr == mapping) {
+    errMsg(err) << "Cannot map DFU file '" << filename << "': " << file->errorString() << ".";
+    delete file;
+    return false;
+  }
+  _mapped = file;
+  _mapping = mapping;
 
-  if (sizeof(file_suffix_t) != file.write((char *)&suffix, sizeof(file_suffix_t))) {
-    errMsg(err) << "Cannot write DFU suffix to '" << file.fileName()
-                << "': " << file.errorString() << ".";
+  if (! parse(mapping, size, err)) {
+    errMsg(err) << "Cannot read DFU file '" << filename << "'.";
+    _images.clear();
+    unmap();
+    return false;
+  }
+
+  return true;
+}
+
+bool
+DFUFile::isMapped() const {
+  return nullptr != _mapped;
+}
+
+void
+DFUFile::unmap() {
+  if (nullptr == _mapped)
+    return;
+
+  for (int i=0; i<_images.size(); i++)
+    _images[i].detach();
+
+  _mapped->unmap(_mapping);
+  _mapped->close();
+  delete _mapped;
+  _mapped = nullptr;
+  _mapping = nullptr;
+}
+
+bool
+DFUFile::parse(uint8_t *data, qint64 size, const ErrorStack &err) {
+  file_prefix_t prefix;
+  memcpy(&prefix, data, sizeof(file_prefix_t));
+  if (memcmp(prefix.signature, "DfuSe", 5)) {
+    errMsg(err) << "Invalid DFU file signature. Not a DFU file?";
+    return false;
+  }
+
+  file_suffix_t suffix;
+  memcpy(&suffix, data+size-sizeof(file_suffix_t), sizeof(file_suffix_t));
+  if (memcmp(suffix.signature, "UFD", 3)) {
+    errMsg(err) << "Invalid suffix signature.";
+    return false;
+  }
+
+  // Check CRC over the complete file in one pass, before parsing the content
+  CRC32 crc;
+  crc.update(data, size-4);
+  if (crc.get() != qFromLittleEndian(suffix.crc)) {
+    errMsg(err) << "Invalid checksum got " << QString::number(unsigned(suffix.crc),16)
+                << " expected " << QString::number(unsigned(crc.get())) << ".";
+    return false;
+  }
+
+  uint32_t filesize = qFromLittleEndian(prefix.image_size);
+  if (filesize != (size-sizeof(file_suffix_t))) {
+    errMsg(err) << "Filesize " << (size-sizeof(file_suffix_t))
+                << " does not match declared content " << filesize << ".";
+    return false;
+  }
+
+  uint8_t *ptr = data + sizeof(file_prefix_t);
+  const uint8_t *end = data + size - sizeof(file_suffix_t);
+  // Reserve images in advance, as copying them would copy the element data
+  _images.reserve(prefix.n_targets);
+  for (uint8_t i=0; i<prefix.n_targets; i++) {
+    QString errorMessage;
+    _images.append(Image());
+    if (! _images.last().map(ptr, end, errorMessage)) {
+      errMsg(err) << errorMessage;
+      return false;
+    }
+  }
+
+  if (ptr != end) {
+    errMsg(err) << "Unexpected data after last image.";
     return false;
   }
 
@@ -278,23 +553,77 @@ DFUFile::dump(QTextStream &stream) const {
 }
 
 
+/* ********************************************************************************************* *
+ * Implementation of DFUFile::Arena
+ * ********************************************************************************************* */
+DFUFile::Arena::Arena(uint32_t base, uint32_t size)
+  : _base(base), _size(size), _memory(nullptr)
+{
+  // pass...
+}
+
+DFUFile::Arena::~Arena() {
+  if (_memory)
+    free(_memory);
+}
+
+bool
+DFUFile::Arena::allocate() {
+  if (_memory)
+    return true;
+  // Large zero-initialized allocations are usually mapped lazily by the OS.
+  _memory = (uint8_t *)calloc(_size, 1);
+  if (nullptr == _memory)
+    logError() << "Cannot allocate arena of " << _size << "b.";
+  return nullptr != _memory;
+}
+
+bool
+DFUFile::Arena::isAllocated() const {
+  return nullptr != _memory;
+}
+
+uint32_t
+DFUFile::Arena::base() const {
+  return _base;
+}
+
+uint32_t
+DFUFile::Arena::size() const {
+  return _size;
+}
+
+bool
+DFUFile::Arena::contains(uint32_t addr, uint32_t size) const {
+  return (addr >= _base) && ((uint64_t(addr)+size) <= (uint64_t(_base)+_size));
+}
+
+
 /* ********************************************************************************************* *
  * Implementation of DFUFile::Element
  * ********************************************************************************************* */
 DFUFile::Element::Element()
-  : _address(0), _data()
+  : _address(0), _data(), _view(nullptr), _hasSnapshot(false), _snapshot()
 {
   // pass...
 }
 
 DFUFile::Element::Element(uint32_t addr, uint32_t size)
-  : _address(addr), _data(size, 0x00)
+  : _address(addr), _data(size, 0x00), _view(nullptr), _hasSnapshot(false), _snapshot()
+{
+  // pass...
+}
+
+DFUFile::Element::Element(uint32_t addr, uint8_t *view, uint32_t size)
+  : _address(addr), _data(QByteArray::fromRawData((const char *)view, size)), _view(view),
+    _hasSnapshot(false), _snapshot()
 {
   // pass...
 }
 
 DFUFile::Element::Element(const Element &other)
-  : _address(other._address), _data(other._data)
+  : _address(other._address), _data(other._data), _view(other._view),
+    _hasSnapshot(other._hasSnapshot), _snapshot(other._snapshot)
 {
   // pass...
 }
@@ -303,6 +632,9 @@ DFUFile::Element &
 DFUFile::Element::operator=(const Element &other) {
   _address = other._address;
   _data = other._data;
+  _view = other._view;
+  _hasSnapshot = other._hasSnapshot;
+  _snapshot = other._snapshot;
   return *this;
 }
 
@@ -341,6 +673,90 @@ DFUFile::Element::data() {
   return _data;
 }
 
+bool
+DFUFile::Element::isView() const {
+  return nullptr != _view;
+}
+
+uint8_t *
+DFUFile::Element::ptr() {
+  if (_view)
+    return _view;
+  return (uint8_t *)_data.data();
+}
+
+const uint8_t *
+DFUFile::Element::ptr() const {
+  if (_view)
+    return _view;
+  return (const uint8_t *)_data.constData();
+}
+
+void
+DFUFile::Element::bind(uint8_t *view) {
+  uint32_t size = _data.size();
+  if (view != ptr())
+    memcpy(view, ptr(), size);
+  _view = view;
+  _data = QByteArray::fromRawData((const char *)_view, size);
+}
+
+void
+DFUFile::Element::detach() {
+  if (nullptr == _view)
+    return;
+  _data = QByteArray((const char *)_view, _data.size());
+  _view = nullptr;
+}
+
+void
+DFUFile::Element::takeSnapshot() {
+  // Views must be copied, as their memory gets modified in place
+  if (_view)
+    _snapshot = QByteArray((const char *)_view, _data.size());
+  else
+    _snapshot = _data;
+  _hasSnapshot = true;
+}
+
+void
+DFUFile::Element::clearSnapshot() {
+  _snapshot.clear();
+  _hasSnapshot = false;
+}
+
+bool
+DFUFile::Element::hasSnapshot() const {
+  return _hasSnapshot;
+}
+
+void
+DFUFile::Element::modified(unsigned blocksize, QVector<Extent> &extents) const {
+  uint32_t end = _address + _data.size();
+  if ((! _hasSnapshot) || (_snapshot.size() != _data.size())) {
+    if (_data.size())
+      extents.append(Extent(_address, _data.size()));
+    return;
+  }
+  // Data still shared with snapshot -> not touched at all
+  if ((nullptr == _view) && (_snapshot.constData() == _data.constData()))
+    return;
+
+  bool inRun = false; uint32_t runStart = 0;
+  for (uint32_t block=(_address/blocksize)*blocksize; block<end; block+=blocksize) {
+    uint32_t a = std::max(block, _address), b = std::min(block+blocksize, end);
+    bool dirty = (0 != memcmp(ptr()+(a-_address), _snapshot.constData()+(a-_address), b-a));
+    if (dirty && (! inRun)) {
+      runStart = a; inRun = true;
+    } else if ((! dirty) && inRun) {
+      extents.append(Extent(runStart, a-runStart));
+      inRun = false;
+    }
+  }
+  if (inRun)
+    extents.append(Extent(runStart, end-runStart));
+}
+
 bool
 DFUFile::Element::read(QFile &file, CRC32 &crc, QString &errorMessage)
 {
@@ -358,6 +774,8 @@ DFUFile::Element::read(QFile &file, CRC32 &crc, QString &errorMessage)
 
   _data.clear();
   _data = file.read(size);
+  _view = nullptr;
+  clearSnapshot();
 
   if (size != uint32_t(_data.size())) {
     errorMessage = tr("Cannot read DFU file '%1': Cannot read element data: %2").arg(file.fileName()).arg(file.errorString());
@@ -370,30 +788,40 @@ DFUFile::Element::read(QFile &file, CRC32 &crc, QString &errorMessage)
 }
 
 bool
-DFUFile::Element::write(QFile &file, CRC32 &crc, QString &errorMessage) const {
+DFUFile::Element::map(uint8_t *&ptr, const uint8_t *end, QString &errorMessage) {
   element_prefix_t prefix;
-  prefix.address = qToLittleEndian(_address);
-  prefix.size = qToLittleEndian(uint32_t(_data.size()));
-
-  crc.update((uint8_t *) &prefix, sizeof(element_prefix_t));
-
-  if (sizeof(element_prefix_t) != file.write((const char *)&prefix, sizeof(element_prefix_t))) {
-    errorMessage = tr("Cannot write element prefix to file '%1': %2")
-        .arg(file.fileName()).arg(file.errorString());
+  if ((end-ptr) < qint64(sizeof(element_prefix_t))) {
+    errorMessage = tr("Cannot read element prefix: Unexpected end of file.");
     return false;
   }
+  memcpy(&prefix, ptr, sizeof(element_prefix_t));
+  ptr += sizeof(element_prefix_t);
 
-  crc.update(_data);
-
-  if (_data.size() != file.write(_data)) {
-    errorMessage = tr("Cannot write element data to file '%1': %2")
-        .arg(file.fileName()).arg(file.errorString());
+  _address = qFromLittleEndian(prefix.address);
+  uint32_t size = qFromLittleEndian(prefix.size);
+  if ((end-ptr) < qint64(size)) {
+    errorMessage = tr("Cannot read element data: Unexpected end of file.");
     return false;
   }
 
+  _view = ptr;
+  _data = QByteArray::fromRawData((const char *)ptr, size);
+  clearSnapshot();
+  ptr += size;
+
   return true;
 }
 
+void
+DFUFile::Element::write(Writer &writer) const {
+  element_prefix_t prefix;
+  prefix.address = qToLittleEndian(_address);
+  prefix.size = qToLittleEndian(uint32_t(_data.size()));
+
+  writer.header(&prefix, sizeof(element_prefix_t));
+  writer.data(ptr(), _data.size());
+}
+
 void
 DFUFile::Element::dump(QTextStream &stream) const {
   stream.setIntegerBase(16);
@@ -440,37 +868,97 @@ DFUFile::Element::dump(QTextStream &stream) const {
  * Implementation of DFUFile::Image
  * ********************************************************************************************* */
 DFUFile::Image::Image()
-  : _alternate_settings(0), _name(), _elements(), _addressmap()
+  : _alternate_settings(0), _name(), _elements(), _addressmap(), _arena(nullptr)
 {
   // pass...
 }
 
 DFUFile::Image::Image(const QString &name, uint8_t altSettings)
-  : _alternate_settings(altSettings), _name(name), _elements(), _addressmap()
+  : _alternate_settings(altSettings), _name(name), _elements(), _addressmap(), _arena(nullptr)
 {
   // pass...
 }
 
 DFUFile::Image::Image(const Image &other)
   : _alternate_settings(other._alternate_settings), _name(other._name), _elements(other._elements),
-    _addressmap(other._addressmap)
+    _addressmap(other._addressmap), _arena(nullptr)
 {
-  // pass...
+  copyArena(other);
 }
 
 DFUFile::Image::~Image() {
-  // pass...
+  _elements.clear();
+  if (_arena)
+    delete _arena;
 }
 
 DFUFile::Image &
 DFUFile::Image::operator=(const Image &other) {
+  if (this == &other)
+    return *this;
   _alternate_settings = other._alternate_settings;
   _name = other._name;
   _elements = other._elements;
   _addressmap = other._addressmap;
+  if (_arena)
+    delete _arena;
+  _arena = nullptr;
+  copyArena(other);
   return *this;
 }
 
+void
+DFUFile::Image::copyArena(const Image &other) {
+  if (other._arena)
+    _arena = new Arena(other._arena->base(), other._arena->size());
+
+  // Elements still refer to the memory of the other image or some external memory
+  for (int i=0; i<_elements.size(); i++)
+    _elements[i].detach();
+}
+
+bool
+DFUFile::Image::useArena(uint32_t base, uint32_t size) {
+  // The memory of the arena gets allocated with the first element within its range
+  Arena *arena = new Arena(base, size);
+  for (int i=0; i<_elements.size(); i++) {
+    if (! arena->contains(_elements[i].address(), _elements[i].memSize()))
+      continue;
+    if (! arena->allocate()) {
+      delete arena;
+      return false;
+    }
+    break;
+  }
+
+  // Move elements into the new arena or detach them from the old one
+  for (int i=0; i<_elements.size(); i++) {
+    if (arena->contains(_elements[i].address(), _elements[i].memSize()))
+      _elements[i].bind(arena->data(_elements[i].address()));
+    else
+      _elements[i].detach();
+  }
+
+  if (_arena)
+    delete _arena;
+  _arena = arena;
+  return true;
+}
+
+bool
+DFUFile::Image::hasArena() const {
+  return nullptr != _arena;
+}
+
+void
+DFUFile::Image::detach() {
+  for (int i=0; i<_elements.size(); i++) {
+    if (_arena && _arena->contains(_elements[i].address(), _elements[i].memSize()))
+      continue;
+    _elements[i].detach();
+  }
+}
+
 uint32_t
 DFUFile::Image::size() const {
   uint32_t size = sizeof(image_prefix_t);
@@ -527,21 +1015,53 @@ DFUFile::Image::element(int i) {
   return _elements[i];
 }
 
-void
+bool
 DFUFile::Image::addElement(uint32_t addr, uint32_t size, int index) {
-  if ((0 > index) || (_elements.size() <= index)) {
-    _elements.append(Element(addr, size));
-    _addressmap.add(addr, size);
+  if ((0 > index) || (_elements.size() <= index))
+    index = -1;
+  // The address map rejects elements starting at the address of an existing one. Add the element
+  // to the map first to keep the map and the list of elements in sync.
+  if (! _addressmap.add(addr, size, index)) {
+    logError() << "Cannot add element at " << QString::number(addr, 16)
+               << "h: There is already an element at this address.";
+    return false;
+  }
+
+  Element element;
+  if (_arena && _arena->contains(addr, size) && _arena->allocate()) {
+    // Clear arena memory, not shared with any other element
+    uint32_t pos = addr;
+    for (uint32_t i: _addressmap.intersecting(addr, size)) {
+      uint32_t eaddr = _elements[i].address();
+      if (eaddr > pos)
+        memset(_arena->data(pos), 0x00, eaddr-pos);
+      pos = std::max(pos, eaddr + _elements[i].memSize());
+    }
+    if (pos < (addr+size))
+      memset(_arena->data(pos), 0x00, addr+size-pos);
+    element = Element(addr, _arena->data(addr), size);
   } else {
-    _elements.insert(index, Element(addr, size));
-    _addressmap.add(addr, size, index);
+    element = Element(addr, size);
   }
+
+  if (0 > index)
+    _elements.append(element);
+  else
+    _elements.insert(index, element);
+  return true;
 }
 
-void
+bool
 DFUFile::Image::addElement(const Element &element) {
+  if (! _addressmap.add(element.address(), element.memSize())) {
+    logError() << "Cannot add element at " << QString::number(element.address(), 16)
+               << "h: There is already an element at this address.";
+    return false;
+  }
   _elements.append(element);
-  _addressmap.add(element.address(), element.size());
+  if (_arena && _arena->contains(element.address(), element.memSize()) && _arena->allocate())
+    _elements.last().bind(_arena->data(element.address()));
+  return true;
 }
 
 void
@@ -587,7 +1107,11 @@ DFUFile::Image::read(QFile &file, CRC32 &crc, QString &errorMessage)
     Element element;
     if (! element.read(file, crc, errorMessage))
       return false;
-    this->addElement(element);
+    if (! this->addElement(element)) {
+      errorMessage = tr("Cannot read DFU file '%1': Duplicate element at address %2h.")
+          .arg(file.fileName()).arg(element.address(), 0, 16);
+      return false;
+    }
   }
 
   // verify size:
@@ -600,7 +1124,50 @@ DFUFile::Image::read(QFile &file, CRC32 &crc, QString &errorMessage)
 }
 
 bool
-DFUFile::Image::write(QFile &file, CRC32 &crc, QString &errorMessage) const {
+DFUFile::Image::map(uint8_t *&ptr, const uint8_t *end, QString &errorMessage) {
+  image_prefix_t prefix;
+  if ((end-ptr) < qint64(sizeof(image_prefix_t))) {
+    errorMessage = tr("Cannot read image: Unexpected end of file.");
+    return false;
+  }
+  memcpy(&prefix, ptr, sizeof(image_prefix_t));
+  ptr += sizeof(image_prefix_t);
+
+  if (memcmp(prefix.signature, "Target", 6)) {
+    errorMessage = tr("Invalid image signature value.");
+    return false;
+  }
+
+  _alternate_settings = prefix.alternate_setting;
+  if (0x01 ==qFromLittleEndian(prefix.is_named)) {
+    char tmp[256]; tmp[255]=0;
+    memcpy(tmp, prefix.name, 255);
+    _name = tmp;
+  }
+
+  uint32_t size = qFromLittleEndian(prefix.size);
+  uint32_t n_elements = qFromLittleEndian(prefix.n_elements);
+  _elements.reserve(n_elements);
+  for (uint32_t i=0; i<n_elements; i++) {
+    Element element;
+    if (! element.map(ptr, end, errorMessage))
+      return false;
+    if (! this->addElement(element)) {
+      errorMessage = tr("Duplicate element at address %1h.").arg(element.address(), 0, 16);
+      return false;
+    }
+  }
+
+  if (size != (this->size()-sizeof(image_prefix_t))) {
+    errorMessage = tr("Invalid image size %1b specified, expected %2b.")
+        .arg(size).arg(this->size()-sizeof(image_prefix_t));
+    return false;
+  }
+  return true;
+}
+
+void
+DFUFile::Image::write(Writer &writer) const {
   image_prefix_t prefix;
   memcpy(prefix.signature, "Target", 6);
   prefix.alternate_setting = _alternate_settings;
@@ -611,20 +1178,10 @@ DFUFile::Image::write(QFile &file, CRC32 &crc, QString &errorMessage) const {
   prefix.size = qToLittleEndian(uint32_t(size()-sizeof(image_prefix_t)));
   prefix.n_elements = qToLittleEndian(uint32_t(_elements.size()));
 
-  crc.update((uint8_t *)&prefix, sizeof(image_prefix_t));
+  writer.header(&prefix, sizeof(image_prefix_t));
 
-  if (sizeof(image_prefix_t) != file.write((char *)&prefix, sizeof(image_prefix_t))) {
-    errorMessage = tr("Cannot write image prefix to '%1': %2.")
-        .arg(file.fileName()).arg(file.errorString());
-    return false;
-  }
-
-  foreach (const Element &e, _elements) {
-    if (! e.write(file, crc, errorMessage))
-      return false;
-  }
-
-  return true;
+  foreach (const Element &e, _elements)
+    e.write(writer);
 }
 
 void
@@ -637,7 +1194,65 @@ DFUFile::Image::sort() {
   // Rebuild address map
   _addressmap.clear();
   for (int i=0; i<_elements.size(); i++)
-    _addressmap.add(_elements[i].address(), _elements.size());
+    _addressmap.add(_elements[i].address(), _elements[i].memSize());
+}
+
+void
+DFUFile::Image::takeSnapshot() {
+  for (int i=0; i<_elements.size(); i++)
+    _elements[i].takeSnapshot();
+}
+
+void
+DFUFile::Image::clearSnapshot() {
+  for (int i=0; i<_elements.size(); i++)
+    _elements[i].clearSnapshot();
+}
+
+QVector<DFUFile::Extent>
+DFUFile::Image::modified(unsigned blocksize) const {
+  QVector<Extent> extents;
+  foreach (const Element &e, _elements)
+    e.modified(blocksize, extents);
+  std::sort(extents.begin(), extents.end(), [](const Extent &a, const Extent &b) {
+    return a.address < b.address;
+  });
+  return extents;
+}
+
+QVector<DFUFile::Extent>
+DFUFile::Image::extents(unsigned gap, int first) const {
+  QVector<Extent> extents;
+  for (int i=std::max(0, first); i<_elements.size(); i++) {
+    if (_elements[i].memSize())
+      extents.append(Extent(_elements[i].address(), _elements[i].memSize()));
+  }
+  return coalesce(extents, gap);
+}
+
+void
+DFUFile::Image::scatter(uint32_t addr, const uint8_t *data, uint32_t size) {
+  uint32_t end = addr+size;
+  for (uint32_t i: _addressmap.intersecting(addr, size)) {
+    uint32_t eaddr = _elements[i].address(), eend = eaddr + _elements[i].memSize();
+    uint32_t a = std::max(addr, eaddr), b = std::min(end, eend);
+    if (a >= b)
+      continue;
+    memcpy(_elements[i].ptr()+(a-eaddr), data+(a-addr), b-a);
+  }
+}
+
+void
+DFUFile::Image::gather(uint32_t addr, uint8_t *data, uint32_t size) const {
+  uint32_t end = addr+size;
+  memset(data, 0, size);
+  for (uint32_t i: _addressmap.intersecting(addr, size)) {
+    uint32_t eaddr = _elements[i].address(), eend = eaddr + _elements[i].memSize();
+    uint32_t a = std::max(addr, eaddr), b = std::min(end, eend);
+    if (a >= b)
+      continue;
+    memcpy(data+(a-addr), _elements.at(i).ptr()+(a-eaddr), b-a);
+  }
 }
 
 void
@@ -658,6 +1273,19 @@ DFUFile::Image::isAllocated(uint32_t offset) const {
   return 0 <= _addressmap.find(offset);
 }
 
+bool
+DFUFile::Image::overlaps(uint32_t addr, uint32_t size) const {
+  return _addressmap.overlaps(addr, size);
+}
+
+QVector<int>
+DFUFile::Image::elementsIn(uint32_t addr, uint32_t size) const {
+  QVector<int> indices;
+  for (uint32_t i: _addressmap.intersecting(addr, size))
+    indices.append(i);
+  return indices;
+}
+
 unsigned char *
 DFUFile::Image::data(uint32_t offset) {
   int idx = _addressmap.find(offset);
@@ -665,8 +1293,8 @@ DFUFile::Image::data(uint32_t offset) {
     logFatal() << "Cannot resolve offset " << QString::number(offset, 16) << "h.";
     return nullptr;
   }
-  return (unsigned char *)(element(idx).data().data()+
-                           (offset-element(idx).address()));
+  // Views into the arena point into it, any other element holds its own data
+  return element(idx).ptr() + (offset-element(idx).address());
 }
 
 const unsigned char *
@@ -676,6 +1304,6 @@ DFUFile::Image::data(uint32_t offset) const {
     logFatal() << "Cannot resolve offset " << QString::number(offset, 16) << "h.";
     return nullptr;
   }
-  return (unsigned char *)(element(idx).data().data()+
-                           (offset-element(idx).address()));
+  // Views into the arena point into it, any other element holds its own data
+  return element(idx).ptr() + (offset-element(idx).address());
 }
@@ -74,13 +74,84 @@ class DFUFile: public QObject
 	Q_OBJECT
 
 public:
-  /** Represents a single element within a @c Image. */
+  /** Represents a contiguous memory region within an image. */
+  struct Extent {
+    uint32_t address; ///< The start address of the region.
+    uint32_t size;    ///< The size of the region in bytes.
+
+    /** Constructs an extent for the given address and size. */
+    inline Extent(uint32_t addr=0, uint32_t len=0)
+      : address(addr), size(len) {
+      // pass...
+    }
+  };
+
+  /** Collects the serialized DFU file as a sequence of chunks and computes the CRC on the fly.
+   * Element data is only referenced, hence the file can be written at once without copying the
+   * data into a single buffer first. */
+  class Writer;
+
+  /** A contiguous buffer holding the data of all elements within an address range of an image.
+   *
+   * The buffer gets allocated zero-initialized at once, once the first element within the address
+   * range is added. Hence, an unused arena does not occupy any memory. The operating system only
+   * commits the pages actually used by elements. Hence the arena may cover a sparse address range
+   * much larger than the memory actually used. In contrast to individually allocated elements,
+   * the data of adjacent elements is contiguous and adding an element does not allocate any
+   * memory. Translating an address into a pointer still requires to look up the
+   * element in the address map, that is O(log n). */
+  class Arena
+  {
+  public:
+    /** Constructs an arena for the given address range, the memory is not allocated yet. */
+    Arena(uint32_t base, uint32_t size);
+    /** Destructor, frees the memory. */
+    ~Arena();
+
+    /** Allocates the memory, if not done yet. Returns @c false if the memory cannot be
+     * allocated. */
+    bool allocate();
+    /** Returns @c true if the memory got allocated. */
+    bool isAllocated() const;
+    /** Returns the first address covered by the arena. */
+    uint32_t base() const;
+    /** Returns the size of the address range covered by the arena. */
+    uint32_t size() const;
+    /** Returns @c true if the given memory region is covered by the arena. */
+    bool contains(uint32_t addr, uint32_t size=1) const;
+    /** Returns the pointer to the given address. */
+    inline uint8_t *data(uint32_t addr) {
+      return _memory + (addr - _base);
+    }
+
+  private:
+    /** An arena cannot be copied. */
+    Arena(const Arena &other) = delete;
+    /** An arena cannot be copied. */
+    Arena &operator=(const Arena &other) = delete;
+
+  protected:
+    /** The first address covered. */
+    uint32_t _base;
+    /** The size of the covered address range. */
+    uint32_t _size;
+    /** The actual memory. */
+    uint8_t *_memory;
+  };
+
+  /** Represents a single element within a @c Image.
+   *
+   * Usually, an element owns its data. It may, however, also be a view into some external memory
+   * (e.g., an @c Arena). */
 	class Element {
 	public:
     /** Empty constructor. */
 		Element();
     /** Constructs an element for the given address and of the given size. */
 		Element(uint32_t addr, uint32_t size);
+    /** Constructs an element for the given address and size as a view into the given external
+     * memory. The memory must outlive the element. */
+    Element(uint32_t addr, uint8_t *view, uint32_t size);
     /** Copy constructor. */
 		Element(const Element &other);
     /** Copying assignment. */
@@ -98,22 +169,61 @@ public:
     bool isAligned(unsigned blocksize) const;
     /** Returns a reference to the data. */
 		const QByteArray &data() const;
-    /** Returns a reference to the data. */
+    /** Returns a reference to the data.
+     * If the element is a view, modifications of the returned array do not alter the viewed
+     * memory. Use @c ptr() to modify the element data in this case. */
 		QByteArray &data();
+    /** Returns @c true if the element is a view into some external memory. */
+    bool isView() const;
+    /** Returns a pointer to the element data. */
+    uint8_t *ptr();
+    /** Returns a pointer to the element data. */
+    const uint8_t *ptr() const;
+
+    /** Stores the current content of the element as the reference for @c modified.
+     * This is cheap for elements owning their data, as the data is shared until the element gets
+     * modified. Views get copied. */
+    void takeSnapshot();
+    /** Drops the reference content. The element is then considered modified entirely. */
+    void clearSnapshot();
+    /** Returns @c true if a reference content has been stored. */
+    bool hasSnapshot() const;
+    /** Appends the memory regions of this element that differ from the reference content to the
+     * given list. The regions are aligned to the given block size and clipped to the element. If
+     * there is no reference content, the entire element is considered modified. */
+    void modified(unsigned blocksize, QVector<Extent> &extents) const;
 
     /** Reads an element from the given file and updates the CRC. */
 		bool read(QFile &file, CRC32 &crc, QString &errorMessage);
-    /** Writes an element to the given file and updates the CRC. */
-		bool write(QFile &file, CRC32 &crc, QString &errorMessage) const;
+    /** Reads an element from the given memory and advances the pointer. The element becomes a
+     * view into that memory. */
+    bool map(uint8_t *&ptr, const uint8_t *end, QString &errorMessage);
+    /** Appends the element to the given writer. */
+		void write(Writer &writer) const;
 
     /** Dumps a textual representation of the element. */
 		void dump(QTextStream &stream) const;
 
+	protected:
+    /** Copies the current data into the given external memory and turns the element into a view
+     * of it. */
+    void bind(uint8_t *view);
+    /** Turns a view into an element owning a copy of its data. */
+    void detach();
+
 	protected:
     /** The address of the element. */
 		uint32_t _address;
-    /** The data of the element. */
+    /** The data of the element. For views, this array references the external memory. */
 		QByteArray _data;
+    /** Points to the external memory if the element is a view, @c nullptr otherwise. */
+    uint8_t *_view;
+    /** If @c true, @c _snapshot holds the reference content. */
+    bool _hasSnapshot;
+    /** The reference content of the element, shares the data with @c _data until modified. */
+    QByteArray _snapshot;
+
+    friend class Image;
 	};
 
   /** Represents a single image within a @c DFUFile. */
@@ -154,10 +264,12 @@ public:
     /** Returns a reference to the i-th element of the image. */
     Element &element(int i);
     /** Adds an element to the image with the given address and size at the specified index.
-     * If the index is negative, the element gets appended. */
-    void addElement(uint32_t addr, uint32_t size, int index=-1);
-    /** Adds an element to the image. */
-    void addElement(const Element &element);
+     * If the index is negative, the element gets appended.
+     * @returns @c false if there is already an element at the given address. */
+    bool addElement(uint32_t addr, uint32_t size, int index=-1);
+    /** Adds an element to the image.
+     * @returns @c false if there is already an element at the address of the given one. */
+    bool addElement(const Element &element);
     /** Removes the i-th element from this image. */
 		void remElement(int i);
     /** Checks if all element addresses and sizes is aligned with the given block size. */
@@ -165,14 +277,22 @@ public:
 
     /** Reads an image from the given file and updates the CRC. */
 		bool read(QFile &file, CRC32 &crc, QString &errorMessage);
-    /** Writes this image to the given file and updates the CRC. */
-		bool write(QFile &file, CRC32 &crc, QString &errorMessage) const;
+    /** Reads an image from the given memory and advances the pointer. All elements become views
+     * into that memory. */
+    bool map(uint8_t *&ptr, const uint8_t *end, QString &errorMessage);
+    /** Appends this image to the given writer. */
+		void write(Writer &writer) const;
 
     /** Prints a textual representation of the image into the given stream. */
 		void dump(QTextStream &stream) const;
 
     /** Returns @c true if the specified address is allocated. */
     virtual bool isAllocated(uint32_t offset) const;
+    /** Returns @c true if any byte of the specified memory region is allocated. */
+    bool overlaps(uint32_t addr, uint32_t size) const;
+    /** Returns the indices of all elements intersecting the specified memory region, ordered by
+     * address. */
+    QVector<int> elementsIn(uint32_t addr, uint32_t size) const;
 
     /** Returns a pointer to the encoded raw data at the specified offset. */
     virtual unsigned char *data(uint32_t offset);
@@ -182,6 +302,39 @@ public:
     /** Sorts all elements with respect to their addresses. */
     void sort();
 
+    /** Holds the data of all elements within the given address range in a single arena.
+     * Existing elements within that range are moved into the arena, elements added later become
+     * views into it. Elements outside of the range keep their own memory. The memory of the arena
+     * is only allocated once there is an element within the range.
+     * @returns @c false if the arena cannot be allocated. */
+    bool useArena(uint32_t base, uint32_t size);
+    /** Returns @c true if the image holds its data in an arena. */
+    bool hasArena() const;
+    /** Turns all elements, that are views into some external memory, into elements owning a copy
+     * of their data. Elements held in the arena are not affected. */
+    void detach();
+
+    /** Stores the current content of all elements as the reference for @c modified. */
+    void takeSnapshot();
+    /** Drops the reference content of all elements. */
+    void clearSnapshot();
+    /** Returns the memory regions, modified since the last snapshot, sorted by address.
+     * The regions are aligned to the given block size but never span several elements.
+     * Elements without a snapshot are considered modified entirely. */
+    QVector<Extent> modified(unsigned blocksize) const;
+
+    /** Returns the memory allocated by the elements starting at index @c first as contiguous
+     * regions sorted by address. Elements get merged into a single region if they are adjacent or
+     * the gap between them is not larger than @c gap bytes. This allows to transfer the image in
+     * a few large chunks instead of many small elements. */
+    QVector<Extent> extents(unsigned gap=0, int first=0) const;
+    /** Copies the given data into the allocated memory starting at the given address.
+     * Memory not allocated by any element (i.e., gaps) is skipped. */
+    void scatter(uint32_t addr, const uint8_t *data, uint32_t size);
+    /** Copies the allocated memory starting at the given address into the given buffer.
+     * Memory not allocated by any element (i.e., gaps) is filled with zeros. */
+    void gather(uint32_t addr, uint8_t *data, uint32_t size) const;
+
 	protected:
     /** Alternate settings byte. */
 		uint8_t  _alternate_settings;
@@ -191,11 +344,21 @@ public:
 		QVector<Element> _elements;
     /** Maps an address range to element index. */
     AddressMap _addressmap;
+    /** The optional arena, holding the data of the elements. */
+    Arena *_arena;
+
+  private:
+    /** Sets up an arena covering the same address range as the one of the given image. The arena
+     * gets allocated once an element is added to it. The copied elements own a copy of their data,
+     * hence only the address ranges in use get copied. */
+    void copyArena(const Image &other);
 	};
 
 public:
   /** Constructs an empty DFU file object. */
 	DFUFile(QObject *parent=nullptr);
+  /** Destructor, releases the file mapping if present. */
+  virtual ~DFUFile();
 
   /** Returns the total size of the DFU file. */
 	uint32_t size() const;
@@ -218,6 +381,16 @@ public:
   /** Checks if all image addresses and sizes is aligned with the given block size. */
   bool isAligned(unsigned blocksize) const;
 
+  /** Stores the current content of all images as the reference to detect modified memory regions.
+   * @see Image::modified */
+  void takeSnapshot();
+  /** Drops the reference content of all images. */
+  void clearSnapshot();
+
+  /** Merges the given extents if they overlap, are adjacent or the gap between them is not
+   * larger than @c gap bytes. The result is sorted by address. */
+  static QVector<Extent> coalesce(QVector<Extent> extents, unsigned gap=0);
+
   /** Reads the specified DFU file.
    * @return @c false on error. */
   bool read(const QString &filename, const ErrorStack &err=ErrorStack());
@@ -225,6 +398,17 @@ public:
    * @returns @c false on error. */
   bool read(QFile &file, const ErrorStack &err=ErrorStack());
 
+  /** Maps the specified DFU file into memory. In contrast to @c read, the element data is not
+   * copied but the elements become views into the mapped file. Modifications are private and
+   * never written back to the file. The mapping is held until @c unmap is called, the file gets
+   * read or mapped again or this object is destroyed.
+   * @returns @c false on error. */
+  bool map(const QString &filename, const ErrorStack &err=ErrorStack());
+  /** Returns @c true if the elements refer to a mapped file. */
+  bool isMapped() const;
+  /** Releases the file mapping. Elements referring to the mapped file get copied. */
+  void unmap();
+
   /** Writes to the specified file.
    * @returns @c false on error. */
   bool write(const QString &filename, const ErrorStack &err=ErrorStack());
@@ -243,9 +427,17 @@ public:
   /** Returns a const pointer to the encoded raw data at the specified offset. */
   virtual const unsigned char *data(uint32_t offset, uint32_t img=0) const;
 
+protected:
+  /** Parses the DFU file from the given memory. The elements become views into that memory. */
+  bool parse(uint8_t *data, qint64 size, const ErrorStack &err=ErrorStack());
+
 protected:
   /// The list of images.
 	QVector<Image> _images;
+  /// The mapped file, if any.
+  QFile *_mapped;
+  /// The mapped memory.
+  uchar *_mapping;
 };
 
 #endif // DFUFILE_HH
@@ -1112,7 +1112,7 @@ protected:
   void allocateForEncoding();
 
   bool decodeElements(Context &ctx, const ErrorStack &err=ErrorStack());
-  bool encodeElements(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
+  void addEncodingTasks(TaskGraph &tasks, const Flags &flags, Context &ctx);
 
   void allocateGeneralSettings();
   bool encodeGeneralSettings(const Flags &flags, Context &ctx, const ErrorStack &err=ErrorStack());
@@ -96,12 +96,7 @@ GD77CallsignDB::encode(UserDatabase *calldb, const Selection &selection, const E
 
   // Select first n entries and sort them in ascending order of their IDs
   logDebug() << "Select first " << n << " entries out off " << calldb->count() << ".";
-  QVector<UserDatabase::User> users;
-  for (unsigned i=0; i<n; i++)
-    users.append(calldb->user(i));
-  logDebug() << "Sort selected w.r.t their ID in ascending order.";
-  std::sort(users.begin(), users.end(),
-            [](const UserDatabase::User &a, const UserDatabase::User &b) { return a.id < b.id; });
+  QVector<int> users = selectUsers(calldb, n);
 
   // Allocate segment for user db if requested
   size_t size = align_size(sizeof(userdb_t)+n*sizeof(userdb_entry_t), BLOCK_SIZE);
@@ -113,7 +108,7 @@ GD77CallsignDB::encode(UserDatabase *calldb, const Selection &selection, const E
   userdb->clear(); userdb->setSize(n);
   userdb_entry_t *db = (userdb_entry_t *)this->data(OFFSET_USERDB+sizeof(userdb_t), 0);
   for (unsigned i=0; i<n; i++) {
-    db[i].fromEntry(users[i]);
+    db[i].fromEntry(calldb->user(users[i]));
   }
 
   return true;
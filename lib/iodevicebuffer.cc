@@ -0,0 +1,21 @@
+#include "iodevicebuffer.hh"
+#include <QIODevice>
+#include <algorithm>
+
+
+IODeviceBuffer::IODeviceBuffer(QIODevice *device, size_t size)
+  : std::streambuf(), _device(device), _buffer(std::max(size_t(1), size))
+{
+  setg(_buffer.data(), _buffer.data(), _buffer.data());
+}
+
+IODeviceBuffer::int_type
+IODeviceBuffer::underflow() {
+  if (gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+  qint64 n = _device->read(_buffer.data(), qint64(_buffer.size()));
+  if (0 >= n)
+    return traits_type::eof();
+  setg(_buffer.data(), _buffer.data(), _buffer.data()+n);
+  return traits_type::to_int_type(*gptr());
+}
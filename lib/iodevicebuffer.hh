@@ -0,0 +1,31 @@
+#ifndef IODEVICEBUFFER_HH
+#define IODEVICEBUFFER_HH
+
+#include <streambuf>
+#include <vector>
+
+class QIODevice;
+
+/** A @c std::streambuf reading from a @c QIODevice.
+ *
+ * This allows to read directly from a @c QIODevice (e.g., files and resources) by code expecting
+ * a @c std::istream, like the YAML parser, without reading the entire content into memory first.
+ *
+ * @ingroup util */
+class IODeviceBuffer: public std::streambuf
+{
+public:
+  /** Constructs a buffer reading from the given device, which must be open for reading. */
+  explicit IODeviceBuffer(QIODevice *device, size_t size=0x10000);
+
+protected:
+  int_type underflow();
+
+protected:
+  /** The source device. */
+  QIODevice *_device;
+  /** The buffer. */
+  std::vector<char> _buffer;
+};
+
+#endif // IODEVICEBUFFER_HH
@@ -66,7 +66,7 @@ LogHandler::~LogHandler() {
 Logger *Logger::_instance = nullptr;
 
 Logger::Logger()
-  : QObject(nullptr), _handler()
+  : QObject(nullptr), _handler(), _mutex()
 {
   // pass...
 }
@@ -77,6 +77,7 @@ Logger::~Logger() {
 
 void
 Logger::log(const LogMessage &msg) {
+  QMutexLocker locker(&_mutex);
   foreach (LogHandler *handler, _handler) {
     handler->handle(msg);
   }
@@ -304,6 +304,9 @@ OpenGD77::upload()
     _dev->read_finish();
   }
 
+  // Remember downloaded codeplug to upload modified blocks only
+  _codeplug.takeSnapshot();
+
   // Encode config into codeplug
   _codeplug.encode(_config);
 
@@ -312,22 +315,27 @@ OpenGD77::upload()
     return false;
   }
 
-  // Then upload codeplug
+  // Then upload modified blocks of the codeplug
+  size_t totw = 0;
+  for (int image=0; image<_codeplug.numImages(); image++)
+    foreach (const DFUFile::Extent &e, _codeplug.image(image).modified(BSIZE))
+      totw += e.size;
+  logDebug() << "Upload " << totw << "b of " << totb << "b modified.";
+
+  size_t wcount = 0;
   for (int image=0; image<_codeplug.numImages(); image++) {
     uint32_t bank = (0 == image) ? OpenGD77Codeplug::EEPROM : OpenGD77Codeplug::FLASH;
 
-    for (int n=0; n<_codeplug.image(image).numElements(); n++) {
-      unsigned addr = _codeplug.image(image).element(n).address();
-      unsigned size = _codeplug.image(image).element(n).data().size();
-      unsigned b0 = addr/BSIZE, nb = size/BSIZE;
+    foreach (const DFUFile::Extent &e, _codeplug.image(image).modified(BSIZE)) {
+      unsigned b0 = e.address/BSIZE, nb = e.size/BSIZE;
 
-      for (unsigned b=0; b<nb; b++, bcount+=BSIZE) {
+      for (unsigned b=0; b<nb; b++, wcount+=BSIZE) {
         if (! _dev->write(bank, (b0+b)*BSIZE, _codeplug.data((b0+b)*BSIZE, image), BSIZE, _errorStack)) {
           errMsg(_errorStack) << "Cannot write block " << (b0+b) << ".";
           return false;
         }
         QThread::usleep(100);
-        emit uploadProgress(float(bcount*50)/totb);
+        emit uploadProgress(50+float(wcount*50)/totw);
       }
     }
     _dev->write_finish();
@@ -100,11 +100,7 @@ OpenGD77CallsignDB::encode(UserDatabase *calldb, const Selection &selection, con
     return true;
 
   // Select first n entries and sort them in ascending order of their IDs
-  QVector<UserDatabase::User> users;
-  for (unsigned i=0; i<n; i++)
-    users.append(calldb->user(i));
-  std::sort(users.begin(), users.end(),
-            [](const UserDatabase::User &a, const UserDatabase::User &b) { return a.id < b.id; });
+  QVector<int> users = selectUsers(calldb, n);
 
   // Allocate segment for user db if requested
   unsigned size = align_size(sizeof(userdb_t)+n*sizeof(userdb_entry_t), BLOCK_SIZE);
@@ -115,7 +111,7 @@ OpenGD77CallsignDB::encode(UserDatabase *calldb, const Selection &selection, con
   userdb->clear(); userdb->setSize(n);
   userdb_entry_t *db = (userdb_entry_t *)this->data(OFFSET_USERDB+sizeof(userdb_t));
   for (unsigned i=0; i<n; i++) {
-    db[i].fromEntry(users[i]);
+    db[i].fromEntry(calldb->user(users[i]));
   }
 
   return true;
@@ -193,6 +193,10 @@ RadioddityRadio::upload() {
         emit uploadProgress(float(bcount*50)/btot);
       }
     }
+    // Remember downloaded codeplug to upload modified blocks only
+    codeplug().takeSnapshot();
+  } else {
+    codeplug().clearSnapshot();
   }
 
   // Encode config into codeplug
@@ -201,11 +205,15 @@ RadioddityRadio::upload() {
     return false;
   }
 
-  // then, upload modified codeplug
+  // then, upload modified blocks of the codeplug
+  QVector<DFUFile::Extent> modified = codeplug().image(0).modified(BSIZE);
+  btot = 0;
+  foreach (const DFUFile::Extent &e, modified)
+    btot += e.size/BSIZE;
   bcount = 0;
-  for (int n=0; n<codeplug().image(0).numElements(); n++) {
-    int b0 = codeplug().image(0).element(n).address()/BSIZE;
-    int nb = codeplug().image(0).element(n).data().size()/BSIZE;
+  foreach (const DFUFile::Extent &e, modified) {
+    int b0 = e.address/BSIZE;
+    int nb = e.size/BSIZE;
     for (int i=0; i<nb; i++, bcount++) {
       // Select bank by addr
       uint32_t addr = (b0+i)*BSIZE;
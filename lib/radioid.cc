@@ -1,6 +1,7 @@
 #include "radioid.hh"
 #include "logger.hh"
 #include "utils.hh"
+#include <QMutex>
 
 
 /* ********************************************************************************************* *
@@ -112,6 +113,9 @@ DefaultRadioID::DefaultRadioID(QObject *parent)
 
 DefaultRadioID *
 DefaultRadioID::get() {
+  // May be called concurrently, e.g., by channels created while decoding a codeplug
+  static QMutex mutex;
+  QMutexLocker locker(&mutex);
   if (nullptr == _instance)
     _instance = new DefaultRadioID();
   return _instance;
@@ -37,7 +37,7 @@ class DMRRadioID : public RadioID
 
 public:
   /** Default constructor. */
-  explicit DMRRadioID(QObject *parent=nullptr);
+  Q_INVOKABLE explicit DMRRadioID(QObject *parent=nullptr);
 
   /** Constructor.
    * @param name Specifies the name of the ID.
@@ -2,7 +2,10 @@
 #include "configobject.hh"
 #include "logger.hh"
 #include "config.hh"
+#include "taskgraph.hh"
 #include <QMetaProperty>
+#include <QThread>
+#include <algorithm>
 #include <ctype.h>
 
 // Utility function to check string content for ASCII encoding
@@ -55,6 +58,11 @@ RadioLimitIssue::message() const {
   return _message;
 }
 
+const QStringList &
+RadioLimitIssue::stack() const {
+  return _stack;
+}
+
 QString
 RadioLimitIssue::format() const {
   QString res; QTextStream stream(&res);
@@ -74,7 +82,8 @@ RadioLimitIssue::format() const {
  * Implementation of RadioLimitContext
  * ********************************************************************************************* */
 RadioLimitContext::RadioLimitContext(bool ignoreFrequencyLimits)
-  : _stack(), _ignoreFrequencyLimits(ignoreFrequencyLimits), _maxSeverity(RadioLimitIssue::Silent)
+  : _stack(), _ignoreFrequencyLimits(ignoreFrequencyLimits), _maxSeverity(RadioLimitIssue::Silent),
+    _parallel(false), _pool(nullptr), _cache(nullptr)
 {
   // pass...
 }
@@ -116,11 +125,210 @@ RadioLimitContext::enableIgnoreFrequencyLimits(bool enable) {
   _ignoreFrequencyLimits = enable;
 }
 
+bool
+RadioLimitContext::isParallel() const {
+  return _parallel;
+}
+void
+RadioLimitContext::enableParallel(bool enable) {
+  _parallel = enable;
+}
+
+QThreadPool *
+RadioLimitContext::threadPool() const {
+  return _pool;
+}
+void
+RadioLimitContext::setThreadPool(QThreadPool *pool) {
+  _pool = pool;
+}
+
 RadioLimitIssue::Severity
 RadioLimitContext::maxSeverity() const {
   return _maxSeverity;
 }
 
+RadioLimitCache *
+RadioLimitContext::cache() const {
+  return _cache;
+}
+
+void
+RadioLimitContext::setCache(RadioLimitCache *cache) {
+  _cache = cache;
+}
+
+QList<RadioLimitIssue>
+RadioLimitContext::issuesSince(int first) const {
+  QList<RadioLimitIssue> issues;
+  for (int i=first; i<_messages.count(); i++) {
+    const RadioLimitIssue &msg = _messages.at(i);
+    RadioLimitIssue issue(msg.severity(), msg.stack().mid(_stack.count()));
+    issue = msg.message();
+    issues.append(issue);
+  }
+  return issues;
+}
+
+void
+RadioLimitContext::append(const RadioLimitIssue &issue) {
+  _messages.push_back(RadioLimitIssue(issue.severity(), _stack + issue.stack()));
+  _messages.back() = issue.message();
+  if (issue.severity() > _maxSeverity)
+    _maxSeverity = issue.severity();
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of RadioLimitCache
+ * ********************************************************************************************* */
+RadioLimitCache::RadioLimitCache(QObject *parent)
+  : QObject(parent), _limits(), _config(), _ignoreFrequencyLimits(false), _entries(), _referrers(),
+    _watched(), _hasResult(false), _success(false), _issues()
+{
+  // pass...
+}
+
+void
+RadioLimitCache::prepare(const RadioLimits *limits, const Config *config, bool ignoreFrequencyLimits) {
+  if ((limits != _limits) || (ignoreFrequencyLimits != _ignoreFrequencyLimits))
+    clear();
+  if (config != _config) {
+    clear();
+    if (_config)
+      disconnect(_config, nullptr, this, nullptr);
+    if (config)
+      connect(config, SIGNAL(modified(ConfigItem*)), this, SLOT(onConfigModified()));
+  }
+  _limits = limits;
+  _config = config;
+  _ignoreFrequencyLimits = ignoreFrequencyLimits;
+}
+
+void
+RadioLimitCache::clear() {
+  foreach (const QObject *obj, _watched)
+    disconnect(obj, nullptr, this, nullptr);
+  _watched.clear();
+  _entries.clear();
+  _referrers.clear();
+  _hasResult = false;
+  _issues.clear();
+}
+
+int
+RadioLimitCache::count() const {
+  return _entries.count();
+}
+
+bool
+RadioLimitCache::contains(const ConfigObject *obj) const {
+  return _entries.contains(obj);
+}
+
+bool
+RadioLimitCache::hasResult() const {
+  return _hasResult;
+}
+
+bool
+RadioLimitCache::replay(const ConfigObject *obj, const RadioLimitObject *limits,
+                        RadioLimitContext &context, bool &success) const
+{
+  auto entry = _entries.find(obj);
+  if ((_entries.end() == entry) || (limits != entry->limits))
+    return false;
+  foreach (const RadioLimitIssue &issue, entry->issues)
+    context.append(issue);
+  success = entry->success;
+  return true;
+}
+
+/** Collects all objects referenced by the given item and its owned items. */
+static void
+collectReferences(const ConfigItem *item, QSet<const ConfigObject *> &refs) {
+  foreach (const ConfigItem::Schema::Property &info, item->schema().properties()) {
+    if (ConfigItem::Schema::Kind::Reference == info.kind) {
+      ConfigObjectReference *ref = info.prop.read(item).value<ConfigObjectReference *>();
+      if (ref && (! ref->isNull()))
+        refs.insert(ref->as<ConfigObject>());
+    } else if (ConfigItem::Schema::Kind::RefList == info.kind) {
+      ConfigObjectRefList *lst = info.prop.read(item).value<ConfigObjectRefList *>();
+      for (int i=0; lst && (i<lst->count()); i++)
+        refs.insert(lst->get(i));
+    } else if (ConfigItem::Schema::Kind::Item == info.kind) {
+      ConfigItem *sub = info.prop.read(item).value<ConfigItem *>();
+      if (sub)
+        collectReferences(sub, refs);
+    }
+  }
+}
+
+void
+RadioLimitCache::store(const ConfigObject *obj, const RadioLimitObject *limits,
+                       bool success, const QList<RadioLimitIssue> &issues)
+{
+  _entries.insert(obj, Entry{limits, success, issues});
+  watch(obj);
+
+  QSet<const ConfigObject *> refs;
+  collectReferences(obj, refs);
+  foreach (const ConfigObject *ref, refs) {
+    _referrers[ref].insert(obj);
+    watch(ref);
+  }
+}
+
+bool
+RadioLimitCache::replay(RadioLimitContext &context, bool &success) const {
+  if (! _hasResult)
+    return false;
+  foreach (const RadioLimitIssue &issue, _issues)
+    context.append(issue);
+  success = _success;
+  return true;
+}
+
+void
+RadioLimitCache::store(bool success, const QList<RadioLimitIssue> &issues) {
+  _hasResult = true;
+  _success = success;
+  _issues = issues;
+}
+
+void
+RadioLimitCache::invalidate(const QObject *obj) {
+  _hasResult = false;
+  _entries.remove(obj);
+  foreach (const QObject *referrer, _referrers.take(obj))
+    _entries.remove(referrer);
+}
+
+void
+RadioLimitCache::watch(const ConfigObject *obj) {
+  if (_watched.contains(obj))
+    return;
+  _watched.insert(obj);
+  connect(obj, SIGNAL(modified(ConfigItem*)), this, SLOT(onObjectModified()));
+  connect(obj, SIGNAL(destroyed(QObject*)), this, SLOT(onObjectDeleted(QObject*)));
+}
+
+void
+RadioLimitCache::onObjectModified() {
+  invalidate(sender());
+}
+
+void
+RadioLimitCache::onObjectDeleted(QObject *obj) {
+  invalidate(obj);
+  _watched.remove(obj);
+}
+
+void
+RadioLimitCache::onConfigModified() {
+  _hasResult = false;
+}
+
 
 /* ********************************************************************************************* *
  * Implementation of RadioLimitElement
@@ -219,9 +427,10 @@ RadioLimitString::verify(const ConfigItem *item, const QMetaProperty &prop, Radi
  * Implementation of RadioLimitStringRegEx
  * ********************************************************************************************* */
 RadioLimitStringRegEx::RadioLimitStringRegEx(const QString &pattern, QObject *parent)
-  : RadioLimitValue(parent), _pattern(pattern)
+  : RadioLimitValue(parent), _pattern(pattern), _regex(QString("\\A(?:%1)\\z").arg(pattern))
 {
-  // pass...
+  // Compile once, verification may run concurrently
+  _regex.optimize();
 }
 
 bool
@@ -233,10 +442,10 @@ RadioLimitStringRegEx::verify(const ConfigItem *item, const QMetaProperty &prop,
   }
 
   QString value = prop.read(item).toString();
-  if (! _pattern.exactMatch(value)) {
+  if (! _regex.match(value).hasMatch()) {
     auto &msg = context.newMessage(RadioLimitIssue::Warning);
     msg << "Value '" << value << "' of property " << prop.name()
-        << " does not match pattern '" << _pattern.pattern() << "'.";
+        << " does not match pattern '" << _pattern << "'.";
   }
 
   return true;
@@ -422,7 +631,7 @@ RadioLimitFrequencies::FrequencyRange::contains(double f) const {
  * Implementation of RadioLimitFrequencies
  * ********************************************************************************************* */
 RadioLimitFrequencies::RadioLimitFrequencies(QObject *parent)
-  : RadioLimitValue(parent), _frequencyRanges()
+  : RadioLimitValue(parent), _frequencyRanges(), _warnOnly(false)
 {
   // pass...
 }
@@ -430,8 +639,19 @@ RadioLimitFrequencies::RadioLimitFrequencies(QObject *parent)
 RadioLimitFrequencies::RadioLimitFrequencies(const RangeList &ranges, bool warnOnly, QObject *parent)
   : RadioLimitValue(parent), _frequencyRanges(), _warnOnly(warnOnly)
 {
+  QVector<FrequencyRange> sorted;
   for (auto range=ranges.begin(); range!=ranges.end(); range++) {
-    _frequencyRanges.append(FrequencyRange(range->first, range->second));
+    sorted.append(FrequencyRange(range->first, range->second));
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const FrequencyRange &a, const FrequencyRange &b) {
+    return a.min < b.min;
+  });
+  // Merge overlapping ranges
+  foreach (const FrequencyRange &range, sorted) {
+    if ((! _frequencyRanges.isEmpty()) && (range.min <= _frequencyRanges.last().max))
+      _frequencyRanges.last().max = std::max(_frequencyRanges.last().max, range.max);
+    else
+      _frequencyRanges.append(range);
   }
 }
 
@@ -445,10 +665,11 @@ RadioLimitFrequencies::verify(const ConfigItem *item, const QMetaProperty &prop,
 
   double value = prop.read(item).toDouble();
 
-  foreach (const FrequencyRange &range, _frequencyRanges) {
-    if (range.contains(value))
-      return true;
-  }
+  // Find the last range starting below or at the value
+  auto range = std::upper_bound(_frequencyRanges.begin(), _frequencyRanges.end(), value,
+                                [](double f, const FrequencyRange &r) { return f < r.min; });
+  if ((_frequencyRanges.begin() != range) && (range-1)->contains(value))
+    return true;
 
   if (context.ignoreFrequencyLimits() || (0 == _frequencyRanges.size()) || _warnOnly) {
     auto &msg = context.newMessage(RadioLimitIssue::Warning);
@@ -517,6 +738,9 @@ RadioLimitItem::add(const QString &prop, RadioLimitElement *structure) {
     return false;
   _elements.insert(prop, structure);
   structure->setParent(this);
+  // Recompile rules
+  QWriteLocker locker(&_rulesLock);
+  _rules.clear();
   return true;
 }
 
@@ -545,21 +769,39 @@ RadioLimitItem::verify(const ConfigItem *item, const QMetaProperty &prop, RadioL
 
 bool
 RadioLimitItem::verifyItem(const ConfigItem *item, RadioLimitContext &context) const {
-  const QMetaObject *meta = item->metaObject();
+  foreach (const Rule &rule, rules(item->metaObject())) {
+    if (! rule.element->verify(item, rule.prop, context))
+      return false;
+  }
+
+  return true;
+}
+
+QVector<RadioLimitItem::Rule>
+RadioLimitItem::rules(const QMetaObject *meta) const {
+  {
+    QReadLocker locker(&_rulesLock);
+    auto rules = _rules.constFind(meta);
+    if (_rules.constEnd() != rules)
+      return rules.value();
+  }
+
+  // Compile rules, resolving the property names once
+  QVector<Rule> rules;
   for (int p=QObject::staticMetaObject.propertyCount(); p<meta->propertyCount(); p++) {
     // This property
     QMetaProperty prop = meta->property(p);
     // Should never happen
     if (! prop.isValid())
       continue;
-    // Verify property
-    if (_elements.contains(prop.name())) {
-      if (! _elements[prop.name()]->verify(item, prop, context))
-        return false;
-    }
+    auto element = _elements.constFind(prop.name());
+    if (_elements.constEnd() != element)
+      rules.append(Rule{prop, element.value()});
   }
 
-  return true;
+  QWriteLocker locker(&_rulesLock);
+  _rules.insert(meta, rules);
+  return rules;
 }
 
 
@@ -731,12 +973,25 @@ RadioLimitList::verify(const ConfigItem *item, const QMetaProperty &prop, RadioL
 
   context.push(QString("List '%1'").arg(prop.name()));
 
+  // Resolve types, the verification stops at the first element of unexpected type
+  QStringList classNames;
+  for (int i=0; i<plist->count(); i++) {
+    QString className = findClassName(*(plist->get(i)->metaObject()));
+    if (className.isEmpty())
+      break;
+    classNames.append(className);
+  }
+
+  // Verify large lists concurrently, if enabled
+  QVector<ElementResult> results;
+  if (context.isParallel() && (classNames.count() >= 64))
+    results = verifyConcurrently(plist, classNames, context);
+
   // Check type and structure
   for (int i=0; i<plist->count(); i++) {
     // Check type
     ConfigObject *obj = plist->get(i);
-    QString className = findClassName(*(obj->metaObject()));
-    if (className.isEmpty()) {
+    if (i >= classNames.count()) {
       auto &msg = context.newMessage(RadioLimitIssue::Critical);
       msg << "Unexpected element type '" << obj->metaObject()->className()
           << "'. Expected one of " << _elements.keys().join(", ") << ".";
@@ -744,10 +999,28 @@ RadioLimitList::verify(const ConfigItem *item, const QMetaProperty &prop, RadioL
       return false;
     }
 
+    QString className = classNames.at(i);
     counts[className]++;
 
     context.push(QString("Element %1 ('%2')").arg(i).arg(obj->name()));
-    if (! _elements[className]->verifyObject(obj, context)) {
+    const RadioLimitObject *limits = _elements[className];
+    bool success = true;
+    RadioLimitCache *cache = context.cache();
+    if (cache && cache->replay(obj, limits, context, success)) {
+      // pass...
+    } else if ((i < results.count()) && results.at(i).done) {
+      success = results.at(i).success;
+      foreach (const RadioLimitIssue &issue, results.at(i).issues)
+        context.append(issue);
+      if (cache)
+        cache->store(obj, limits, success, results.at(i).issues);
+    } else {
+      int first = context.count();
+      success = limits->verifyObject(obj, context);
+      if (cache)
+        cache->store(obj, limits, success, context.issuesSince(first));
+    }
+    if (! success) {
       context.pop();
       context.pop();
       return false;
@@ -774,6 +1047,51 @@ RadioLimitList::verify(const ConfigItem *item, const QMetaProperty &prop, RadioL
   return true;
 }
 
+QVector<RadioLimitList::ElementResult>
+RadioLimitList::verifyConcurrently(const ConfigObjectList *plist, const QStringList &classNames,
+                                   const RadioLimitContext &context) const
+{
+  QVector<ElementResult> results(classNames.count());
+  ElementResult *result = results.data();
+
+  // Skip elements with cached results, the cache itself is not touched by the workers
+  QVector<int> pending;
+  for (int i=0; i<classNames.count(); i++) {
+    if ((nullptr == context.cache()) || (! context.cache()->contains(plist->get(i))))
+      pending.append(i);
+  }
+
+  // Each worker verifies a chunk of elements in order using its own context and stops at the
+  // first failing element. As the results are merged in order, later elements are not needed.
+  bool ignoreFrequencyLimits = context.ignoreFrequencyLimits();
+  int chunk = std::max(32, pending.size()/(4*std::max(1, QThread::idealThreadCount())));
+  TaskGraph tasks;
+  for (int first=0; first<pending.size(); first+=chunk) {
+    int last = std::min(pending.size(), first+chunk);
+    tasks.add([this, first, last, result, &pending, &classNames, plist, ignoreFrequencyLimits]
+              (const ErrorStack &err) {
+      Q_UNUSED(err);
+      RadioLimitContext local(ignoreFrequencyLimits);
+      for (int j=first; j<last; j++) {
+        int i = pending.at(j);
+        ConfigObject *obj = plist->get(i);
+        local.push(QString("Element %1 ('%2')").arg(i).arg(obj->name()));
+        int start = local.count();
+        result[i].success = _elements[classNames.at(i)]->verifyObject(obj, local);
+        result[i].issues = local.issuesSince(start);
+        result[i].done = true;
+        local.pop();
+        if (! result[i].success)
+          break;
+      }
+      return true;
+    });
+  }
+  tasks.run(ErrorStack(), context.threadPool());
+
+  return results;
+}
+
 QString
 RadioLimitList::findClassName(const QMetaObject &type) const {
   if (_elements.contains(type.className()))
@@ -959,11 +1277,25 @@ RadioLimits::numCallSignDBEntries() const {
 
 bool
 RadioLimits::verifyConfig(const Config *config, RadioLimitContext &context) const {
+  bool success = true;
+  RadioLimitCache *cache = context.cache();
+  if (cache) {
+    cache->prepare(this, config, context.ignoreFrequencyLimits());
+    // If nothing has changed since the last verification, just replay the result
+    if (cache->replay(context, success))
+      return success;
+  }
+
+  int first = context.count();
   if (_betaWarning) {
     auto &msg = context.newMessage(RadioLimitIssue::Warning);
     msg = tr("The support for this radio is still under development. Some features may sill be "
              "missing or are not well tested.");
   }
 
-  return verifyItem(config, context);
+  success = verifyItem(config, context);
+  // Failed verifications are not cached as they may have stopped before all objects were observed
+  if (cache && success)
+    cache->store(success, context.issuesSince(first));
+  return success;
 }
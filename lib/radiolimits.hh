@@ -33,12 +33,21 @@
 #include <QTextStream>
 #include <QMetaType>
 #include <QSet>
+#include <QHash>
+#include <QPointer>
+#include <QVector>
+#include <QRegularExpression>
+#include <QReadWriteLock>
 
 // Forward declaration
 class Config;
 class ConfigItem;
 class ConfigObject;
+class RadioLimitObject;
 class RadioLimits;
+class RadioLimitCache;
+class ConfigObjectList;
+class QThreadPool;
 
 
 /** Represents a single issue found during verification.
@@ -70,6 +79,8 @@ public:
   Severity severity() const;
   /** Returns the text message. */
   const QString &message() const;
+  /** Returns the item-stack, where the issue occurred. */
+  const QStringList &stack() const;
   /** Formats the message. */
   QString format() const;
 
@@ -112,9 +123,32 @@ public:
   /** Enables/disables that frequency range voilations are handled as warnings. */
   void enableIgnoreFrequencyLimits(bool enable=true);
 
+  /** If @c true, the elements of large lists are verified concurrently. */
+  bool isParallel() const;
+  /** Enables/disables the concurrent verification of list elements. The issues found are
+   * identical to a serial verification. */
+  void enableParallel(bool enable=true);
+  /** Returns the thread pool used for the concurrent verification or @c nullptr for the global
+   * one. */
+  QThreadPool *threadPool() const;
+  /** Sets the thread pool used for the concurrent verification. The ownership remains with the
+   * caller. If @c nullptr, the global thread pool is used. */
+  void setThreadPool(QThreadPool *pool);
+
   /** Returns the highest severity of the messages. */
   RadioLimitIssue::Severity maxSeverity() const;
 
+  /** Returns the cache of verification results or @c nullptr if results are not cached. */
+  RadioLimitCache *cache() const;
+  /** Sets the cache of verification results. The ownership remains with the caller. */
+  void setCache(RadioLimitCache *cache);
+
+  /** Returns copies of all issues found since the @c first-th issue. The item stacks of the
+   * copies are relative to the current stack. */
+  QList<RadioLimitIssue> issuesSince(int first) const;
+  /** Appends the given issue, its item-stack is taken relative to the current stack. */
+  void append(const RadioLimitIssue &issue);
+
 protected:
   /** The current item stack. */
   QStringList _stack;
@@ -124,6 +158,103 @@ protected:
   bool _ignoreFrequencyLimits;
   /** Holds the highest severity of all messages. */
   RadioLimitIssue::Severity _maxSeverity;
+  /** If @c true, list elements are verified concurrently. */
+  bool _parallel;
+  /** A weak reference to the thread pool, if @c nullptr the global one is used. */
+  QThreadPool *_pool;
+  /** A weak reference to the result cache. */
+  RadioLimitCache *_cache;
+};
+
+
+/** Caches the verification results of the objects of a configuration.
+ *
+ * Once set to a @c RadioLimitContext, the results of every list element get cached together with
+ * the issues found. The cache observes the verified objects as well as the objects they refer to.
+ * Whenever one of them gets modified or deleted, the results of the modified object and all
+ * objects referring to it are dropped. Hence a subsequent verification of the same configuration
+ * against the same limits only re-verifies the modified objects. If the configuration has not been
+ * modified at all, the complete result is replayed.
+ *
+ * @ingroup limits */
+class RadioLimitCache: public QObject
+{
+  Q_OBJECT
+
+public:
+  /** Constructs an empty cache. */
+  explicit RadioLimitCache(QObject *parent=nullptr);
+
+  /** Prepares the cache for the verification of the given config with the specified limits.
+   * If any of these differ from the previous verification, the cache gets cleared. */
+  void prepare(const RadioLimits *limits, const Config *config, bool ignoreFrequencyLimits);
+  /** Drops all cached results. */
+  void clear();
+
+  /** Returns the number of objects with cached results. */
+  int count() const;
+  /** Returns @c true if there is a cached result for the given object. */
+  bool contains(const ConfigObject *obj) const;
+  /** Returns @c true if the result for the entire config is cached. */
+  bool hasResult() const;
+
+  /** Appends the cached issues of the given object verified with the given limits to the context.
+   * @returns @c true if a result was cached. In this case, @c success gets set accordingly. */
+  bool replay(const ConfigObject *obj, const RadioLimitObject *limits,
+              RadioLimitContext &context, bool &success) const;
+  /** Caches the result of the verification of the given object with the given limits. */
+  void store(const ConfigObject *obj, const RadioLimitObject *limits,
+             bool success, const QList<RadioLimitIssue> &issues);
+
+  /** Appends the cached issues of the entire config to the context.
+   * @returns @c true if a result was cached. In this case, @c success gets set accordingly. */
+  bool replay(RadioLimitContext &context, bool &success) const;
+  /** Caches the result of the verification of the entire config. */
+  void store(bool success, const QList<RadioLimitIssue> &issues);
+
+protected:
+  /** Drops the result of the given object and of all objects referring to it. */
+  void invalidate(const QObject *obj);
+  /** Observes the given object for changes. */
+  void watch(const ConfigObject *obj);
+
+protected slots:
+  /** Gets called whenever a verified or referenced object is modified. */
+  void onObjectModified();
+  /** Gets called whenever a verified or referenced object is deleted. */
+  void onObjectDeleted(QObject *obj);
+  /** Gets called whenever the config is modified. */
+  void onConfigModified();
+
+protected:
+  /** A cached result of a single object. */
+  struct Entry {
+    /** The limits, the object was verified with. */
+    const RadioLimitObject *limits;
+    /** The verification result. */
+    bool success;
+    /** The issues found, relative to the object. */
+    QList<RadioLimitIssue> issues;
+  };
+
+  /** The limits, the results were obtained with. */
+  QPointer<const RadioLimits> _limits;
+  /** The config, the results were obtained from. */
+  QPointer<const Config> _config;
+  /** If @c true, frequency range violations were handled as warnings. */
+  bool _ignoreFrequencyLimits;
+  /** The cached results per object. */
+  QHash<const QObject *, Entry> _entries;
+  /** Maps each referenced object to the set of objects referring to it. */
+  QHash<const QObject *, QSet<const QObject *>> _referrers;
+  /** The set of observed objects. */
+  QSet<const QObject *> _watched;
+  /** If @c true, the result of the entire config is cached. */
+  bool _hasResult;
+  /** The cached result of the entire config. */
+  bool _success;
+  /** The issues found in the entire config. */
+  QList<RadioLimitIssue> _issues;
 };
 
 
@@ -144,7 +275,9 @@ protected:
 
 public:
   /** Verifies the given property of the specified item.
-   * This method gets implemented by the specialized classes to implement the actual verification. */
+   * This method gets implemented by the specialized classes to implement the actual verification.
+   * It may be called concurrently for different items (see @c RadioLimitContext::enableParallel),
+   * hence implementations must not modify any shared state without locking. */
   virtual bool verify(const ConfigItem *item, const QMetaProperty &prop, RadioLimitContext &context) const = 0;
 
 public:
@@ -220,7 +353,9 @@ public:
 
 protected:
   /** Holds the regular expression pattern. */
-  QRegExp _pattern;
+  QString _pattern;
+  /** Holds the compiled and optimized regular expression, matching the entire string. */
+  QRegularExpression _regex;
 };
 
 
@@ -367,8 +502,9 @@ public:
   bool verify(const ConfigItem *item, const QMetaProperty &prop, RadioLimitContext &context) const;
 
 protected:
-  /** Holds the frequency ranges for the device. */
-  QList<FrequencyRange> _frequencyRanges;
+  /** Holds the frequency ranges for the device, sorted by their lower limit and merged if they
+   * overlap. */
+  QVector<FrequencyRange> _frequencyRanges;
   /** If @c true, throw only a warning. */
   bool _warnOnly;
 };
@@ -422,9 +558,26 @@ public:
   /** Verifies the properties of the given item. */
   virtual bool verifyItem(const ConfigItem *item, RadioLimitContext &context) const;
 
+protected:
+  /** A compiled rule, applying the limits to a property of a specific class. */
+  struct Rule {
+    /** The property to check. */
+    QMetaProperty prop;
+    /** The limits of the property. */
+    const RadioLimitElement *element;
+  };
+
+  /** Returns the rules for the given class in the order of its properties. The rules are compiled
+   * once per class. Thread-safe. */
+  QVector<Rule> rules(const QMetaObject *meta) const;
+
 protected:
   /** Holds the property <-> limits map. */
   QHash<QString, RadioLimitElement *> _elements;
+  /** The compiled rules per class. */
+  mutable QHash<const QMetaObject *, QVector<Rule>> _rules;
+  /** Guards the compiled rules. */
+  mutable QReadWriteLock _rulesLock;
 };
 
 
@@ -595,8 +748,23 @@ public:
   bool verify(const ConfigItem *item, const QMetaProperty &prop, RadioLimitContext &context) const;
 
 protected:
+  /** The result of the verification of a single element. */
+  struct ElementResult {
+    /** If @c true, the element was verified. */
+    bool done = false;
+    /** The verification result. */
+    bool success = true;
+    /** The issues found, relative to the element. */
+    QList<RadioLimitIssue> issues;
+  };
+
   /** Searches for the specified type or one of its super-clsases in the set of allowed types. */
   QString findClassName(const QMetaObject &type) const;
+  /** Verifies the elements of the given list concurrently. Elements with cached results are
+   * skipped. */
+  QVector<ElementResult> verifyConcurrently(const ConfigObjectList *plist,
+                                            const QStringList &classNames,
+                                            const RadioLimitContext &context) const;
 
 protected:
   /** Maps typename to element definition. */
@@ -2,6 +2,7 @@
 #include "channel.hh"
 #include <QSet>
 #include "config.hh"
+#include <QMutex>
 
 /* ********************************************************************************************* *
  * Implementation of RoamingZone
@@ -105,6 +106,23 @@ RoamingZone::link(const YAML::Node &node, const Context &ctx, const ErrorStack &
                 << ": Cannot link 'channels' of 'RoamingZone': Expected sequence.";
     return false;
   }
+
+  // Adds a referenced channel at the given position, DMR channels are added as roaming channels
+  Context::Resolver add = [this](ConfigObject *obj, int row, const ErrorStack &err) {
+    if (obj->is<DMRChannel>()) {
+      RoamingChannel *rch = RoamingChannel::fromDMRChannel(obj->as<DMRChannel>());
+      config()->roamingChannels()->add(rch);
+      addChannel(rch, row);
+    } else if (obj->is<RoamingChannel>()) {
+      addChannel(obj->as<RoamingChannel>(), row);
+    } else {
+      errMsg(err) << "Cannot add reference to '" << obj->name() << "' to list. "
+                  << "Not a roaming channel.";
+      return false;
+    }
+    return true;
+  };
+
   YAML::Node lst = node["channels"];
   for (YAML::const_iterator it=lst.begin(); it!=lst.end(); it++) {
     if (! it->IsScalar()) {
@@ -113,25 +131,20 @@ RoamingZone::link(const YAML::Node &node, const Context &ctx, const ErrorStack &
       return false;
     }
     QString id = QString::fromStdString(it->as<std::string>());
-    if (! ctx.contains(id)) {
+    if ((! ctx.contains(id)) && ctx.defersReferences()) {
+      // Channel is defined later in the document
+      ctx.deferReference(&_channel, id, "'channels' of 'RoamingZone'", it->Mark(), add);
+      continue;
+    } else if (! ctx.contains(id)) {
       errMsg(err) << it->Mark().line << ":" << it->Mark().column
                   << ": Cannot link 'channels' of 'RoamingZone': Reference '"
                   << id << "' not defined.";
       return false;
     }
     // Handle referenced object (either DMR channel or roaming channel)
-    ConfigObject *obj = ctx.getObj(id);
-    if (obj->is<DMRChannel>()) {
-      RoamingChannel *rch = RoamingChannel::fromDMRChannel(obj->as<DMRChannel>());
-      config()->roamingChannels()->add(rch);
-      addChannel(rch);
-    } else if (obj->is<RoamingChannel>()) {
-      addChannel(obj->as<RoamingChannel>());
-    } else {
+    if (! add(ctx.getObj(id), -1, err)) {
       errMsg(err) << it->Mark().line << ":" << it->Mark().column
-                  << ": Cannot link 'channels' of 'RoamingZone': "
-                  << "Cannot add reference to '" << id << "' to list. "
-                  << "Not a roaming channel.";
+                  << ": Cannot link 'channels' of 'RoamingZone'.";
       return false;
     }
   }
@@ -171,6 +184,9 @@ DefaultRoamingZone::DefaultRoamingZone(QObject *parent)
 
 DefaultRoamingZone *
 DefaultRoamingZone::get() {
+  // May be called concurrently, e.g., by channels created while decoding a codeplug
+  static QMutex mutex;
+  QMutexLocker locker(&mutex);
   if (nullptr == _instance)
     _instance = new DefaultRoamingZone();
   return _instance;
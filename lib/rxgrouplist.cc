@@ -22,6 +22,7 @@ RXGroupList::RXGroupList(QObject *parent)
   connect(&_contacts, SIGNAL(elementModified(int)), this, SLOT(onModified()));
   connect(&_contacts, SIGNAL(elementRemoved(int)), this, SLOT(onModified()));
   connect(&_contacts, SIGNAL(elementAdded(int)), this, SLOT(onModified()));
+  connect(&_contacts, SIGNAL(elementsAdded(int,int)), this, SLOT(onModified()));
 }
 
 RXGroupList::RXGroupList(const QString &name, QObject *parent)
@@ -30,6 +31,7 @@ RXGroupList::RXGroupList(const QString &name, QObject *parent)
   connect(&_contacts, SIGNAL(elementModified(int)), this, SLOT(onModified()));
   connect(&_contacts, SIGNAL(elementRemoved(int)), this, SLOT(onModified()));
   connect(&_contacts, SIGNAL(elementAdded(int)), this, SLOT(onModified()));
+  connect(&_contacts, SIGNAL(elementsAdded(int,int)), this, SLOT(onModified()));
 }
 
 RXGroupList &
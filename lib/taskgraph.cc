@@ -0,0 +1,186 @@
+#include "taskgraph.hh"
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QSharedPointer>
+#include <QQueue>
+
+
+/* ********************************************************************************************* *
+ * Implementation of TaskGraph::Execution
+ * ********************************************************************************************* */
+class TaskGraph::Execution
+{
+public:
+  /** Constructs the execution state for the given number of tasks. */
+  Execution(QThreadPool *threads, int n)
+    : pool(threads), mutex(), changed(), pending(n, 0), ready(), errors(n),
+      running(0), workers(0), maxWorkers(threads->maxThreadCount()-1), failed(false)
+  {
+    // pass...
+  }
+
+  /** The thread pool to use. */
+  QThreadPool *pool;
+  /** Protects the state. */
+  QMutex mutex;
+  /** Signals a change of the state. */
+  QWaitCondition changed;
+  /** Number of unfinished dependencies for each task. */
+  QVector<int> pending;
+  /** Queue of tasks ready to run. */
+  QQueue<int> ready;
+  /** An error stack for each task. */
+  QVector<ErrorStack> errors;
+  /** Number of tasks currently running. */
+  int running;
+  /** Number of pool threads working on the graph. */
+  int workers;
+  /** Maximum number of pool threads, the calling thread works too. */
+  int maxWorkers;
+  /** Set if any task failed. */
+  bool failed;
+};
+
+
+/* ********************************************************************************************* *
+ * Implementation of TaskGraphRunnable
+ * ********************************************************************************************* */
+/** Works on the graph within a pool thread. */
+class TaskGraphRunnable: public QRunnable
+{
+public:
+  /** Constructor. */
+  TaskGraphRunnable(const TaskGraph &graph, const QSharedPointer<TaskGraph::Execution> &exec)
+    : QRunnable(), _graph(graph), _exec(exec)
+  {
+    // pass...
+  }
+
+  void run() {
+    _graph.work(_exec, false);
+  }
+
+protected:
+  /** The graph. */
+  const TaskGraph &_graph;
+  /** The shared execution state. Keeps it alive until the runnable is done. */
+  QSharedPointer<TaskGraph::Execution> _exec;
+};
+
+
+/* ********************************************************************************************* *
+ * Implementation of TaskGraph
+ * ********************************************************************************************* */
+TaskGraph::TaskGraph()
+  : _nodes()
+{
+  // pass...
+}
+
+int
+TaskGraph::add(const Task &task, const QList<int> &dependencies) {
+  int id = _nodes.size();
+  Node node{task, 0, QList<int>()};
+  foreach (int dep, dependencies) {
+    if ((0 > dep) || (dep >= id))
+      continue;
+    node.dependencies++;
+    _nodes[dep].dependents.append(id);
+  }
+  _nodes.append(node);
+  return id;
+}
+
+int
+TaskGraph::count() const {
+  return _nodes.size();
+}
+
+bool
+TaskGraph::runSerial(const ErrorStack &err) const {
+  foreach (const Node &node, _nodes) {
+    if (! node.task(err))
+      return false;
+  }
+  return true;
+}
+
+bool
+TaskGraph::run(const ErrorStack &err, QThreadPool *pool) const {
+  if (nullptr == pool)
+    pool = QThreadPool::globalInstance();
+  if ((2 > _nodes.size()) || (2 > pool->maxThreadCount()))
+    return runSerial(err);
+
+  QSharedPointer<Execution> exec(new Execution(pool, _nodes.size()));
+  for (int i=0; i<_nodes.size(); i++) {
+    exec->pending[i] = _nodes[i].dependencies;
+    if (0 == exec->pending[i])
+      exec->ready.enqueue(i);
+  }
+
+  work(exec, true);
+
+  // Collect error messages in order
+  for (int i=0; i<exec->errors.size(); i++) {
+    if (! exec->errors[i].isEmpty())
+      err.take(exec->errors[i]);
+  }
+
+  return ! exec->failed;
+}
+
+void
+TaskGraph::work(const QSharedPointer<Execution> &shared, bool caller) const {
+  Execution &exec = *shared;
+  QMutexLocker locker(&exec.mutex);
+
+  while (true) {
+    if ((! exec.failed) && (! exec.ready.isEmpty())) {
+      int id = exec.ready.dequeue();
+      exec.running++;
+      // Start helpers if there is more work to do. Only use idle threads of the pool, such that
+      // the caller never waits for a helper not yet started.
+      while ((! exec.ready.isEmpty()) && (exec.workers < exec.maxWorkers)
+             && (exec.workers < exec.ready.size())) {
+        TaskGraphRunnable *helper = new TaskGraphRunnable(*this, shared);
+        if (! exec.pool->tryStart(helper)) {
+          delete helper;
+          break;
+        }
+        exec.workers++;
+      }
+
+      locker.unlock();
+      bool ok = _nodes[id].task(exec.errors[id]);
+      locker.relock();
+
+      exec.running--;
+      if (! ok) {
+        exec.failed = true;
+      } else {
+        foreach (int dep, _nodes[id].dependents) {
+          if (0 == (--exec.pending[dep]))
+            exec.ready.enqueue(dep);
+        }
+      }
+      exec.changed.wakeAll();
+      continue;
+    }
+
+    if (! caller)
+      break;
+    // Done, if no task is running and there is nothing left to do. Wait for all helpers to leave.
+    if ((0 == exec.running) && (0 == exec.workers) && (exec.failed || exec.ready.isEmpty()))
+      break;
+    exec.changed.wait(&exec.mutex);
+  }
+
+  if (! caller) {
+    exec.workers--;
+    exec.changed.wakeAll();
+  }
+}
@@ -0,0 +1,75 @@
+#ifndef TASKGRAPH_HH
+#define TASKGRAPH_HH
+
+#include <functional>
+#include <QVector>
+#include <QList>
+#include <QSharedPointer>
+#include "errorstack.hh"
+
+class QThreadPool;
+
+/** Runs a set of tasks concurrently on a thread pool, respecting the dependencies between them.
+ *
+ * A task may only depend on tasks added before. Hence the graph is always acyclic and running the
+ * tasks one after another in the order they were added is always valid. Tasks without a mutual
+ * dependency may run concurrently, thus they must not modify any shared state.
+ *
+ * The calling thread takes part in the execution. Hence the graph can be run from within a pool
+ * thread without the risk of a dead-lock.
+ *
+ * @ingroup util */
+class TaskGraph
+{
+public:
+  /** Type of the tasks. A task reports errors to the given stack and returns @c false on error. */
+  typedef std::function<bool(const ErrorStack &err)> Task;
+
+public:
+  /** Empty constructor. */
+  TaskGraph();
+
+  /** Adds a task, that depends on the given tasks. Returns the ID of the new task. */
+  int add(const Task &task, const QList<int> &dependencies=QList<int>());
+  /** Returns the number of tasks. */
+  int count() const;
+
+  /** Runs all tasks using the given thread pool. If @c pool is @c nullptr, the global thread pool
+   * is used. If the pool is limited to a single thread, the tasks are run serially.
+   *
+   * If a task fails, no further tasks are started. The error messages of all failed tasks are
+   * put on the error stack in the order the tasks were added.
+   * @returns @c false if any task failed. */
+  bool run(const ErrorStack &err=ErrorStack(), QThreadPool *pool=nullptr) const;
+  /** Runs all tasks serially in the order they were added.
+   * @returns @c false if any task failed. */
+  bool runSerial(const ErrorStack &err=ErrorStack()) const;
+
+protected:
+  /** Holds the state of a single execution of the graph. */
+  class Execution;
+
+  /** A node of the graph. */
+  struct Node {
+    /** The actual task. */
+    Task task;
+    /** Number of tasks this task depends on. */
+    int dependencies;
+    /** The tasks depending on this task. */
+    QList<int> dependents;
+  };
+
+protected:
+  /** Runs tasks until there are no tasks ready. If @c caller is @c true, waits for other tasks to
+   * finish and returns only if all tasks are done. */
+  void work(const QSharedPointer<Execution> &exec, bool caller) const;
+
+  /** Internal used runnable, executing tasks on a pool thread. */
+  friend class TaskGraphRunnable;
+
+protected:
+  /** The nodes of the graph. */
+  QVector<Node> _nodes;
+};
+
+#endif // TASKGRAPH_HH
@@ -0,0 +1,57 @@
+#include "textstreambuffer.hh"
+#include <QTextStream>
+#include <QString>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+
+TextStreamBuffer::TextStreamBuffer(QTextStream &stream, size_t size)
+  : std::streambuf(), _stream(stream), _buffer(std::max(size_t(8), size))
+{
+  setp(_buffer.data(), _buffer.data()+_buffer.size());
+}
+
+TextStreamBuffer::~TextStreamBuffer() {
+  sync();
+}
+
+TextStreamBuffer::int_type
+TextStreamBuffer::overflow(int_type c) {
+  forward();
+  if (traits_type::eq_int_type(c, traits_type::eof()))
+    return traits_type::not_eof(c);
+  *pptr() = traits_type::to_char_type(c);
+  pbump(1);
+  return c;
+}
+
+int
+TextStreamBuffer::sync() {
+  forward();
+  _stream.flush();
+  return 0;
+}
+
+void
+TextStreamBuffer::forward() {
+  char *begin = pbase(), *end = pptr();
+  if (begin == end)
+    return;
+
+  // Find the start of the last UTF-8 sequence and check if it is complete
+  char *last = end-1;
+  while ((last > begin) && (0x80 == (uint8_t(*last) & 0xc0)))
+    last--;
+  uint8_t lead = uint8_t(*last);
+  size_t len = (lead < 0x80) ? 1 : ((lead >= 0xf0) ? 4 : ((lead >= 0xe0) ? 3 : 2));
+  char *complete = ((last + len) <= end) ? end : last;
+
+  _stream << QString::fromUtf8(begin, complete-begin);
+
+  // Keep incomplete sequence
+  size_t rest = end-complete;
+  std::memmove(_buffer.data(), complete, rest);
+  setp(_buffer.data(), _buffer.data()+_buffer.size());
+  pbump(int(rest));
+}
@@ -0,0 +1,38 @@
+#ifndef TEXTSTREAMBUFFER_HH
+#define TEXTSTREAMBUFFER_HH
+
+#include <streambuf>
+#include <vector>
+
+class QTextStream;
+
+/** A @c std::streambuf forwarding UTF-8 encoded data into a @c QTextStream.
+ *
+ * This allows to write directly into a @c QTextStream from code expecting a @c std::ostream,
+ * like the YAML emitter. Data is collected in a fixed size buffer and forwarded in chunks. Multi
+ * byte sequences split between two chunks are kept back until they are complete.
+ *
+ * @ingroup util */
+class TextStreamBuffer: public std::streambuf
+{
+public:
+  /** Constructs a buffer writing into the given stream. */
+  explicit TextStreamBuffer(QTextStream &stream, size_t size=0x10000);
+  /** Destructor, flushes the buffer. */
+  virtual ~TextStreamBuffer();
+
+protected:
+  int_type overflow(int_type c);
+  int sync();
+
+  /** Forwards the complete UTF-8 sequences in the buffer to the text stream. */
+  void forward();
+
+protected:
+  /** The destination stream. */
+  QTextStream &_stream;
+  /** The buffer. */
+  std::vector<char> _buffer;
+};
+
+#endif // TEXTSTREAMBUFFER_HH
@@ -165,26 +165,24 @@ TyTCallsignDB::encode(UserDatabase *db, const Selection &selection, const ErrorS
   clearIndex();
 
   // Select n users and sort them in ascending order of their IDs
-  QVector<UserDatabase::User> users;
-  for (unsigned i=0; i<n; i++)
-    users.append(db->user(i));
-  std::sort(users.begin(), users.end(),
-            [](const UserDatabase::User &a, const UserDatabase::User &b) { return a.id < b.id; });
+  QVector<int> users = selectUsers(db, n);
 
   // Store number of entries
   setNumEntries(n);
 
   // First index entry
   int  j = 0;
-  setIndexEntry(j++, users[0].id, 1);
-  unsigned cidh = (users[0].id >> 12);
+  setIndexEntry(j++, db->view(users[0]).id(), 1);
+  unsigned cidh = (db->view(users[0]).id() >> 12);
 
-  // Store users and update index
+  // Store users and update index. Encoded serially, as each index entry depends on the ID of the
+  // previous user.
   for (unsigned i=0; i<n; i++) {
-    setEntry(i, users[i]);
-    unsigned idh = (users[i].id >> 12);
+    UserDatabase::User user = db->user(users[i]);
+    setEntry(i, user);
+    unsigned idh = (user.id >> 12);
     if (idh != cidh) {
-      setIndexEntry(j++,users[i].id, i+1);
+      setIndexEntry(j++, user.id, i+1);
       cidh = idh;
     }
   }
@@ -2,8 +2,10 @@
 #include "config.hh"
 #include "logger.hh"
 #include "utils.hh"
+#include <QSet>
 
 #define BSIZE 1024
+#define ESIZE 0x10000
 
 
 TyTRadio::TyTRadio(TyTInterface *device, QObject *parent)
@@ -214,27 +216,51 @@ TyTRadio::upload() {
     }
   }
 
+  // Remember downloaded codeplug to upload modified blocks only
+  if (_codeplugFlags.updateCodePlug)
+    codeplug().takeSnapshot();
+  else
+    codeplug().clearSnapshot();
+
   // Encode config into codeplug
   logDebug() << "Encode codeplug.";
   codeplug().encode(_config, _codeplugFlags);
 
+  // Collect the erase sectors containing modified blocks, only these get erased and rewritten
+  QSet<unsigned> sectors;
+  foreach (const DFUFile::Extent &e, codeplug().image(0).modified(BSIZE)) {
+    for (unsigned s=e.address/ESIZE; s<=(e.address+e.size-1)/ESIZE; s++)
+      sectors.insert(s);
+  }
+
   // then erase memory
-  for (int i=0; i<codeplug().image(0).numElements(); i++)
-    _dev->erase(codeplug().image(0).element(i).address(), codeplug().image(0).element(i).memSize(),
-                nullptr, nullptr, _errorStack);
+  foreach (unsigned s, sectors)
+    _dev->erase(s*ESIZE, ESIZE, nullptr, nullptr, _errorStack);
+
+  totb = 0;
+  for (int n=0; n<codeplug().image(0).numElements(); n++) {
+    unsigned addr = codeplug().image(0).element(n).address();
+    unsigned size = codeplug().image(0).element(n).memSize();
+    for (unsigned a=addr; a<(addr+size); a+=BSIZE)
+      if (sectors.contains(a/ESIZE))
+        totb += BSIZE;
+  }
 
-  logDebug() << "Upload " << codeplug().image(0).numElements() << " elements.";
+  logDebug() << "Upload " << totb << "b in " << sectors.size() << " modified sectors.";
   // then, upload modified codeplug
   bcount = 0;
   for (int n=0; n<codeplug().image(0).numElements(); n++) {
     unsigned addr = codeplug().image(0).element(n).address();
     unsigned size = codeplug().image(0).element(n).memSize();
     unsigned b0 = addr/BSIZE, nb = size/BSIZE;
-    for (size_t b=0; b<nb; b++,bcount+=BSIZE) {
+    for (size_t b=0; b<nb; b++) {
+      if (! sectors.contains(((b0+b)*BSIZE)/ESIZE))
+        continue;
       if (! _dev->write(0, (b0+b)*BSIZE, codeplug().data((b0+b)*BSIZE), BSIZE, _errorStack)) {
         errMsg(_errorStack) << "Cannot upload codeplug.";
         return false;
       }
+      bcount+=BSIZE;
       emit uploadProgress(50+float(bcount*50)/totb);
     }
   }
@@ -1,13 +1,273 @@
 #include "userdatabase.hh"
 #include <QJsonDocument>
-#include <QJsonArray>
 #include <QStandardPaths>
 #include <QFile>
 #include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QtEndian>
+#include <QPair>
 #include <QNetworkReply>
 #include <algorithm>
+#include <numeric>
 #include "logger.hh"
-#include <cmath>
+#include <limits>
+#include <vector>
+#include <cstring>
+#include <cctype>
+
+
+/* ********************************************************************************************* *
+ * Binary cache format
+ * ********************************************************************************************* */
+/* The cache is a dump of the columns of UserDatabase::Store. It consists of a fixed header,
+ * followed by the column of user IDs (sorted), the column of string indices (7 per user), the
+ * offsets of the interned strings within the pool (one more than strings) and the string pool
+ * itself. All integers are stored in little endian. */
+#define USERDB_CACHE_MAGIC   "QDMRUSDB"
+#define USERDB_CACHE_VERSION 2
+
+struct __attribute__((packed)) userdb_cache_header_t {
+  char    magic[8];       ///< Magic string "QDMRUSDB".
+  quint32 version;        ///< Version of the cache format.
+  quint32 count;          ///< Number of users.
+  qint64  sourceSize;     ///< Size of the JSON file, the cache was generated from.
+  qint64  sourceModified; ///< Modification time of the JSON file in ms since epoch.
+  quint32 strings;        ///< Number of interned strings.
+  quint32 poolSize;       ///< Size of the string pool in bytes.
+};
+
+static_assert(0 == (sizeof(userdb_cache_header_t) % sizeof(quint32)),
+              "Columns of the cache must be aligned.");
+
+/** Returns a column of @c n little endian integers. On little endian hosts, the column references
+ * the given data. */
+static UserDatabase::Column
+read_column(const uchar *data, int n) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+  return UserDatabase::Column::fromRawData(reinterpret_cast<const quint32 *>(data), n);
+#else
+  UserDatabase::Column column;
+  column.resize(n);
+  quint32 *values = column.data();
+  for (int i=0; i<n; i++)
+    values[i] = qFromLittleEndian<quint32>(data + 4*i);
+  return column;
+#endif
+}
+
+/** Writes a column of little endian integers. */
+static void
+write_column(QIODevice &dev, const UserDatabase::Column &column) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+  dev.write(reinterpret_cast<const char *>(column.constData()), 4*column.size());
+#else
+  QByteArray buffer(4*column.size(), 0);
+  uchar *data = reinterpret_cast<uchar *>(buffer.data());
+  for (int i=0; i<column.size(); i++)
+    qToLittleEndian<quint32>(column.at(i), data + 4*i);
+  dev.write(buffer);
+#endif
+}
+
+/** Powers of 10 up to 10^19. */
+static const quint64 pow10_table[] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+  1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+  100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+  1000000000000000000ULL, 10000000000000000000ULL };
+
+/** Returns the smallest d with 10^d >= id, that is, ceil(log10(id)). */
+static inline int
+id_digits(unsigned id) {
+  int d = 0;
+  while (pow10_table[d] < id)
+    d++;
+  return d;
+}
+
+/** Returns the "distance" between two IDs with the given number of digits. */
+static inline unsigned
+id_distance(quint64 a, int ad, quint64 b, int bd) {
+  // Fix number of digits
+  if (ad > bd)
+    b *= pow10_table[ad-bd];
+  else if (bd > ad)
+    a *= pow10_table[bd-ad];
+  // Distance is just the difference between these two numbers
+  // this ensures a small distance between two numbers with the same
+  // prefix.
+  return std::min<quint64>((a > b) ? (a-b) : (b-a), std::numeric_limits<unsigned>::max());
+}
+
+/** Returns the "distance" between two IDs. */
+static inline unsigned
+id_distance(unsigned a, unsigned b) {
+  return id_distance(a, id_digits(a), b, id_digits(b));
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserDatabase::Reader
+ * ********************************************************************************************* */
+UserDatabase::Reader::Reader()
+  : _state(State::Start), _buffer(), _pos(0), _start(0), _depth(0), _inString(false),
+    _escape(false), _expectKey(false), _captureKey(false), _key(), _errorMessage()
+{
+  // pass...
+}
+
+bool
+UserDatabase::Reader::isComplete() const {
+  return State::Complete == _state;
+}
+
+bool
+UserDatabase::Reader::hasError() const {
+  return State::Error == _state;
+}
+
+const QString &
+UserDatabase::Reader::errorMessage() const {
+  return _errorMessage;
+}
+
+bool
+UserDatabase::Reader::fail(const QString &msg) {
+  _state = State::Error;
+  _errorMessage = msg;
+  _buffer.clear();
+  return false;
+}
+
+bool
+UserDatabase::Reader::read(const QByteArray &data, Store &users) {
+  if (State::Error == _state)
+    return false;
+  if (State::Complete == _state)
+    return true;
+
+  _buffer.append(data);
+  for (; (_pos<_buffer.size()) && (State::Complete != _state); _pos++) {
+    char c = _buffer.at(_pos);
+
+    // Skip content of strings
+    if (_inString) {
+      if (_escape) {
+        _escape = false;
+      } else if ('\\' == c) {
+        _escape = true;
+      } else if ('"' == c) {
+        _inString = false;
+        if (_captureKey)
+          _expectKey = _captureKey = false;
+        continue;
+      }
+      if (_captureKey)
+        _key.append(c);
+      continue;
+    }
+
+    switch (_state) {
+    case State::Start:
+      if ('{' == c) {
+        _state = State::Members; _depth = 1; _expectKey = true;
+      } else if (! std::isspace((unsigned char)c)) {
+        return fail("JSON document is not an object!");
+      }
+      break;
+
+    case State::Members:
+      if ('"' == c) {
+        _inString = true;
+        _captureKey = ((1 == _depth) && _expectKey);
+        if (_captureKey)
+          _key.clear();
+      } else if ((':' == c) && (1 == _depth) && ("users" == _key)) {
+        _state = State::UsersValue;
+      } else if ((',' == c) && (1 == _depth)) {
+        _expectKey = true;
+      } else if (('{' == c) || ('[' == c)) {
+        _depth++;
+      } else if (('}' == c) || (']' == c)) {
+        if (0 == (--_depth))
+          return fail("JSON object does not contain 'users' item.");
+      }
+      break;
+
+    case State::UsersValue:
+      if ('[' == c)
+        _state = State::Users;
+      else if (! std::isspace((unsigned char)c))
+        return fail("'users' item is not an array.");
+      break;
+
+    case State::Users:
+      if ('{' == c) {
+        _state = State::User; _start = _pos; _depth = 1;
+      } else if (']' == c) {
+        _state = State::Complete;
+      } else if ((',' != c) && (! std::isspace((unsigned char)c))) {
+        return fail("'users' item contains a non-object element.");
+      }
+      break;
+
+    case State::User:
+      if ('"' == c) {
+        _inString = true;
+      } else if (('{' == c) || ('[' == c)) {
+        _depth++;
+      } else if ((('}' == c) || (']' == c)) && (0 == (--_depth))) {
+        QJsonParseError err;
+        QJsonDocument doc = QJsonDocument::fromJson(
+              QByteArray::fromRawData(_buffer.constData()+_start, _pos-_start+1), &err);
+        if (! doc.isObject())
+          return fail(QString("Malformed user entry: %1").arg(err.errorString()));
+        User user(doc.object());
+        if (user.isValid())
+          users.append(user);
+        _state = State::Users;
+      }
+      break;
+
+    case State::Complete:
+    case State::Error:
+      break;
+    }
+  }
+
+  // Drop processed bytes, keep the current user entry
+  int keep = (State::User == _state) ? _start : _pos;
+  _buffer.remove(0, keep);
+  _pos -= keep;
+  _start = (State::User == _state) ? 0 : _start;
+  return true;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserDatabase::Download
+ * ********************************************************************************************* */
+/** Holds the state of a running download. The downloaded document gets written to the file and
+ * parsed while being received. */
+class UserDatabase::Download
+{
+public:
+  /** Constructs a download into the given file. */
+  explicit Download(const QString &filename)
+    : file(filename), reader(), users()
+  {
+    // pass...
+  }
+
+  /** The file, the user database gets written to. Only replaces the previous one on success. */
+  QSaveFile file;
+  /** Parses the downloaded document. */
+  Reader reader;
+  /** The users read so far. */
+  Store users;
+};
 
 
 /* ********************************************************************************************* *
@@ -30,18 +290,148 @@ UserDatabase::User::User(const QJsonObject &obj)
 
 unsigned
 UserDatabase::User::distance(unsigned id) const {
-  // Fix number of digits
-  int a = this->id, b = id;
-  int ad = std::ceil(std::log10(a));
-  int bd = std::ceil(std::log10(b));
-  if (ad > bd)
-    b *= std::pow(10u, (ad-bd));
-  else if (bd > ad)
-    a *= std::pow(10u, (bd-ad));
-  // Distance is just the difference between these two numbers
-  // this ensures a small distance between two numbers with the same
-  // prefix.
-  return std::abs(a-b);
+  return id_distance(this->id, id);
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserDatabase::UserView
+ * ********************************************************************************************* */
+unsigned
+UserDatabase::UserView::id() const {
+  return _db->_users.id(_idx);
+}
+
+QByteArray
+UserDatabase::UserView::utf8(Field field) const {
+  return _db->_users.utf8(_idx, field);
+}
+
+QString
+UserDatabase::UserView::string(Field field) const {
+  return QString::fromUtf8(utf8(field));
+}
+
+int
+UserDatabase::UserView::length(Field field) const {
+  QByteArray str = utf8(field);
+  int len = 0;
+  for (int i=0; i<str.size(); i++) {
+    uchar c = uchar(str.at(i));
+    // Count all but continuation bytes, 4-byte sequences are encoded as surrogate pairs in UTF-16
+    if (0x80 != (c & 0xc0))
+      len++;
+    if (0xf0 <= c)
+      len++;
+  }
+  return len;
+}
+
+UserDatabase::User
+UserDatabase::UserView::user() const {
+  User user;
+  user.id = id();
+  user.call = string(Field::Call);
+  user.name = string(Field::Name);
+  user.surname = string(Field::Surname);
+  user.city = string(Field::City);
+  user.state = string(Field::State);
+  user.country = string(Field::Country);
+  user.comment = string(Field::Comment);
+  return user;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserDatabase::Column
+ * ********************************************************************************************* */
+UserDatabase::Column
+UserDatabase::Column::fromRawData(const quint32 *data, int n) {
+  Column column;
+  column._data = QByteArray::fromRawData(reinterpret_cast<const char *>(data),
+                                         n*int(sizeof(quint32)));
+  return column;
+}
+
+
+/* ********************************************************************************************* *
+ * Implementation of UserDatabase::Store
+ * ********************************************************************************************* */
+UserDatabase::Store::Store()
+  : ids(), fields(), offsets(), pool(), mapping(), _interned()
+{
+  clear();
+}
+
+void
+UserDatabase::Store::clear() {
+  ids.clear(); fields.clear(); pool.clear(); _interned.clear();
+  // String 0 is always the empty string
+  offsets.clear(); offsets.append(0); offsets.append(0);
+  _interned.insert(QByteArray(), 0);
+  mapping.reset();
+}
+
+quint32
+UserDatabase::Store::intern(const QString &str) {
+  if (str.isEmpty())
+    return 0;
+  QByteArray utf8 = str.toUtf8();
+  auto item = _interned.constFind(utf8);
+  if (_interned.constEnd() != item)
+    return item.value();
+  quint32 idx = offsets.size()-1;
+  pool.append(utf8);
+  offsets.append(pool.size());
+  _interned.insert(utf8, idx);
+  return idx;
+}
+
+void
+UserDatabase::Store::append(const User &user) {
+  ids.append(user.id);
+  fields.append(intern(user.call));
+  fields.append(intern(user.name));
+  fields.append(intern(user.surname));
+  fields.append(intern(user.city));
+  fields.append(intern(user.state));
+  fields.append(intern(user.country));
+  fields.append(intern(user.comment));
+}
+
+void
+UserDatabase::Store::squeeze() {
+  _interned.clear();
+  ids.squeeze(); fields.squeeze(); offsets.squeeze(); pool.squeeze();
+}
+
+QByteArray
+UserDatabase::Store::utf8(int idx, Field field) const {
+  quint32 str = fields.at(idx*FieldCount + int(field));
+  quint32 start = offsets.at(str), end = offsets.at(str+1);
+  return QByteArray::fromRawData(pool.constData()+start, end-start);
+}
+
+void
+UserDatabase::Store::reorder(const QVector<int> &order) {
+  Column newIDs, newFields;
+  newIDs.resize(order.size()); newFields.resize(order.size()*FieldCount);
+  quint32 *idData = newIDs.data(), *fieldData = newFields.data();
+  for (int i=0; i<order.size(); i++) {
+    idData[i] = ids.at(order.at(i));
+    std::copy_n(fields.constData() + order.at(i)*FieldCount, FieldCount,
+                fieldData + i*FieldCount);
+  }
+  ids.swap(newIDs);
+  fields.swap(newFields);
+}
+
+void
+UserDatabase::Store::sortByID() {
+  QVector<int> order(count());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return ids.at(a) < ids.at(b); });
+  reorder(order);
 }
 
 
@@ -49,7 +439,7 @@ UserDatabase::User::distance(unsigned id) const {
  * Implementation of UserDatabase
  * ********************************************************************************************* */
 UserDatabase::UserDatabase(unsigned updatePeriodDays, QObject *parent)
-  : QAbstractTableModel(parent), _user(), _network()
+  : QAbstractTableModel(parent), _users(), _network(), _download(nullptr)
 {
   connect(&_network, SIGNAL(finished(QNetworkReply*)),
           this, SLOT(downloadFinished(QNetworkReply*)));
@@ -58,9 +448,23 @@ UserDatabase::UserDatabase(unsigned updatePeriodDays, QObject *parent)
     download();
 }
 
+UserDatabase::UserDatabase(const QString &filename, QObject *parent)
+  : QAbstractTableModel(parent), _users(), _network(), _download(nullptr)
+{
+  connect(&_network, SIGNAL(finished(QNetworkReply*)),
+          this, SLOT(downloadFinished(QNetworkReply*)));
+
+  load(filename);
+}
+
+UserDatabase::~UserDatabase() {
+  if (nullptr != _download)
+    delete _download;
+}
+
 qint64
 UserDatabase::count() const {
-  return _user.size();
+  return _users.count();
 }
 
 bool
@@ -69,13 +473,23 @@ UserDatabase::load() {
   return load(path+"/user.json");
 }
 
-const UserDatabase::User &
+UserDatabase::User
 UserDatabase::user(int idx) const {
-  return _user[idx];
+  return view(idx).user();
+}
+
+UserDatabase::UserView
+UserDatabase::view(int idx) const {
+  return UserView(this, idx);
 }
 
 bool
 UserDatabase::load(const QString &filename) {
+  if (loadCache(filename)) {
+    emit loaded();
+    return true;
+  }
+
   QFile file(filename);
   if (! file.open(QIODevice::ReadOnly)) {
     QString msg = QString("Cannot open user list '%1': %2").arg(filename).arg(file.errorString());
@@ -83,102 +497,194 @@ UserDatabase::load(const QString &filename) {
     emit error(msg);
     return false;
   }
-  QByteArray data = file.readAll();
+
+  // Read the document in chunks
+  Reader reader;
+  Store users;
+  while ((! file.atEnd()) && (! reader.isComplete())) {
+    if (! reader.read(file.read(1<<20), users))
+      break;
+  }
   file.close();
 
-  QJsonParseError err;
-  QJsonDocument doc = QJsonDocument::fromJson(data, &err);
-  if (doc.isEmpty()) {
-    QString msg = "Failed to load user DB: " + err.errorString();
+  if (! reader.isComplete()) {
+    QString msg = "Failed to load user DB: " +
+        (reader.hasError() ? reader.errorMessage() : QString("Unexpected end of document."));
     logError() << msg;
     emit error(msg);
     return false;
   }
 
-  if (! doc.isObject()) {
-    QString msg = "Failed to load user DB: JSON document is not an object!";
-    logError() << msg;
-    emit error(msg);
+  resetUsers(users);
+
+  logDebug() << "Loaded user database with " << _users.count() << " entries from " << filename << ".";
+
+  if (! storeCache(filename))
+    logWarn() << "Cannot store user database cache for '" << filename << "'.";
+
+  emit loaded();
+  return true;
+}
+
+void
+UserDatabase::resetUsers(Store &users) {
+  users.sortByID();
+  users.squeeze();
+  beginResetModel();
+  _users = users;
+  endResetModel();
+  users.clear();
+}
+
+QString
+UserDatabase::cacheFilename(const QString &filename) {
+  QFileInfo info(filename);
+  return info.absolutePath() + "/" + info.completeBaseName() + ".cache";
+}
+
+bool
+UserDatabase::loadCache(const QString &filename) {
+  QFileInfo source(filename);
+  if (! source.exists())
     return false;
-  }
-  if (! doc.object().contains("users")) {
-    QString msg = "Failed to load user DB: JSON object does not contain 'users' item.";
-    logError() << msg;
-    emit error(msg);
+
+  // The file is kept open and mapped as long as the loaded users reference it
+  QSharedPointer<QFile> file(new QFile(cacheFilename(filename)));
+  if (! file->open(QIODevice::ReadOnly))
     return false;
-  }
-  if (! doc.object()["users"].isArray()) {
-    QString msg = "Failed to load user DB: 'users' item is not an array.";
-    logError() << msg;
-    emit error(msg);
+
+  qint64 size = file->size();
+  if (size < qint64(sizeof(userdb_cache_header_t)))
+    return false;
+  const uchar *data = file->map(0, size);
+  if (nullptr == data)
+    return false;
+
+  const userdb_cache_header_t *header = reinterpret_cast<const userdb_cache_header_t *>(data);
+  quint32 count = qFromLittleEndian(header->count), strings = qFromLittleEndian(header->strings),
+      poolSize = qFromLittleEndian(header->poolSize);
+  qint64 indices = qint64(count)*Store::FieldCount;
+  if ((0 != memcmp(header->magic, USERDB_CACHE_MAGIC, 8))
+      || (USERDB_CACHE_VERSION != qFromLittleEndian(header->version))
+      || (source.size() != qFromLittleEndian(header->sourceSize))
+      || (source.lastModified().toMSecsSinceEpoch() != qFromLittleEndian(header->sourceModified))
+      || (0 == strings)
+      || (size != qint64(sizeof(userdb_cache_header_t)) + 4*(count + indices + strings + 1) + poolSize)) {
+    logDebug() << "User database cache '" << file->fileName() << "' is outdated.";
     return false;
   }
 
-  beginResetModel();
-  _user.clear();
-
-  QJsonArray array = doc.object()["users"].toArray();
-  _user.reserve(array.size());
-  for (int i=0; i<array.size(); i++) {
-    User user(array.at(i).toObject());
-    if (user.isValid())
-      _user.append(user);
+  const uchar *ptr = data + sizeof(userdb_cache_header_t);
+  Store users;
+  users.ids = read_column(ptr, count); ptr += 4*count;
+  users.fields = read_column(ptr, indices); ptr += 4*indices;
+  users.offsets = read_column(ptr, strings+1); ptr += 4*(strings+1);
+  users.pool = QByteArray::fromRawData(reinterpret_cast<const char *>(ptr), poolSize);
+  users.mapping = file;
+
+  // Check consistency, to not read outside of the pool later on
+  for (int i=0; i<users.fields.size(); i++) {
+    if (users.fields.at(i) >= strings) {
+      logWarn() << "User database cache '" << file->fileName() << "' is corrupted.";
+      return false;
+    }
+  }
+  for (quint32 i=0; i<strings; i++) {
+    if ((users.offsets.at(i) > users.offsets.at(i+1)) || (users.offsets.at(i+1) > poolSize)) {
+      logWarn() << "User database cache '" << file->fileName() << "' is corrupted.";
+      return false;
+    }
   }
-  // Sort repeater w.r.t. their IDs
-  std::stable_sort(_user.begin(), _user.end(), [](const User &a, const User &b){ return a.id < b.id; });
-  // Done.
-  endResetModel();
 
-  logDebug() << "Loaded user database with " << _user.size() << " entries from " << filename << ".";
+  beginResetModel();
+  _users = users;
+  endResetModel();
 
-  emit loaded();
+  logDebug() << "Loaded user database with " << _users.count() << " entries from cache '"
+             << file->fileName() << "'.";
   return true;
 }
 
+bool
+UserDatabase::storeCache(const QString &filename) const {
+  QFileInfo source(filename);
+  if (! source.exists())
+    return false;
+
+  userdb_cache_header_t header;
+  memcpy(header.magic, USERDB_CACHE_MAGIC, 8);
+  header.version = qToLittleEndian<quint32>(USERDB_CACHE_VERSION);
+  header.count = qToLittleEndian<quint32>(_users.count());
+  header.sourceSize = qToLittleEndian<qint64>(source.size());
+  header.sourceModified = qToLittleEndian<qint64>(source.lastModified().toMSecsSinceEpoch());
+  header.strings = qToLittleEndian<quint32>(_users.offsets.size()-1);
+  header.poolSize = qToLittleEndian<quint32>(_users.pool.size());
+
+  QSaveFile file(cacheFilename(filename));
+  if (! file.open(QIODevice::WriteOnly))
+    return false;
+  file.write(reinterpret_cast<const char *>(&header), sizeof(userdb_cache_header_t));
+  write_column(file, _users.ids);
+  write_column(file, _users.fields);
+  write_column(file, _users.offsets);
+  file.write(_users.pool);
+  return file.commit();
+}
+
 void
-UserDatabase::sortUsers(unsigned id) {
-  // Sort repeater w.r.t. distance to ID
-  std::stable_sort(_user.begin(), _user.end(), [id](const User &a, const User &b){
-    return a.distance(id) < b.distance(id);
-  });
+UserDatabase::sortUsers(unsigned id, int limit) {
+  sortUsers(QSet<unsigned>{id}, limit);
 }
 
 void
-UserDatabase::sortUsers(const QSet<unsigned> &ids) {
+UserDatabase::sortUsers(const QSet<unsigned> &ids, int limit) {
   if (0 == ids.count())
     return;
 
-  // Sort repeater w.r.t. distance to each ID
-  std::stable_sort(_user.begin(), _user.end(), [ids](const User &a, const User &b){
-    QSet<unsigned>::const_iterator id=ids.begin();
-    unsigned min_a = a.distance(*id), min_b = b.distance(*id);
-    id++;
-    for (; id!=ids.end(); id++) {
-      min_a = std::min(min_a, a.distance(*id));
-      min_b = std::min(min_b, b.distance(*id));
-    }
-    return min_a < min_b;
-  });
-}
+  // Normalize IDs once
+  QVector<QPair<quint64, int>> prefixes;
+  prefixes.reserve(ids.count());
+  foreach (unsigned id, ids)
+    prefixes.append(QPair<quint64, int>(id, id_digits(id)));
+
+  // Compute the minimum distance of each user to any of the IDs. The key holds the distance in
+  // the upper and the index of the user in the lower 32 bits. Hence the keys are unique and
+  // sorting them is stable w.r.t. the current order of users.
+  int n = _users.count();
+  std::vector<quint64> keys(n);
+  for (int i=0; i<n; i++) {
+    quint64 id = _users.id(i); int digits = id_digits(id);
+    unsigned dist = std::numeric_limits<unsigned>::max();
+    for (int j=0; j<prefixes.size(); j++)
+      dist = std::min(dist, id_distance(id, digits, prefixes.at(j).first, prefixes.at(j).second));
+    keys[i] = (quint64(dist) << 32) | quint64(i);
+  }
 
-void
-UserDatabase::download() {
-  QUrl url("https://database.radioid.net/static/users.json");
-  QNetworkRequest request(url);
-  _network.get(request);
+  // Select and sort only the closest users if limited, the remaining ones keep their order
+  if ((0 <= limit) && (limit < n)) {
+    std::nth_element(keys.begin(), keys.begin()+limit, keys.end());
+    std::sort(keys.begin(), keys.begin()+limit);
+    std::sort(keys.begin()+limit, keys.end(), [](quint64 a, quint64 b) {
+      return (a & 0xffffffff) < (b & 0xffffffff);
+    });
+  } else {
+    std::sort(keys.begin(), keys.end());
+  }
+
+  QVector<int> order(n);
+  for (int i=0; i<n; i++)
+    order[i] = int(keys[i] & 0xffffffff);
+  _users.reorder(order);
 }
 
 void
-UserDatabase::downloadFinished(QNetworkReply *reply) {
-  if (reply->error()) {
-    QString msg = QString("Cannot download user database: %1").arg(reply->errorString());
-    logError() << msg;
-    emit error(msg);
+UserDatabase::download() {
+  if (nullptr != _download) {
+    logDebug() << "User database download is already running.";
     return;
   }
 
   QString path = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-  QFile file(path+"/user.json");
   QDir directory;
   if ((! directory.exists(path)) && (!directory.mkpath(path))) {
     QString msg = QString("Cannot create path '%1'.").arg(path);
@@ -186,19 +692,78 @@ UserDatabase::downloadFinished(QNetworkReply *reply) {
     emit error(msg);
     return;
   }
-  if (! file.open(QIODevice::WriteOnly)) {
+
+  _download = new Download(path+"/user.json");
+  if (! _download->file.open(QIODevice::WriteOnly)) {
     QString msg = QString("Cannot save user database at '%1'.").arg(path+"/user.json");
     logError() << msg;
+    delete _download;
+    _download = nullptr;
     emit error(msg);
     return;
   }
 
-  file.write(reply->readAll());
-  file.flush();
-  file.close();
+  QUrl url("https://database.radioid.net/static/users.json");
+  QNetworkRequest request(url);
+  QNetworkReply *reply = _network.get(request);
+  connect(reply, SIGNAL(readyRead()), this, SLOT(downloadReadyRead()));
+}
+
+void
+UserDatabase::downloadReadyRead() {
+  if (QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender()))
+    readDownload(reply);
+}
+
+void
+UserDatabase::readDownload(QNetworkReply *reply) {
+  if ((nullptr == _download) || _download->reader.hasError())
+    return;
+
+  QByteArray data = reply->readAll();
+  _download->file.write(data);
+  if (! _download->reader.read(data, _download->users)) {
+    logWarn() << "Cannot parse downloaded user database: " << _download->reader.errorMessage();
+    reply->abort();
+  }
+}
 
-  load();
+void
+UserDatabase::downloadFinished(QNetworkReply *reply) {
   reply->deleteLater();
+  if (nullptr == _download)
+    return;
+
+  readDownload(reply);
+  Download *download = _download;
+  _download = nullptr;
+
+  QString msg;
+  if (download->reader.hasError())
+    msg = "Failed to load user DB: " + download->reader.errorMessage();
+  else if (reply->error())
+    msg = QString("Cannot download user database: %1").arg(reply->errorString());
+  else if (! download->reader.isComplete())
+    msg = "Failed to load user DB: Unexpected end of document.";
+  else if (! download->file.commit())
+    msg = QString("Cannot save user database at '%1'.").arg(download->file.fileName());
+  if (! msg.isEmpty()) {
+    logError() << msg;
+    delete download;
+    emit error(msg);
+    return;
+  }
+
+  QString filename = download->file.fileName();
+  resetUsers(download->users);
+  delete download;
+
+  logDebug() << "Downloaded user database with " << _users.count() << " entries.";
+
+  if (! storeCache(filename))
+    logWarn() << "Cannot store user database cache for '" << filename << "'.";
+
+  emit loaded();
 }
 
 unsigned
@@ -213,7 +778,7 @@ UserDatabase::dbAge() const {
 int
 UserDatabase::rowCount(const QModelIndex &parent) const {
   Q_UNUSED(parent);
-  return _user.size();
+  return _users.count();
 }
 
 int
@@ -227,35 +792,36 @@ UserDatabase::data(const QModelIndex &index, int role) const {
   if ((Qt::EditRole != role) && ((Qt::DisplayRole != role)))
     return QVariant();
 
-  if (index.row() >= _user.size())
+  if (index.row() >= _users.count())
     return QVariant();
 
+  UserView user = view(index.row());
   if (0 == index.column()) {
     // Call
     if (Qt::DisplayRole == role) {
-      if (_user[index.row()].surname.isEmpty()) {
-        if (_user[index.row()].name.isEmpty()) {
-          return _user[index.row()].call;
+      if (user.utf8(Field::Surname).isEmpty()) {
+        if (user.utf8(Field::Name).isEmpty()) {
+          return user.string(Field::Call);
         } else {
           return tr("%1 (%2)")
-              .arg(_user[index.row()].call)
-              .arg(_user[index.row()].name);
+              .arg(user.string(Field::Call))
+              .arg(user.string(Field::Name));
         }
       } else {
         return tr("%1 (%2, %3)")
-            .arg(_user[index.row()].call)
-            .arg(_user[index.row()].name)
-            .arg(_user[index.row()].surname);
+            .arg(user.string(Field::Call))
+            .arg(user.string(Field::Name))
+            .arg(user.string(Field::Surname));
       }
     } else {
-      return _user[index.row()].call;
+      return user.string(Field::Call);
     }
   } else if (1 == index.column()) {
     // ID
-    return _user[index.row()].id;
+    return user.id();
   } else if (2 == index.column()) {
     // Country
-    return _user[index.column()].country;
+    return user.string(Field::Country);
   }
 
   return QVariant();
@@ -4,6 +4,9 @@
 #include <QObject>
 #include <QVector>
 #include <QHash>
+#include <QSet>
+#include <QFile>
+#include <QSharedPointer>
 #include <QJsonObject>
 #include <QNetworkAccessManager>
 #include <QAbstractTableModel>
@@ -18,6 +21,9 @@
  * to help assemble private call contacts and to assemble so-called CSV callsign databases, that
  * are programmable to some DMR radios to resolve the DMR ID to callsigns and names.
  *
+ * Once parsed, the database is kept in a compact binary cache next to the JSON file. The cache
+ * holds the users sorted by their ID and gets regenerated whenever the JSON file changes.
+ *
  * @ingroup util */
 class UserDatabase : public QAbstractTableModel
 {
@@ -56,11 +62,211 @@ public:
     QString comment;
   };
 
+  /** The string fields of a user entry. */
+  enum class Field {
+    Call = 0, Name, Surname, City, State, Country, Comment
+  };
+
+  /** Lightweight view of a user entry within the @c UserDatabase.
+   * The fields get decoded on demand. A view is only valid as long as the database is not
+   * modified (e.g., re-loaded or sorted). */
+  class UserView {
+  public:
+    /** Constructs a view of the entry @c idx of the given database. */
+    inline UserView(const UserDatabase *db, int idx) : _db(db), _idx(idx) { }
+
+    /** Returns the DMR ID of the user. */
+    unsigned id() const;
+    /** Returns the given field UTF-8 encoded. The returned array references the storage of the
+     * database and is not copied. */
+    QByteArray utf8(Field field) const;
+    /** Returns the given field. */
+    QString string(Field field) const;
+    /** Returns the length of the given field in UTF-16 code units, that is, the size of the
+     * @c QString returned by @c string, without decoding it. */
+    int length(Field field) const;
+    /** Returns a copy of the entry. */
+    User user() const;
+
+  protected:
+    /** The database. */
+    const UserDatabase *_db;
+    /** The index of the entry. */
+    int _idx;
+  };
+
+public:
+  /** A column of 32-bit integers in host byte order.
+   * The integers are held in a byte array. Hence, a column either owns its data or references
+   * memory it does not own (e.g., a mapped cache file) without copying it. Modifying a column
+   * referencing foreign memory copies it first. */
+  class Column
+  {
+  public:
+    /** Empty constructor. */
+    inline Column() : _data() { }
+
+    /** Constructs a column of @c n integers, referencing the given memory without copying it.
+     * The memory must remain valid as long as the column or a copy of it exists. */
+    static Column fromRawData(const quint32 *data, int n);
+
+    /** Returns the number of integers. */
+    inline int size() const { return _data.size()/int(sizeof(quint32)); }
+    /** Returns the integer at the given index. */
+    inline quint32 at(int i) const { return constData()[i]; }
+    /** Returns a pointer to the integers. */
+    inline const quint32 *constData() const {
+      return reinterpret_cast<const quint32 *>(_data.constData());
+    }
+    /** Returns a pointer to the integers, copies referenced memory first. */
+    inline quint32 *data() { return reinterpret_cast<quint32 *>(_data.data()); }
+
+    /** Resizes the column. */
+    inline void resize(int n) { _data.resize(n*int(sizeof(quint32))); }
+    /** Appends an integer. */
+    inline void append(quint32 value) {
+      _data.append(reinterpret_cast<const char *>(&value), sizeof(quint32));
+    }
+    /** Deletes all integers. */
+    inline void clear() { _data.clear(); }
+    /** Releases unused memory. */
+    inline void squeeze() { _data.squeeze(); }
+    /** Swaps the content with the given column. */
+    inline void swap(Column &other) { _data.swap(other._data); }
+
+  protected:
+    /** The integers. */
+    QByteArray _data;
+  };
+
+  /** Column-wise storage of the users.
+   * The IDs are held in a dense column. All strings are UTF-8 encoded and interned, that is,
+   * each distinct string is stored once within the string pool. Each user refers to its fields
+   * by the index of the interned string.
+   *
+   * A store loaded from the binary cache references the mapped cache file instead of copying
+   * the columns. */
+  class Store
+  {
+  public:
+    /** Number of string fields per user. */
+    static const int FieldCount = 7;
+
+  public:
+    /** Empty constructor. */
+    Store();
+
+    /** Returns the number of users. */
+    inline int count() const { return ids.size(); }
+    /** Deletes all users. */
+    void clear();
+    /** Appends the given user. */
+    void append(const User &user);
+    /** Drops the intern table and releases unused memory once all users have been appended. */
+    void squeeze();
+
+    /** Returns the ID of the given user. */
+    inline unsigned id(int idx) const { return ids.at(idx); }
+    /** Returns the given field of a user, the returned array is not copied. */
+    QByteArray utf8(int idx, Field field) const;
+
+    /** Reorders the users, the user at index @c order[i] becomes the i-th user. */
+    void reorder(const QVector<int> &order);
+    /** Sorts the users by their ID. */
+    void sortByID();
+
+  protected:
+    /** Returns the index of the interned string. */
+    quint32 intern(const QString &str);
+
+  public:
+    /** The IDs of the users. */
+    Column ids;
+    /** For each user, the indices of the interned strings of all fields. */
+    Column fields;
+    /** The offsets of the interned strings within the pool. Holds one more element than strings. */
+    Column offsets;
+    /** The string pool. */
+    QByteArray pool;
+    /** The mapped cache file, the columns and the pool may reference. Shared between all copies
+     * of the store, unmapped once the last one is gone. */
+    QSharedPointer<QFile> mapping;
+
+  protected:
+    /** Maps strings to their index while appending users. */
+    QHash<QByteArray, quint32> _interned;
+  };
+
+  /** Incremental reader of the JSON user database.
+   *
+   * The reader gets fed with chunks of the JSON document and only keeps the bytes of the current
+   * user entry. Each complete entry gets parsed on its own and is appended to the given list of
+   * users. Hence, the complete document is never held in memory. */
+  class Reader
+  {
+  public:
+    /** Constructs a new reader. */
+    Reader();
+
+    /** Reads the next chunk of the document. Returns @c false on error. */
+    bool read(const QByteArray &data, Store &users);
+    /** Returns @c true, if the complete list of users has been read. */
+    bool isComplete() const;
+    /** Returns @c true, if the document is malformed. */
+    bool hasError() const;
+    /** Returns the error message. */
+    const QString &errorMessage() const;
+
+  protected:
+    /** Sets the error message and returns @c false. */
+    bool fail(const QString &msg);
+
+  protected:
+    /** Possible states of the reader. */
+    enum class State {
+      Start,      ///< Before the document object.
+      Members,    ///< Within the document object.
+      UsersValue, ///< Expecting the value of the "users" member.
+      Users,      ///< Within the users array.
+      User,       ///< Within a user entry.
+      Complete,   ///< The users array has been read.
+      Error       ///< Malformed document.
+    };
+
+    /** The current state. */
+    State _state;
+    /** Unprocessed bytes and the bytes of the current user entry. */
+    QByteArray _buffer;
+    /** Current position within the buffer. */
+    int _pos;
+    /** Start of the current user entry within the buffer. */
+    int _start;
+    /** Nesting depth within the document object or user entry. */
+    int _depth;
+    /** If @c true, the reader is within a string. */
+    bool _inString;
+    /** If @c true, the previous char within a string was an escape char. */
+    bool _escape;
+    /** If @c true, a member name is expected within the document object. */
+    bool _expectKey;
+    /** If @c true, the current string is a member name of the document object. */
+    bool _captureKey;
+    /** The last member name of the document object. */
+    QByteArray _key;
+    /** The error message. */
+    QString _errorMessage;
+  };
+
 public:
   /** Constructs the user-database.
    * The constructor will download the current user database if it was not downloaded yet or
    * if the downloaded version is older than @c updatePeriodDays days. */
   explicit UserDatabase(unsigned updatePeriodDays=30, QObject *parent=nullptr);
+  /** Constructs the user-database from the given file. The database is neither downloaded nor
+   * updated automatically. */
+  explicit UserDatabase(const QString &filename, QObject *parent=nullptr);
+  /** Destructor. */
+  virtual ~UserDatabase();
 
   /** Returns the number of users. */
   qint64 count() const;
@@ -70,13 +276,19 @@ public:
   /** Loads all entries from the downloaded user database at the specified location. */
   bool load(const QString &filename);
 
-  /** Sorts users with respect to the distance to the given ID. */
-  void sortUsers(unsigned id);
-  /** Sorts users with respect to the minimum distance to the given IDs. */
-  void sortUsers(const QSet<unsigned> &ids);
+  /** Sorts users with respect to the distance to the given ID.
+   * If @c limit is non-negative, only the @c limit closest users are sorted. These are followed
+   * by the remaining users in their previous order. */
+  void sortUsers(unsigned id, int limit=-1);
+  /** Sorts users with respect to the minimum distance to the given IDs.
+   * If @c limit is non-negative, only the @c limit closest users are sorted. These are followed
+   * by the remaining users in their previous order. */
+  void sortUsers(const QSet<unsigned> &ids, int limit=-1);
 
-  /** Returns the user with index @c idx. */
-  const User &user(int idx) const;
+  /** Returns a copy of the user with index @c idx. */
+  User user(int idx) const;
+  /** Returns a view of the user with index @c idx. */
+  UserView view(int idx) const;
 
   /** Returns the age of the database in days. */
   unsigned dbAge() const;
@@ -99,14 +311,33 @@ public slots:
   void download();
 
 private slots:
+  /** Gets called whenever a part of the download has been received. */
+  void downloadReadyRead();
   /** Gets called whenever the download is complete. */
   void downloadFinished(QNetworkReply *reply);
 
 private:
-  /** Holds all users sorted by their ID. */
-  QVector<User>         _user;
+  class Download;
+
+  /** Sorts the given users by their ID and replaces all entries with them. */
+  void resetUsers(Store &users);
+  /** Writes and parses the received part of the download. */
+  void readDownload(QNetworkReply *reply);
+  /** Returns the path of the binary cache for the given JSON user database. */
+  static QString cacheFilename(const QString &filename);
+  /** Loads all entries from the binary cache of the given JSON user database. Fails if there is
+   * no cache or if the cache is outdated. */
+  bool loadCache(const QString &filename);
+  /** Stores all entries in the binary cache of the given JSON user database. */
+  bool storeCache(const QString &filename) const;
+
+private:
+  /** Holds all users, sorted by their ID unless sorted explicitly. */
+  Store                 _users;
   /** The network access used for downloading. */
   QNetworkAccessManager _network;
+  /** The running download or @c nullptr. */
+  Download             *_download;
 };
 
 
@@ -0,0 +1,333 @@
+#include "yamlconfigreader.hh"
+#include "config.h"
+#include "config.hh"
+#include "logger.hh"
+
+
+/* ********************************************************************************************* *
+ * Implementation of YAMLConfigReader
+ * ********************************************************************************************* */
+YAMLConfigReader::YAMLConfigReader(Config *config, ConfigItem::Context &ctx, const ErrorStack &err)
+  : YAML::EventHandler(), _config(config), _context(ctx), _err(err), _state(State::Document),
+    _key(), _hasKey(false), _list(nullptr), _stack(), _anchors(), _defaultId(), _defaultIdMark()
+{
+  // pass...
+}
+
+bool
+YAMLConfigReader::read(std::istream &stream) {
+  YAML::Parser parser(stream);
+
+  // Allow for references to elements defined later in the document
+  _context.deferReferences(true);
+  bool found = false;
+  try {
+    found = parser.HandleNextDocument(*this);
+  } catch (...) {
+    _context.deferReferences(false);
+    throw;
+  }
+  _context.deferReferences(false);
+
+  if (State::Error == _state)
+    return false;
+  if ((! found) || (State::Complete != _state)) {
+    errMsg(_err) << "Cannot read configuration: Empty document.";
+    return false;
+  }
+
+  return finish();
+}
+
+void
+YAMLConfigReader::OnDocumentStart(const YAML::Mark &mark) {
+  Q_UNUSED(mark);
+  // pass...
+}
+
+void
+YAMLConfigReader::OnDocumentEnd() {
+  // pass...
+}
+
+void
+YAMLConfigReader::OnNull(const YAML::Mark &mark, YAML::anchor_t anchor) {
+  if (State::Error == _state)
+    return;
+  YAML::Node node = newNode(YAML::NodeType::Null, "");
+  setAnchor(anchor, node);
+  complete(node, mark);
+}
+
+void
+YAMLConfigReader::OnAlias(const YAML::Mark &mark, YAML::anchor_t anchor) {
+  if (State::Error == _state)
+    return;
+  if ((anchor >= _anchors.size()) || (! _anchors[anchor].IsDefined())) {
+    errMsg(_err) << mark.line << ":" << mark.column << ": Unknown anchor.";
+    _state = State::Error;
+    return;
+  }
+  complete(_anchors[anchor], mark);
+}
+
+void
+YAMLConfigReader::OnScalar(const YAML::Mark &mark, const std::string &tag, YAML::anchor_t anchor,
+                           const std::string &value)
+{
+  if (State::Error == _state)
+    return;
+  YAML::Node node(value);
+  node.SetTag(tag);
+  setAnchor(anchor, node);
+  complete(node, mark);
+}
+
+void
+YAMLConfigReader::OnSequenceStart(const YAML::Mark &mark, const std::string &tag,
+                                  YAML::anchor_t anchor, YAML::EmitterStyle::value style)
+{
+  if (State::Error == _state)
+    return;
+  YAML::Node node = newNode(YAML::NodeType::Sequence, tag);
+  node.SetStyle(style);
+  setAnchor(anchor, node);
+  beginCollection(node, mark, false);
+}
+
+void
+YAMLConfigReader::OnSequenceEnd() {
+  if (State::Error == _state)
+    return;
+  endCollection();
+}
+
+void
+YAMLConfigReader::OnMapStart(const YAML::Mark &mark, const std::string &tag,
+                             YAML::anchor_t anchor, YAML::EmitterStyle::value style)
+{
+  if (State::Error == _state)
+    return;
+  YAML::Node node = newNode(YAML::NodeType::Map, tag);
+  node.SetStyle(style);
+  setAnchor(anchor, node);
+  beginCollection(node, mark, true);
+}
+
+void
+YAMLConfigReader::OnMapEnd() {
+  if (State::Error == _state)
+    return;
+  endCollection();
+}
+
+YAML::Node
+YAMLConfigReader::newNode(YAML::NodeType::value type, const std::string &tag) {
+  YAML::Node node(type);
+  node.SetTag(tag);
+  return node;
+}
+
+void
+YAMLConfigReader::setAnchor(YAML::anchor_t anchor, const YAML::Node &node) {
+  if (0 == anchor)
+    return;
+  if (anchor >= _anchors.size())
+    _anchors.resize(anchor+1);
+  // Assigning to a node would assign its content, reset re-binds it.
+  _anchors[anchor].reset(node);
+}
+
+void
+YAMLConfigReader::beginCollection(const YAML::Node &node, const YAML::Mark &mark, bool map) {
+  if (_stack.empty()) {
+    if (State::Document == _state) {
+      if (! map) {
+        errMsg(_err) << mark.line << ":" << mark.column
+                     << ": Cannot read configuration: Element is not a map.";
+        _state = State::Error;
+        return;
+      }
+      _state = State::Root;
+      return;
+    }
+    if ((State::Root == _state) && _hasKey && _list && (! map)) {
+      // Elements of the list are read one-by-one
+      _state = State::List;
+      return;
+    }
+  }
+  _stack.push_back(Frame{node, mark, map, YAML::Node(), false});
+}
+
+void
+YAMLConfigReader::endCollection() {
+  if (! _stack.empty()) {
+    YAML::Node node = _stack.back().node;
+    YAML::Mark mark = _stack.back().mark;
+    _stack.pop_back();
+    complete(node, mark);
+  } else if (State::List == _state) {
+    _state = State::Root;
+    _hasKey = false;
+    _list = nullptr;
+  } else if (State::Root == _state) {
+    _state = State::Complete;
+  }
+}
+
+void
+YAMLConfigReader::complete(const YAML::Node &node, const YAML::Mark &mark) {
+  if (! _stack.empty()) {
+    Frame &frame = _stack.back();
+    if (! frame.map) {
+      frame.node.push_back(node);
+    } else if (! frame.hasKey) {
+      frame.key.reset(node);
+      frame.hasKey = true;
+    } else {
+      frame.node.force_insert(frame.key, node);
+      frame.hasKey = false;
+    }
+    return;
+  }
+
+  bool ok = true;
+  if (State::Document == _state) {
+    errMsg(_err) << mark.line << ":" << mark.column
+                 << ": Cannot read configuration: Element is not a map.";
+    ok = false;
+  } else if ((State::Root == _state) && (! _hasKey)) {
+    ok = readKey(node, mark);
+  } else if (State::Root == _state) {
+    ok = readValue(node, mark);
+    _hasKey = false;
+    _list = nullptr;
+  } else if (State::List == _state) {
+    ok = readElement(node, mark);
+  }
+
+  if (! ok)
+    _state = State::Error;
+}
+
+bool
+YAMLConfigReader::readKey(const YAML::Node &key, const YAML::Mark &mark) {
+  if (! key.IsScalar()) {
+    errMsg(_err) << mark.line << ":" << mark.column
+                 << ": Cannot read configuration: Expected key.";
+    return false;
+  }
+
+  _key = QString::fromStdString(key.Scalar());
+  _hasKey = true;
+  _list = nullptr;
+
+  if ("version" != _key && _context.version().isEmpty()) {
+    logWarn() << "No version string set, assuming " << VERSION_STRING << ".";
+    _context.setVersion(VERSION_STRING);
+  }
+
+  foreach (const Config::ListKey &entry, _config->listKeys()) {
+    if (_key == entry.key)
+      _list = entry.list;
+  }
+  /** @todo Implemented for backward compatibility with version 0.10.0, remove for 1.0.0.*/
+  if ("roaming" == _key)
+    _list = _config->roamingZones();
+
+  return true;
+}
+
+bool
+YAMLConfigReader::readValue(const YAML::Node &node, const YAML::Mark &mark) {
+  if ("version" == _key) {
+    if (node.IsScalar()) {
+      _context.setVersion(QString::fromStdString(node.as<std::string>()));
+      logDebug() << "Using format version " << _context.version() << ".";
+    }
+    return true;
+  }
+
+  if ("settings" == _key) {
+    if ((! _config->settings()->parse(node, _context, _err)) ||
+        (! _config->settings()->link(node, _context, _err)))
+      return false;
+    // The default radio ID is not a property of the settings but defined there. It is linked
+    // at the end, as radio IDs are defined after the settings.
+    if (node["defaultID"] && node["defaultID"].IsScalar()) {
+      _defaultId = QString::fromStdString(node["defaultID"].as<std::string>());
+      _defaultIdMark = mark;
+    }
+    return true;
+  }
+
+  if (_list) {
+    // Not a plain sequence (e.g., an alias), read it at once
+    return _list->parse(node, _context, _err) && _list->link(node, _context, _err);
+  }
+
+  // Remaining properties, like extensions
+  YAML::Node item(YAML::NodeType::Map);
+  item[_key.toStdString()] = node;
+  return _config->ConfigItem::parse(item, _context, _err)
+      && _config->ConfigItem::link(item, _context, _err);
+}
+
+bool
+YAMLConfigReader::readElement(const YAML::Node &node, const YAML::Mark &mark) {
+  ConfigItem *element = _list->allocateChild(node, _context, _err);
+  if ((nullptr == element) || (! element->is<ConfigObject>())) {
+    errMsg(_err) << mark.line << ":" << mark.column
+                 << ": Cannot parse element of " << _key << ".";
+    if (element)
+      element->deleteLater();
+    return false;
+  }
+
+  if (! element->parse(node, _context, _err)) {
+    errMsg(_err) << mark.line << ":" << mark.column
+                 << ": Cannot parse element of " << _key << ".";
+    element->deleteLater();
+    return false;
+  }
+
+  if (0 > _list->add(element->as<ConfigObject>())) {
+    errMsg(_err) << mark.line << ":" << mark.column
+                 << ": Cannot add element to " << _key << ".";
+    element->deleteLater();
+    return false;
+  }
+
+  // Link at once, references to elements defined later are resolved at the end
+  if (! element->link(node, _context, _err)) {
+    errMsg(_err) << mark.line << ":" << mark.column
+                 << ": Cannot link element of " << _key << ".";
+    return false;
+  }
+
+  return true;
+}
+
+bool
+YAMLConfigReader::finish() {
+  if (! _context.resolveReferences(_err))
+    return false;
+
+  if (! _defaultId.isEmpty()) {
+    if (_context.contains(_defaultId) && _context.getObj(_defaultId)->is<DMRRadioID>()) {
+      DMRRadioID *def = _context.getObj(_defaultId)->as<DMRRadioID>();
+      _config->radioIDs()->setDefaultId(_config->radioIDs()->indexOf(def));
+      logDebug() << "Set default radio ID to '" << def->name() << "'.";
+    } else {
+      errMsg(_err) << _defaultIdMark.line << ":" << _defaultIdMark.column
+                   << ": Default radio ID '" << _defaultId << "' does not refer to a radio ID.";
+      return false;
+    }
+  } else if (_config->radioIDs()->count()) {
+    // If no default is set, use first one.
+    _config->radioIDs()->setDefaultId(0);
+  }
+
+  return true;
+}
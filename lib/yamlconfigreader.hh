@@ -0,0 +1,124 @@
+#ifndef YAMLCONFIGREADER_HH
+#define YAMLCONFIGREADER_HH
+
+#include <yaml-cpp/yaml.h>
+#include <yaml-cpp/eventhandler.h>
+#include <istream>
+#include <vector>
+#include <QString>
+
+#include "configobject.hh"
+#include "errorstack.hh"
+
+class Config;
+
+/** Reads a YAML codeplug in a single, streaming pass.
+ *
+ * The reader receives the events of the YAML parser and only builds the node tree of a single
+ * element (e.g., channel, contact, zone) at a time. As soon as an element is complete, it gets
+ * allocated, parsed, added to its list and linked. References to elements defined later in the
+ * document are recorded by the context (see @c ConfigItem::Context::deferReferences) and resolved
+ * at the end of the document. Hence, the document is read once and never held in memory entirely.
+ *
+ * Elements are parsed and linked by their usual @c ConfigItem::parse and @c ConfigItem::link
+ * methods. The nodes built by the reader do not carry their location within the document, the
+ * reader only keeps the location of each element and key for its own messages. Hence, errors
+ * found by @c parse or @c link have no valid location. @c Config::readYAML therefore loads the
+ * document at once on failure, to report these errors with their location.
+ *
+ * @ingroup conf */
+class YAMLConfigReader: public YAML::EventHandler
+{
+public:
+  /** Constructs a reader filling the given (empty) configuration. */
+  YAMLConfigReader(Config *config, ConfigItem::Context &ctx, const ErrorStack &err=ErrorStack());
+
+  /** Reads the first document from the given stream. Returns @c false on error. On error, the
+   * configuration may be filled partially.
+   * @throws YAML::Exception on syntax errors. */
+  bool read(std::istream &stream);
+
+  void OnDocumentStart(const YAML::Mark &mark);
+  void OnDocumentEnd();
+  void OnNull(const YAML::Mark &mark, YAML::anchor_t anchor);
+  void OnAlias(const YAML::Mark &mark, YAML::anchor_t anchor);
+  void OnScalar(const YAML::Mark &mark, const std::string &tag, YAML::anchor_t anchor,
+                const std::string &value);
+  void OnSequenceStart(const YAML::Mark &mark, const std::string &tag, YAML::anchor_t anchor,
+                       YAML::EmitterStyle::value style);
+  void OnSequenceEnd();
+  void OnMapStart(const YAML::Mark &mark, const std::string &tag, YAML::anchor_t anchor,
+                  YAML::EmitterStyle::value style);
+  void OnMapEnd();
+
+protected:
+  /** Where the reader is within the document. */
+  enum class State {
+    Document,  ///< Expecting the document root.
+    Root,      ///< Within the root map, expecting a key or value.
+    List,      ///< Within an element list of the root map.
+    Complete,  ///< Root map read.
+    Error      ///< An error occurred, remaining events are ignored.
+  };
+
+  /** A collection being built. */
+  struct Frame {
+    /** The collection node. */
+    YAML::Node node;
+    /** The location of the collection within the document. */
+    YAML::Mark mark;
+    /** If @c true, the node is a map. */
+    bool map;
+    /** The pending key, if @c hasKey is set. */
+    YAML::Node key;
+    /** If @c true, the key of the next map entry has been read. */
+    bool hasKey;
+  };
+
+  /** Creates a new node with the given tag. */
+  YAML::Node newNode(YAML::NodeType::value type, const std::string &tag);
+  /** Remembers an anchored node for later aliases. */
+  void setAnchor(YAML::anchor_t anchor, const YAML::Node &node);
+  /** Begins a collection. Element lists of the root map are handled by the reader itself. */
+  void beginCollection(const YAML::Node &node, const YAML::Mark &mark, bool map);
+  /** Ends the current collection. */
+  void endCollection();
+  /** Adds a complete node to the current collection or handles it, if it is an element or a
+   * key or value of the root map. The mark is the location of the node. */
+  void complete(const YAML::Node &node, const YAML::Mark &mark);
+
+  /** Handles a key of the root map. */
+  bool readKey(const YAML::Node &key, const YAML::Mark &mark);
+  /** Handles a value of the root map. */
+  bool readValue(const YAML::Node &node, const YAML::Mark &mark);
+  /** Allocates, parses, adds and links an element of the current list. */
+  bool readElement(const YAML::Node &node, const YAML::Mark &mark);
+  /** Resolves the remaining references at the end of the document. */
+  bool finish();
+
+protected:
+  /** The configuration to read into. */
+  Config *_config;
+  /** The context, holding IDs and deferred references. */
+  ConfigItem::Context &_context;
+  /** The error stack. */
+  ErrorStack _err;
+  /** The current state. */
+  State _state;
+  /** The current key of the root map. */
+  QString _key;
+  /** If @c true, the current key of the root map has been read. */
+  bool _hasKey;
+  /** The list, the current key refers to. */
+  ConfigObjectList *_list;
+  /** The collections being built, the outermost first. */
+  std::vector<Frame> _stack;
+  /** Anchored nodes, indexed by anchor. */
+  std::vector<YAML::Node> _anchors;
+  /** ID of the default radio ID, set in the settings. */
+  QString _defaultId;
+  /** Location of the settings, defining the default radio ID. */
+  YAML::Mark _defaultIdMark;
+};
+
+#endif // YAMLCONFIGREADER_HH
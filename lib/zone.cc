@@ -18,8 +18,10 @@ Zone::Zone(QObject *parent)
   : ConfigObject(parent), _A(), _B(), _anytone(nullptr)
 {
   connect(&_A, SIGNAL(elementAdded(int)), this, SIGNAL(modified()));
+  connect(&_A, SIGNAL(elementsAdded(int,int)), this, SIGNAL(modified()));
   connect(&_A, SIGNAL(elementRemoved(int)), this, SIGNAL(modified()));
   connect(&_B, SIGNAL(elementAdded(int)), this, SIGNAL(modified()));
+  connect(&_B, SIGNAL(elementsAdded(int,int)), this, SIGNAL(modified()));
   connect(&_B, SIGNAL(elementRemoved(int)), this, SIGNAL(modified()));
 }
 
@@ -27,8 +29,10 @@ Zone::Zone(const QString &name, QObject *parent)
   : ConfigObject(name, parent), _A(), _B(), _anytone(nullptr)
 {
   connect(&_A, SIGNAL(elementAdded(int)), this, SIGNAL(modified()));
+  connect(&_A, SIGNAL(elementsAdded(int,int)), this, SIGNAL(modified()));
   connect(&_A, SIGNAL(elementRemoved(int)), this, SIGNAL(modified()));
   connect(&_B, SIGNAL(elementAdded(int)), this, SIGNAL(modified()));
+  connect(&_B, SIGNAL(elementsAdded(int,int)), this, SIGNAL(modified()));
   connect(&_B, SIGNAL(elementRemoved(int)), this, SIGNAL(modified()));
 }
 
@@ -42,6 +42,9 @@
 #include "radioselectiondialog.hh"
 #include "chirpformat.hh"
 
+// Maximum number of snapshots kept for undo.
+#define MAX_UNDO_STEPS 50
+
 
 inline QStringList getLanguages() {
   QStringList languages = {QLocale::system().name()};
@@ -56,7 +59,9 @@ inline QString getLocalePath(const QString &language) {
 }
 
 Application::Application(int &argc, char *argv[])
-  : QApplication(argc, argv), _config(nullptr), _mainWindow(nullptr), _translator(nullptr),
+  : QApplication(argc, argv), _config(nullptr), _limitCache(new RadioLimitCache(this)),
+    _snapshotter(nullptr), _history(), _historyIndex(0), _snapshotTimer(),
+    _mainWindow(nullptr), _translator(nullptr),
     _repeater(nullptr), _lastDevice()
 {
   setApplicationName("qdmr");
@@ -92,6 +97,13 @@ Application::Application(int &argc, char *argv[])
   _talkgroups = new TalkGroupDatabase(30, this);
   // create empty codeplug
   _config     = new Config(this);
+  _snapshotter = new ConfigSnapshotter(_config, this);
+  // Modifications are recorded for undo once the config settled, a dialog may modify it
+  // several times.
+  _snapshotTimer.setSingleShot(true);
+  _snapshotTimer.setInterval(500);
+  connect(&_snapshotTimer, SIGNAL(timeout()), this, SLOT(takeSnapshot()));
+  resetHistory();
 
   // Handle args (if there are some)
   if (argc>1) {
@@ -133,6 +145,7 @@ Application::Application(int &argc, char *argv[])
   _releaseNotes.checkForUpdate();
 
   logDebug() << "Last known position: " << _currentPosition.toString();
+  resetHistory();
   connect(_config, SIGNAL(modified(ConfigItem*)), this, SLOT(onConfigModifed()));
 }
 
@@ -202,6 +215,8 @@ Application::createMainWindow() {
   QAction *loadCP  = _mainWindow->findChild<QAction*>("actionOpenCodeplug");
   QAction *saveCP  = _mainWindow->findChild<QAction*>("actionSaveCodeplug");
   QAction *exportCP = _mainWindow->findChild<QAction*>("actionExportToCHIRP");
+  QAction *undoCP  = _mainWindow->findChild<QAction*>("actionUndo");
+  QAction *redoCP  = _mainWindow->findChild<QAction*>("actionRedo");
 
   QAction *findDev = _mainWindow->findChild<QAction*>("actionDetectDevice");
   QAction *verCP   = _mainWindow->findChild<QAction*>("actionVerifyCodeplug");
@@ -221,6 +236,8 @@ Application::createMainWindow() {
   connect(loadCP, SIGNAL(triggered()), this, SLOT(loadCodeplug()));
   connect(saveCP, SIGNAL(triggered()), this, SLOT(saveCodeplug()));
   connect(exportCP, SIGNAL(triggered()), this, SLOT(exportCodeplugToChirp()));
+  connect(undoCP, SIGNAL(triggered()), this, SLOT(undo()));
+  connect(redoCP, SIGNAL(triggered()), this, SLOT(redo()));
   connect(quit, SIGNAL(triggered()), this, SLOT(quitApplication()));
   connect(about, SIGNAL(triggered()), this, SLOT(showAbout()));
   connect(sett, SIGNAL(triggered()), this, SLOT(showSettings()));
@@ -302,6 +319,7 @@ Application::createMainWindow() {
   }
 
   _mainWindow->restoreGeometry(settings.mainWindowState());
+  updateHistoryActions();
   return _mainWindow;
 }
 
@@ -318,6 +336,7 @@ Application::newCodeplug() {
 
   _config->clear();
   _config->setModified(false);
+  resetHistory();
 }
 
 
@@ -374,6 +393,7 @@ Application::loadCodeplug() {
       _config->clear();
     }
   }
+  resetHistory();
 }
 
 
@@ -549,6 +569,8 @@ Application::verifyCodeplug(Radio *radio, bool showSuccess) {
   }
   Settings settings;
   RadioLimitContext ctx(settings.ignoreFrequencyLimits());
+  ctx.setCache(_limitCache);
+  ctx.enableParallel();
   myRadio->limits().verifyConfig(_config, ctx);
   bool verified = true;
   if ( (settings.ignoreVerificationWarning() && (ctx.maxSeverity()>RadioLimitIssue::Warning)) ||
@@ -625,13 +647,17 @@ Application::onCodeplugDownloaded(Radio *radio, Codeplug *codeplug) {
   _config->clear();
   _mainWindow->setWindowModified(false);
   ErrorStack err;
-  if (codeplug->decode(_config, err)) {
+  _config->beginUpdate();
+  bool decoded = codeplug->decode(_config, err);
+  _config->endUpdate();
+  if (decoded) {
     _mainWindow->statusBar()->showMessage(tr("Read complete"));
     _mainWindow->findChild<QProgressBar *>("progress")->setVisible(false);
     _config->setModified(false);
   } else {
     ErrorMessageView(err).show();
   }
+  resetHistory();
   _mainWindow->setEnabled(true);
 
   if (radio->wait(250))
@@ -706,6 +732,10 @@ Application::uploadCallsignDB() {
   // Sort call-sign DB w.r.t. the current DMR ID in _config
   // this is part of the "auto-selection" of calls-signs for upload
   Settings settings;
+  // Only the entries that fit into the radio need to be sorted
+  int limit = int(radio->limits().numCallSignDBEntries());
+  if (settings.limitCallSignDBEntries())
+    limit = qMin(limit, int(settings.maxCallSignDBEntries()));
   if (settings.selectUsingUserDMRID()) {
     if (nullptr == _config->radioIDs()->defaultId()) {
       QMessageBox::critical(nullptr, tr("Cannot write call-sign DB."),
@@ -717,14 +747,14 @@ Application::uploadCallsignDB() {
     // Sort w.r.t users DMR ID
     unsigned id = _config->radioIDs()->defaultId()->number();
     logDebug() << "Sort call-signs closest to ID=" << id << ".";
-    _users->sortUsers(id);
+    _users->sortUsers(id, limit);
   } else {
     // sort w.r.t. chosen prefixes
     QSet<unsigned> ids=settings.callSignDBPrefixes(); QStringList prefs;
     foreach (unsigned pref, ids)
       prefs.append(QString::number(pref));
     logDebug() << "Sort call-signs closest to IDs={" << prefs.join(", ") << "}.";
-    _users->sortUsers(ids);
+    _users->sortUsers(ids, limit);
   }
 
   // Assemble flags for callsign DB encoding
@@ -869,12 +899,79 @@ Application::showHelp() {
 
 void
 Application::onConfigModifed() {
+  _snapshotTimer.start();
+
   if (! _mainWindow)
     return;
 
   _mainWindow->setWindowModified(true);
 }
 
+void
+Application::takeSnapshot() {
+  _snapshotTimer.stop();
+  ConfigSnapshot snapshot = _snapshotter->take();
+  if (ConfigSnapshot::diff(_history.at(_historyIndex), snapshot).isEmpty())
+    return;
+
+  // Drop snapshots undone before
+  _history.resize(_historyIndex+1);
+  _history.append(snapshot);
+  if (MAX_UNDO_STEPS < _history.size())
+    _history.removeFirst();
+  _historyIndex = _history.size()-1;
+  updateHistoryActions();
+}
+
+void
+Application::undo() {
+  // Record pending modifications first
+  if (_snapshotTimer.isActive())
+    takeSnapshot();
+  if (0 < _historyIndex)
+    restoreSnapshot(_historyIndex-1);
+}
+
+void
+Application::redo() {
+  if (_snapshotTimer.isActive())
+    takeSnapshot();
+  if ((_historyIndex+1) < _history.size())
+    restoreSnapshot(_historyIndex+1);
+}
+
+void
+Application::resetHistory() {
+  _snapshotTimer.stop();
+  _history.clear();
+  _history.append(_snapshotter->take());
+  _historyIndex = 0;
+  updateHistoryActions();
+}
+
+void
+Application::restoreSnapshot(int index) {
+  ErrorStack err;
+  bool restored = _snapshotter->restore(_history.at(index), err);
+  // Modifications made by restoring are not recorded
+  _snapshotTimer.stop();
+  if (! restored) {
+    ErrorMessageView(err).show();
+    resetHistory();
+    return;
+  }
+  _historyIndex = index;
+  updateHistoryActions();
+}
+
+void
+Application::updateHistoryActions() {
+  if (! _mainWindow)
+    return;
+  _mainWindow->findChild<QAction*>("actionUndo")->setEnabled(0 < _historyIndex);
+  _mainWindow->findChild<QAction*>("actionRedo")->setEnabled((_historyIndex+1) < _history.size());
+}
+
 void
 Application::positionUpdated(const QGeoPositionInfo &info) {
   if (info.isValid())
@@ -4,7 +4,9 @@
 #include <QApplication>
 #include <QGroupBox>
 #include <QIcon>
+#include <QTimer>
 #include "config.hh"
+#include "configsnapshot.hh"
 #include <QGeoPositionInfoSource>
 #include "releasenotes.hh"
 #include "radio.hh"
@@ -25,6 +27,7 @@ class PositioningSystemListView;
 class RoamingChannelListView;
 class RoamingZoneListView;
 class ExtensionView;
+class RadioLimitCache;
 
 class Application : public QApplication
 {
@@ -55,6 +58,9 @@ public slots:
   void exportCodeplugToChirp();
   void quitApplication();
 
+  void undo();
+  void redo();
+
   void detectRadio();
   bool verifyCodeplug(Radio *radio=nullptr, bool showSuccess=true);
 
@@ -76,13 +82,24 @@ private slots:
   void onCodeplugUploaded(Radio *radio);
 
   void onConfigModifed();
+  void takeSnapshot();
 
   void positionUpdated(const QGeoPositionInfo &info);
 
   void onPaletteChanged(const QPalette &palette);
 
+protected:
+  void resetHistory();
+  void restoreSnapshot(int index);
+  void updateHistoryActions();
+
 protected:
   Config *_config;
+  RadioLimitCache *_limitCache;
+  ConfigSnapshotter *_snapshotter;
+  QVector<ConfigSnapshot> _history;
+  int _historyIndex;
+  QTimer _snapshotTimer;
   QMainWindow *_mainWindow;
   QTranslator *_translator;
 
@@ -17,7 +17,9 @@ GenericListWrapper::GenericListWrapper(AbstractConfigObjectList *list, QObject *
 
   connect(_list, SIGNAL(destroyed(QObject*)), this, SLOT(onListDeleted()));
   connect(_list, SIGNAL(elementAdded(int)), this, SLOT(onItemAdded(int)));
+  connect(_list, SIGNAL(elementsAdded(int,int)), this, SLOT(onItemsAdded(int,int)));
   connect(_list, SIGNAL(elementModified(int)), this, SLOT(onItemModified(int)));
+  connect(_list, SIGNAL(elementsModified(int,int)), this, SLOT(onItemsModified(int,int)));
   connect(_list, SIGNAL(elementRemoved(int)), this, SLOT(onItemRemoved(int)));
 }
 
@@ -95,6 +97,12 @@ GenericListWrapper::onItemAdded(int idx) {
   endInsertRows();
 }
 
+void
+GenericListWrapper::onItemsAdded(int first, int last) {
+  beginInsertRows(QModelIndex(), first, last);
+  endInsertRows();
+}
+
 void
 GenericListWrapper::onItemRemoved(int idx) {
   beginRemoveRows(QModelIndex(), idx, idx);
@@ -107,6 +115,11 @@ GenericListWrapper::onItemModified(int idx) {
   emit dataChanged(index(idx),index(idx));
 }
 
+void
+GenericListWrapper::onItemsModified(int first, int last) {
+  emit dataChanged(index(first),index(last));
+}
+
 
 /* ********************************************************************************************* *
  * Implementation of GenericTableWrapper
@@ -119,7 +132,9 @@ GenericTableWrapper::GenericTableWrapper(AbstractConfigObjectList *list, QObject
 
   connect(_list, SIGNAL(destroyed(QObject*)), this, SLOT(onListDeleted()));
   connect(_list, SIGNAL(elementAdded(int)), this, SLOT(onItemAdded(int)));
+  connect(_list, SIGNAL(elementsAdded(int,int)), this, SLOT(onItemsAdded(int,int)));
   connect(_list, SIGNAL(elementModified(int)), this, SLOT(onItemModified(int)));
+  connect(_list, SIGNAL(elementsModified(int,int)), this, SLOT(onItemsModified(int,int)));
   connect(_list, SIGNAL(elementRemoved(int)), this, SLOT(onItemRemoved(int)));
 }
 
@@ -188,6 +203,12 @@ GenericTableWrapper::onItemAdded(int idx) {
   endInsertRows();
 }
 
+void
+GenericTableWrapper::onItemsAdded(int first, int last) {
+  beginInsertRows(QModelIndex(), first, last);
+  endInsertRows();
+}
+
 void
 GenericTableWrapper::onItemRemoved(int idx) {
   beginRemoveRows(QModelIndex(), idx, idx);
@@ -200,6 +221,11 @@ GenericTableWrapper::onItemModified(int idx) {
   emit dataChanged(index(idx,0),index(idx,columnCount()-1));
 }
 
+void
+GenericTableWrapper::onItemsModified(int first, int last) {
+  emit dataChanged(index(first,0),index(last,columnCount()-1));
+}
+
 
 /* ********************************************************************************************* *
  * Implementation of ChannelListWrapper
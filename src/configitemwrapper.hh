@@ -36,10 +36,14 @@ protected slots:
   void onListDeleted();
   /** Internal callback on added items. */
   void onItemAdded(int idx);
+  /** Internal callback on a range of added items. */
+  void onItemsAdded(int first, int last);
   /** Internal callback on deleted channels. */
   void onItemRemoved(int idx);
   /** Internal callback on modified channels. */
   void onItemModified(int idx);
+  /** Internal callback on a range of modified items. */
+  void onItemsModified(int first, int last);
 
 protected:
   /** Holds a weak reference to the list object. */
@@ -77,10 +81,14 @@ protected slots:
   void onListDeleted();
   /** Internal used callback on adding an item. */
   void onItemAdded(int idx);
+  /** Internal used callback on adding a range of items. */
+  void onItemsAdded(int first, int last);
   /** Internal callback on deleted channels. */
   void onItemRemoved(int idx);
   /** Internal callback on modified channels. */
   void onItemModified(int idx);
+  /** Internal callback on a range of modified items. */
+  void onItemsModified(int first, int last);
 
 protected:
   /** Holds a weak reference to the list object. */
@@ -0,0 +1,166 @@
+#include "anytoneinterfacetest.hh"
+#include "anytone_interface.hh"
+#include "errorstack.hh"
+#include <QTest>
+#include <QtEndian>
+
+/** Simulates an AnyTone radio in program mode, without any serial port.
+ * Requests to a single address can be made to fail a number of times. */
+class FakeAnytoneInterface: public AnytoneInterface
+{
+public:
+  FakeAnytoneInterface(uint32_t badAddr=0xffffffff, int failures=0)
+    : AnytoneInterface(USBSerial::Descriptor(0x28e9, 0x018a, "/nonexistent")),
+      _memory(0x1000, 0x00), _responses(), _badAddr(badAddr), _failures(failures)
+  {
+    // The device cannot be opened, pretend to be in program mode
+    _state = STATE_PROGRAM;
+  }
+
+  QByteArray &memory() { return _memory; }
+
+protected:
+  bool send(const char *cmd, int clen, const ErrorStack &err) {
+    while (clen > 0) {
+      if (('W' == cmd[0]) && (clen >= int(sizeof(WriteRequest)))) {
+        const WriteRequest *req = (const WriteRequest *)cmd;
+        uint32_t addr = qFromBigEndian(req->addr);
+        if (fail(addr)) {
+          _responses.append(char(0x15));
+        } else {
+          memcpy(_memory.data()+addr, req->data, 16);
+          _responses.append(char(0x06));
+        }
+        cmd += sizeof(WriteRequest); clen -= sizeof(WriteRequest);
+      } else if (('R' == cmd[0]) && (clen >= int(sizeof(ReadRequest)))) {
+        const ReadRequest *req = (const ReadRequest *)cmd;
+        uint32_t addr = qFromBigEndian(req->addr);
+        // A write request to the same address has the layout of a valid read response
+        WriteRequest resp(addr, _memory.constData()+addr);
+        if (fail(addr))
+          resp.sum ^= 0xff;
+        _responses.append((const char *)&resp, sizeof(WriteRequest));
+        cmd += sizeof(ReadRequest); clen -= sizeof(ReadRequest);
+      } else {
+        errMsg(err) << "Unknown command '" << cmd[0] << "'.";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool receive(char *resp, int rlen, const ErrorStack &err) {
+    if (_responses.size() < rlen) {
+      errMsg(err) << "No response from device: Timeout.";
+      return false;
+    }
+    memcpy(resp, _responses.constData(), rlen);
+    _responses.remove(0, rlen);
+    return true;
+  }
+
+  void drain() {
+    _responses.clear();
+  }
+
+  bool fail(uint32_t addr) {
+    if ((_badAddr != addr) || (0 == _failures))
+      return false;
+    _failures--;
+    return true;
+  }
+
+protected:
+  QByteArray _memory;
+  QByteArray _responses;
+  uint32_t _badAddr;
+  int _failures;
+};
+
+
+static QByteArray
+randomData(int size) {
+  // Simple LCG, deterministic data
+  QByteArray data(size, 0x00);
+  uint32_t state = 0x12345678;
+  for (int i=0; i<size; i++) {
+    state = state*1103515245 + 12345;
+    data[i] = char(state >> 24);
+  }
+  return data;
+}
+
+
+AnytoneInterfaceTest::AnytoneInterfaceTest(QObject *parent)
+  : QObject(parent)
+{
+  // pass...
+}
+
+void
+AnytoneInterfaceTest::testPipelinedWrite() {
+  QByteArray data = randomData(0x400);
+  FakeAnytoneInterface dev;
+  unsigned depth = dev.pipelineDepth();
+  QVERIFY(depth > 1);
+
+  ErrorStack err;
+  if (! dev.write(0, 0x100, (uint8_t *)data.data(), data.size(), err))
+    QFAIL(err.format().toStdString().c_str());
+  QCOMPARE(dev.memory().mid(0x100, data.size()), data);
+  QCOMPARE(dev.pipelineDepth(), depth);
+}
+
+void
+AnytoneInterfaceTest::testPipelinedWriteFallback() {
+  QByteArray data = randomData(0x400);
+
+  // A single failure within the pipeline, the remaining data is written in lock-step
+  FakeAnytoneInterface dev(0x100+20*16, 1);
+  ErrorStack err;
+  if (! dev.write(0, 0x100, (uint8_t *)data.data(), data.size(), err))
+    QFAIL(err.format().toStdString().c_str());
+  QCOMPARE(dev.memory().mid(0x100, data.size()), data);
+  QCOMPARE(dev.pipelineDepth(), 1U);
+
+  // If the lock-step transfer fails too, the error is reported
+  FakeAnytoneInterface broken(0x100+20*16, 2);
+  QVERIFY(! broken.write(0, 0x100, (uint8_t *)data.data(), data.size(), err));
+  QVERIFY(! err.isEmpty());
+  QCOMPARE(broken.pipelineDepth(), 1U);
+}
+
+void
+AnytoneInterfaceTest::testPipelinedRead() {
+  FakeAnytoneInterface dev;
+  dev.memory() = randomData(0x1000);
+  unsigned depth = dev.pipelineDepth();
+
+  QByteArray data(0x400, 0x00);
+  ErrorStack err;
+  if (! dev.read(0, 0x100, (uint8_t *)data.data(), data.size(), err))
+    QFAIL(err.format().toStdString().c_str());
+  QCOMPARE(data, dev.memory().mid(0x100, data.size()));
+  QCOMPARE(dev.pipelineDepth(), depth);
+}
+
+void
+AnytoneInterfaceTest::testPipelinedReadFallback() {
+  // A single failure within the pipeline, the remaining data is read in lock-step
+  FakeAnytoneInterface dev(0x100+20*16, 1);
+  dev.memory() = randomData(0x1000);
+  QByteArray data(0x400, 0x00);
+  ErrorStack err;
+  if (! dev.read(0, 0x100, (uint8_t *)data.data(), data.size(), err))
+    QFAIL(err.format().toStdString().c_str());
+  QCOMPARE(data, dev.memory().mid(0x100, data.size()));
+  QCOMPARE(dev.pipelineDepth(), 1U);
+
+  // If the lock-step transfer fails too, the error is reported
+  FakeAnytoneInterface broken(0x100+20*16, 2);
+  QVERIFY(! broken.read(0, 0x100, (uint8_t *)data.data(), data.size(), err));
+  QVERIFY(! err.isEmpty());
+  QCOMPARE(broken.pipelineDepth(), 1U);
+}
+
+QTEST_GUILESS_MAIN(AnytoneInterfaceTest)
@@ -0,0 +1,20 @@
+#ifndef ANYTONEINTERFACETEST_HH
+#define ANYTONEINTERFACETEST_HH
+
+#include <QObject>
+
+class AnytoneInterfaceTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit AnytoneInterfaceTest(QObject *parent = nullptr);
+
+private slots:
+  void testPipelinedWrite();
+  void testPipelinedWriteFallback();
+  void testPipelinedRead();
+  void testPipelinedReadFallback();
+};
+
+#endif // ANYTONEINTERFACETEST_HH
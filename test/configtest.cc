@@ -2,8 +2,13 @@
 #include "config.hh"
 #include "errorstack.hh"
 #include "melody.hh"
+#include "configsnapshot.hh"
 #include <iostream>
 #include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryFile>
+#include <QFile>
+#include <QTextStream>
 
 
 ConfigTest::ConfigTest(QObject *parent) : QObject(parent)
@@ -34,6 +39,452 @@ ConfigTest::testCloneChannelBasic() {
   QCOMPARE(clone->compare(*_config.channelList()->channel(0)), 0);
 }
 
+void
+ConfigTest::testObjectListIndex() {
+  Config config;
+  QVector<ConfigObject *> channels;
+  for (int i=0; i<4; i++) {
+    FMChannel *ch = new FMChannel();
+    ch->setName(QString("Channel %1").arg(i));
+    channels.append(ch);
+  }
+
+  // Batched add emits a single range signal
+  QSignalSpy added(config.channelList(), SIGNAL(elementAdded(int)));
+  QSignalSpy rangeAdded(config.channelList(), SIGNAL(elementsAdded(int,int)));
+  QCOMPARE(config.channelList()->addAll(channels), 4);
+  QCOMPARE(added.count(), 0);
+  QCOMPARE(rangeAdded.count(), 1);
+  QCOMPARE(rangeAdded.at(0).at(0).toInt(), 0);
+  QCOMPARE(rangeAdded.at(0).at(1).toInt(), 3);
+  // Already contained elements are ignored
+  QCOMPARE(config.channelList()->addAll(channels), 0);
+  QCOMPARE(rangeAdded.count(), 1);
+
+  // Indices follow moves and removals
+  QVERIFY(config.channelList()->moveUp(1, 2));
+  QCOMPARE(config.channelList()->indexOf(channels[1]), 0);
+  QCOMPARE(config.channelList()->indexOf(channels[2]), 1);
+  QCOMPARE(config.channelList()->indexOf(channels[0]), 2);
+  QVERIFY(config.channelList()->moveDown(0));
+  QCOMPARE(config.channelList()->indexOf(channels[2]), 0);
+  QCOMPARE(config.channelList()->indexOf(channels[1]), 1);
+  QVERIFY(config.channelList()->take(channels[2]));
+  QVERIFY(! config.channelList()->has(channels[2]));
+  QCOMPARE(config.channelList()->indexOf(channels[1]), 0);
+  QCOMPARE(config.channelList()->indexOf(channels[0]), 1);
+  QCOMPARE(config.channelList()->indexOf(channels[3]), 2);
+  delete channels[0];
+  QCOMPARE(config.channelList()->count(), 2);
+  QCOMPARE(config.channelList()->indexOf(channels[3]), 1);
+  delete channels[2];
+}
+
+bool
+ConfigTest::writeLargeConfig(QTemporaryFile &file, Config &config) {
+  ErrorStack err;
+  if (! config.readYAML(":/data/config_test.yaml", err)) {
+    qWarning("Cannot open codeplug file: %s", err.format().toStdString().c_str());
+    return false;
+  }
+
+  QVector<ConfigObject *> channels, contacts;
+  for (int i=0; i<4000; i++) {
+    FMChannel *ch = new FMChannel();
+    ch->setName(QString("Channel %1").arg(i));
+    ch->setRXFrequency(144.0 + i*0.0125); ch->setTXFrequency(144.0 + i*0.0125);
+    channels.append(ch);
+  }
+  for (int i=0; i<10000; i++)
+    contacts.append(new DMRContact(DMRContact::PrivateCall, QString("Contact %1").arg(i), 2620000+i));
+  config.channelList()->addAll(channels);
+  config.contacts()->addAll(contacts);
+
+  if (! file.open())
+    return false;
+  QTextStream stream(&file);
+  if (! config.toYAML(stream, err)) {
+    qWarning("Cannot serialize codeplug: %s", err.format().toStdString().c_str());
+    return false;
+  }
+  stream.flush(); file.close();
+  return true;
+}
+
+bool
+ConfigTest::readDOM(const QString &filename, Config &config, const ErrorStack &err) {
+  QFile file(filename);
+  if (! file.open(QIODevice::ReadOnly))
+    return false;
+  YAML::Node node = YAML::Load(file.readAll().toStdString());
+  ConfigItem::Context context;
+  return config.parse(node, context, err) && config.link(node, context, err);
+}
+
+void
+ConfigTest::benchmarkLargeConfig() {
+  ErrorStack err;
+  Config config;
+  QTemporaryFile file;
+  QVERIFY(writeLargeConfig(file, config));
+
+  QBENCHMARK {
+    Config loaded;
+    if (! loaded.readYAML(file.fileName(), err))
+      QFAIL(QString("Cannot read codeplug: %1").arg(err.format()).toStdString().c_str());
+    QCOMPARE(loaded.channelList()->count(), config.channelList()->count());
+    QCOMPARE(loaded.contacts()->count(), config.contacts()->count());
+  }
+}
+
+void
+ConfigTest::benchmarkLargeConfigDOM() {
+  // Reference for benchmarkLargeConfig: Loads the entire document first, then parses and links it
+  ErrorStack err;
+  Config config;
+  QTemporaryFile file;
+  QVERIFY(writeLargeConfig(file, config));
+
+  QBENCHMARK {
+    Config loaded;
+    if (! readDOM(file.fileName(), loaded, err))
+      QFAIL(QString("Cannot read codeplug: %1").arg(err.format()).toStdString().c_str());
+    QCOMPARE(loaded.channelList()->count(), config.channelList()->count());
+    QCOMPARE(loaded.contacts()->count(), config.contacts()->count());
+  }
+}
+
+void
+ConfigTest::testStreamingReader() {
+  // Reading in a single pass must result in the same codeplug as parsing and linking the document
+  ErrorStack err;
+  Config dom;
+  if (! readDOM(":/data/config_test.yaml", dom, err))
+    QFAIL(QString("Cannot read codeplug: %1").arg(err.format()).toStdString().c_str());
+
+  QString expected, streamed;
+  QTextStream expectedStream(&expected), streamedStream(&streamed);
+  QVERIFY(dom.toYAML(expectedStream, err));
+  QVERIFY(_config.toYAML(streamedStream, err));
+  QCOMPARE(streamed, expected);
+}
+
+void
+ConfigTest::testForwardReferences() {
+  // Scan list and settings refer to elements defined later
+  QTemporaryFile file;
+  QVERIFY(file.open());
+  file.write(
+        "version: 0.11.3\n"
+        "scanLists:\n"
+        "  - id: scan1\n"
+        "    name: Scan\n"
+        "    primary: ch2\n"
+        "    channels: [ch2, !selected \"\", ch1]\n"
+        "settings:\n"
+        "  defaultID: id2\n"
+        "radioIDs:\n"
+        "  - dmr: {id: id1, name: DM3MAT, number: 2621370}\n"
+        "  - dmr: {id: id2, name: DM3MAT2, number: 2621371}\n"
+        "channels:\n"
+        "  - fm: {id: ch1, name: FM 1, rxFrequency: 145.5, txFrequency: 145.5, scanListRef: scan1}\n"
+        "  - fm: {id: ch2, name: FM 2, rxFrequency: 145.6, txFrequency: 145.6}\n");
+  file.close();
+
+  ErrorStack err;
+  Config config;
+  if (! config.readYAML(file.fileName(), err))
+    QFAIL(QString("Cannot read codeplug: %1").arg(err.format()).toStdString().c_str());
+
+  ScanList *scan = config.scanlists()->scanlist(0);
+  Channel *ch1 = config.channelList()->channel(0), *ch2 = config.channelList()->channel(1);
+  QCOMPARE(scan->primaryChannel(), ch2);
+  QCOMPARE(ch1->scanList(), scan);
+  // Order of the list is kept, irrespective of when the references got resolved
+  QCOMPARE(scan->count(), 3);
+  QCOMPARE(scan->channel(0), ch2);
+  QCOMPARE(scan->channel(1), (Channel *)SelectedChannel::get());
+  QCOMPARE(scan->channel(2), ch1);
+  QCOMPARE(config.radioIDs()->defaultId(), config.radioIDs()->getId(1));
+
+  // Roaming zone refers to roaming and DMR channels defined later
+  QTemporaryFile roaming;
+  QVERIFY(roaming.open());
+  roaming.write(
+        "version: 0.11.3\n"
+        "roamingZones:\n"
+        "  - {id: roam1, name: RZ1, channels: [rc2, ch1, rc1]}\n"
+        "roamingChannels:\n"
+        "  - {id: rc1, name: R 1, rxFrequency: 439.5625, txFrequency: 431.9625, colorCode: 1}\n"
+        "  - {id: rc2, name: R 2, rxFrequency: 438.825, txFrequency: 431.225, colorCode: 1}\n"
+        "channels:\n"
+        "  - dmr: {id: ch1, name: DMR 1, rxFrequency: 439.0875, txFrequency: 431.4875, colorCode: 2,\n"
+        "          timeSlot: TS1, admit: Always, power: High, timeout: 0, vox: 0, rxOnly: false}\n");
+  roaming.close();
+
+  Config roamingConfig;
+  if (! roamingConfig.readYAML(roaming.fileName(), err))
+    QFAIL(QString("Cannot read codeplug: %1").arg(err.format()).toStdString().c_str());
+  QCOMPARE(roamingConfig.roamingZones()->count(), 1);
+  RoamingZone *zone = roamingConfig.roamingZones()->get(0)->as<RoamingZone>();
+  // The DMR channel is converted into a roaming channel, the order is kept
+  QCOMPARE(roamingConfig.roamingChannels()->count(), 3);
+  QCOMPARE(zone->count(), 3);
+  QCOMPARE(zone->channel(0), roamingConfig.roamingChannels()->get(1)->as<RoamingChannel>());
+  QCOMPARE(zone->channel(1), roamingConfig.roamingChannels()->get(2)->as<RoamingChannel>());
+  QCOMPARE(zone->channel(2), roamingConfig.roamingChannels()->get(0)->as<RoamingChannel>());
+  QCOMPARE(zone->channel(1)->rxFrequency(), 439.0875);
+}
+
+void
+ConfigTest::testUndefinedReference() {
+  QTemporaryFile file;
+  QVERIFY(file.open());
+  file.write(
+        "version: 0.11.3\n"
+        "channels:\n"
+        "  - fm: {id: ch1, name: FM 1, rxFrequency: 145.5, txFrequency: 145.5, scanListRef: scan9}\n");
+  file.close();
+
+  ErrorStack err;
+  Config config;
+  QVERIFY(! config.readYAML(file.fileName(), err));
+  QVERIFY(err.format().contains("scan9"));
+  // The error is reported with its location (line and column are counted from 0)
+  QString line = "  - fm: {id: ch1, name: FM 1, rxFrequency: 145.5, txFrequency: 145.5, scanListRef: scan9}";
+  QVERIFY(err.format().contains(QString("2:%1:").arg(line.indexOf("scan9"))));
+}
+
+void
+ConfigTest::testNewIds() {
+  ConfigItem::Context context;
+  FMChannel a, b, c;
+  QVERIFY(context.add("ch2", &a));
+  QCOMPARE(context.newId("ch"), QString("ch1"));
+  QVERIFY(context.add("ch1", &b));
+  // Explicitly added IDs are skipped
+  QCOMPARE(context.newId("ch"), QString("ch3"));
+  QCOMPARE(context.newId("cont"), QString("cont1"));
+  QVERIFY(context.add(context.newId("ch"), &c));
+  QCOMPARE(context.getId(&c), QString("ch4"));
+}
+
+void
+ConfigTest::testStreamedYAML() {
+  // Must be identical to the document built from the node tree, with and without optional lists
+  Config empty;
+  QList<Config *> configs = {&_config, &empty};
+  foreach (Config *config, configs) {
+    ErrorStack err;
+    QString streamed;
+    QTextStream stream(&streamed);
+    if (! config->toYAML(stream, err))
+      QFAIL(QString("Cannot serialize codeplug: %1").arg(err.format()).toStdString().c_str());
+
+    ConfigItem::Context context;
+    QVERIFY(config->label(context, err));
+    YAML::Emitter emitter;
+    emitter << YAML::BeginDoc << config->serialize(context, err) << YAML::EndDoc;
+    QCOMPARE(streamed, QString(emitter.c_str()));
+  }
+}
+
+void
+ConfigTest::testPropertySchema() {
+  typedef ConfigItem::Schema::Kind Kind;
+  const ConfigItem::Schema &schema = ConfigItem::Schema::get(&DMRChannel::staticMetaObject);
+  QVERIFY(&schema == &ConfigItem::Schema::get(&DMRChannel::staticMetaObject));
+
+  QHash<QString, Kind> kinds;
+  foreach (const ConfigItem::Schema::Property &info, schema.properties())
+    kinds[info.prop.name()] = info.kind;
+  QVERIFY(Kind::String == kinds.value("name", Kind::Unknown));
+  QVERIFY(Kind::Double == kinds.value("rxFrequency", Kind::Unknown));
+  QVERIFY(Kind::Bool == kinds.value("rxOnly", Kind::Unknown));
+  QVERIFY(Kind::UInt == kinds.value("colorCode", Kind::Unknown));
+  QVERIFY(Kind::Enum == kinds.value("timeSlot", Kind::Unknown));
+  QVERIFY(Kind::Reference == kinds.value("contact", Kind::Unknown));
+  QVERIFY(Kind::Item == kinds.value("anytone", Kind::Unknown));
+
+  const ConfigItem::Schema &zone = ConfigItem::Schema::get(&Zone::staticMetaObject);
+  foreach (const ConfigItem::Schema::Property &info, zone.properties())
+    kinds[info.prop.name()] = info.kind;
+  QVERIFY(Kind::RefList == kinds.value("A", Kind::Unknown));
+}
+
+void
+ConfigTest::testBatchedUpdates() {
+  Config config;
+  QVector<ConfigObject *> channels;
+  for (int i=0; i<10; i++) {
+    FMChannel *ch = new FMChannel();
+    ch->setName(QString("Channel %1").arg(i));
+    channels.append(ch);
+  }
+  config.channelList()->addAll(channels);
+
+  QSignalSpy configModified(&config, SIGNAL(modified(ConfigItem*)));
+  QSignalSpy modified(config.channelList(), SIGNAL(elementModified(int)));
+  QSignalSpy rangeModified(config.channelList(), SIGNAL(elementsModified(int,int)));
+
+  // Unbatched modifications are signaled one by one
+  channels[3]->setName("Modified 3");
+  QCOMPARE(modified.count(), 1);
+  QCOMPARE(modified.at(0).at(0).toInt(), 3);
+  QCOMPARE(configModified.count(), 1);
+
+  // Batched modifications are coalesced, even if nested
+  modified.clear(); configModified.clear();
+  config.beginUpdate();
+  config.beginUpdate();
+  QVERIFY(config.isUpdating());
+  QVERIFY(config.channelList()->isUpdating());
+  channels[7]->setName("Modified 7");
+  channels[2]->setName("Modified 2");
+  config.endUpdate();
+  channels[5]->setName("Modified 5");
+  QCOMPARE(rangeModified.count(), 0);
+  QCOMPARE(configModified.count(), 0);
+  config.endUpdate();
+  QVERIFY(! config.isUpdating());
+  QCOMPARE(modified.count(), 0);
+  QCOMPARE(rangeModified.count(), 1);
+  QCOMPARE(rangeModified.at(0).at(0).toInt(), 2);
+  QCOMPARE(rangeModified.at(0).at(1).toInt(), 7);
+  QCOMPARE(configModified.count(), 1);
+  QVERIFY(config.isModified());
+
+  // Empty batches are silent
+  rangeModified.clear(); configModified.clear();
+  config.beginUpdate();
+  config.endUpdate();
+  QCOMPARE(rangeModified.count(), 0);
+  QCOMPARE(configModified.count(), 0);
+}
+
+void
+ConfigTest::testSnapshots() {
+  ErrorStack err;
+  Config config;
+  if (! config.readYAML(":/data/config_test.yaml", err)) {
+    QFAIL(QString("Cannot open codeplug file: %1").arg(err.format()).toStdString().c_str());
+  }
+  typedef ConfigSnapshot::Difference::Type Type;
+
+  ConfigSnapshotter snapshotter(&config);
+  ConfigSnapshot first = snapshotter.take();
+  QVERIFY(! first.isNull());
+  QVERIFY(snapshotter.captured() > unsigned(config.channelList()->count()));
+
+  // Nothing changed, nothing gets captured
+  ConfigSnapshot second = snapshotter.take();
+  QCOMPARE(snapshotter.captured(), 0U);
+  QCOMPARE(ConfigSnapshot::diff(first, second).count(), 0);
+
+  // Only the modified channel gets captured
+  Channel *channel = config.channelList()->channel(1);
+  channel->setName("Modified");
+  ConfigSnapshot third = snapshotter.take();
+  QCOMPARE(snapshotter.captured(), 1U);
+  QVector<ConfigSnapshot::Difference> diffs = ConfigSnapshot::diff(second, third);
+  QCOMPARE(diffs.count(), 1);
+  QVERIFY(Type::Modified == diffs.at(0).type);
+  QCOMPARE(diffs.at(0).property, QString("channels"));
+  QCOMPARE(snapshotter.object(diffs.at(0).id), channel);
+  QCOMPARE(diffs.at(0).index, 1);
+  // Earlier snapshots are not affected
+  QCOMPARE(ConfigSnapshot::diff(first, second).count(), 0);
+
+  // Reordering a zone is detected without a modification signal of the zone
+  Zone *zone = config.zones()->zone(0);
+  QVERIFY(zone->A()->count() > 1);
+  zone->A()->moveDown(0);
+  diffs = ConfigSnapshot::diff(third, snapshotter.take());
+  QCOMPARE(snapshotter.captured(), 1U);
+  QCOMPARE(diffs.count(), 1);
+  QCOMPARE(diffs.at(0).property, QString("zones"));
+  QCOMPARE(snapshotter.object(diffs.at(0).id), zone);
+
+  // Structural changes and settings
+  ConfigSnapshot before = snapshotter.take();
+  FMChannel *added = new FMChannel();
+  added->setName("Added");
+  config.channelList()->add(added);
+  ConfigObject *removed = config.channelList()->get(0);
+  QString removedId = snapshotter.id(removed);
+  config.channelList()->take(removed);
+  config.settings()->setSquelch(config.settings()->squelch()+1);
+  ConfigSnapshot after = snapshotter.take();
+  diffs = ConfigSnapshot::diff(before, after);
+  QCOMPARE(diffs.count(), 3);
+  QVERIFY(Type::Modified == diffs.at(0).type);
+  QCOMPARE(diffs.at(0).property, QString("settings"));
+  QVERIFY(Type::Removed == diffs.at(1).type);
+  QCOMPARE(diffs.at(1).id, removedId);
+  QCOMPARE(diffs.at(1).index, 0);
+  QVERIFY(Type::Added == diffs.at(2).type);
+  QCOMPARE(snapshotter.object(diffs.at(2).id), added);
+  QCOMPARE(diffs.at(2).index, config.channelList()->count()-1);
+
+  // Deleted objects keep their ID, even if their address gets reused
+  delete removed;
+  QVERIFY(nullptr == snapshotter.object(removedId));
+  FMChannel *other = new FMChannel();
+  QVERIFY(snapshotter.id(other) != removedId);
+  delete other;
+}
+
+void
+ConfigTest::testRestoreSnapshots() {
+  ErrorStack err;
+  Config config;
+  if (! config.readYAML(":/data/config_test.yaml", err)) {
+    QFAIL(QString("Cannot open codeplug file: %1").arg(err.format()).toStdString().c_str());
+  }
+
+  ConfigSnapshotter snapshotter(&config);
+  ConfigSnapshot original = snapshotter.take();
+  QString yaml;
+  QTextStream stream(&yaml);
+  QVERIFY(config.toYAML(stream, err));
+
+  // Modify, delete, add and reorder elements and references
+  Channel *channel = config.channelList()->channel(1);
+  QString channelId = snapshotter.id(channel), channelName = channel->name();
+  channel->setName("Modified");
+  config.channelList()->del(config.channelList()->get(0));
+  FMChannel *added = new FMChannel();
+  added->setName("Added");
+  config.channelList()->add(added);
+  config.zones()->zone(0)->A()->moveDown(0);
+  config.settings()->setSquelch(config.settings()->squelch()+1);
+  // Process deferred deletes
+  QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+  ConfigSnapshot modified = snapshotter.take();
+  QVERIFY(ConfigSnapshot::diff(original, modified).count() > 0);
+
+  // Undo
+  if (! snapshotter.restore(original, err))
+    QFAIL(QString("Cannot restore snapshot: %1").arg(err.format()).toStdString().c_str());
+  QCOMPARE(ConfigSnapshot::diff(original, snapshotter.take()).count(), 0);
+  // The modified element is restored in place, the deleted one is re-created
+  QCOMPARE(config.channelList()->channel(1), channel);
+  QCOMPARE(channel->name(), channelName);
+  QVERIFY(! config.channelList()->has(added));
+  QString restored;
+  QTextStream restoredStream(&restored);
+  QVERIFY(config.toYAML(restoredStream, err));
+  QCOMPARE(restored, yaml);
+
+  // Redo re-inserts the very same objects
+  if (! snapshotter.restore(modified, err))
+    QFAIL(QString("Cannot restore snapshot: %1").arg(err.format()).toStdString().c_str());
+  QCOMPARE(ConfigSnapshot::diff(modified, snapshotter.take()).count(), 0);
+  QVERIFY(config.channelList()->has(added));
+  QCOMPARE(snapshotter.object(channelId), channel);
+  QCOMPARE(channel->name(), QString("Modified"));
+}
+
 void
 ConfigTest::testMelodyLilypond() {
   QString lilypond = "a8 b e2 cis4 d";
@@ -2,6 +2,7 @@
 #define CONFIGTEST_HH
 
 #include <QObject>
+#include <QTemporaryFile>
 #include "config.hh"
 
 
@@ -17,11 +18,29 @@ private slots:
   void cleanupTestCase();
 
   void testCloneChannelBasic();
+  void testObjectListIndex();
+  void benchmarkLargeConfig();
+  void benchmarkLargeConfigDOM();
+  void testStreamingReader();
+  void testForwardReferences();
+  void testUndefinedReference();
+  void testNewIds();
+  void testStreamedYAML();
+  void testPropertySchema();
+  void testBatchedUpdates();
+  void testSnapshots();
+  void testRestoreSnapshots();
 
   void testMelodyLilypond();
   void testMelodyEncoding();
   void testMelodyDecoding();
 
+protected:
+  /** Writes a large codeplug into the given file. */
+  bool writeLargeConfig(QTemporaryFile &file, Config &config);
+  /** Reads a codeplug as a whole document and parses and links it afterwards. */
+  bool readDOM(const QString &filename, Config &config, const ErrorStack &err=ErrorStack());
+
 protected:
   Config _config;
 };
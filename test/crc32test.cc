@@ -15,4 +15,50 @@ CRC32Test::testCRC32() {
   QCOMPARE(crc.get(), 0x414FA339U^0xFFFFFFFF);
 }
 
+static QByteArray
+randomData(int size) {
+  // Simple LCG, deterministic data
+  QByteArray data(size, 0x00);
+  uint32_t state = 0x12345678;
+  for (int i=0; i<size; i++) {
+    state = state*1103515245 + 12345;
+    data[i] = char(state >> 24);
+  }
+  return data;
+}
+
+void
+CRC32Test::testBulkUpdate() {
+  QByteArray data = randomData(0x1000);
+  const uint8_t *ptr = (const uint8_t *)data.constData();
+
+  // Compare bulk update with byte-wise update for all alignments and several lengths
+  for (int offset=0; offset<16; offset++) {
+    for (int length=0; length<(data.size()-offset); length += 13) {
+      CRC32 bulk, bytewise;
+      bulk.update(ptr+offset, length);
+      for (int i=0; i<length; i++)
+        bytewise.update(ptr[offset+i]);
+      QCOMPARE(bulk.get(), bytewise.get());
+    }
+  }
+
+  // Split updates must yield the same result
+  CRC32 once, split;
+  once.update(data);
+  split.update(ptr, 100);
+  split.update(ptr+100, 1);
+  split.update(ptr+101, data.size()-101);
+  QCOMPARE(split.get(), once.get());
+}
+
+void
+CRC32Test::benchmarkBulkUpdate() {
+  QByteArray data = randomData(16*1024*1024);
+  QBENCHMARK {
+    CRC32 crc;
+    crc.update(data);
+  }
+}
+
 QTEST_GUILESS_MAIN(CRC32Test)
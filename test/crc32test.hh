@@ -12,6 +12,8 @@ public:
 
 private slots:
   void testCRC32();
+  void testBulkUpdate();
+  void benchmarkBulkUpdate();
 };
 
 #endif // CRC32TEST_H
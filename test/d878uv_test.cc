@@ -2,9 +2,18 @@
 #include "config.hh"
 #include "d878uv.hh"
 #include "d878uv_codeplug.hh"
+#include "radiolimits.hh"
+#include "d868uv_callsigndb.hh"
+#include "userdatabase.hh"
 #include "errorstack.hh"
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 #include <QTest>
+#include <QThread>
+#include <QThreadPool>
+#include <QTemporaryDir>
+#include <QFile>
 #include "logger.hh"
 
 D878UVTest::D878UVTest(QObject *parent)
@@ -117,6 +126,87 @@ D878UVTest::testRoaming() {
            config.roamingChannels()->get(2)->as<RoamingChannel>());
 }
 
+void
+D878UVTest::testParallelEncoding() {
+  ErrorStack err;
+  Codeplug::Flags flags; flags.updateCodePlug=false;
+
+  // A single thread forces serial encoding
+  QThreadPool single;
+  single.setMaxThreadCount(1);
+  D878UVCodeplug serial;
+  serial.setThreadPool(&single);
+  if (! serial.encode(&_roamingConfig, flags, err)) {
+    QFAIL(QString("Cannot encode codeplug for AnyTone AT-D878UV: %1")
+          .arg(err.format()).toStdString().c_str());
+  }
+
+  // Use a local pool with several threads, irrespective of the machine
+  QThreadPool pool;
+  pool.setMaxThreadCount(4);
+  D878UVCodeplug parallel;
+  parallel.setThreadPool(&pool);
+  if (! parallel.encode(&_roamingConfig, flags, err)) {
+    QFAIL(QString("Cannot encode codeplug for AnyTone AT-D878UV: %1")
+          .arg(err.format()).toStdString().c_str());
+  }
+
+  // Both must be identical
+  QCOMPARE(parallel.image(0).numElements(), serial.image(0).numElements());
+  for (int i=0; i<serial.image(0).numElements(); i++) {
+    const DFUFile::Element &a = serial.image(0).element(i), &b = parallel.image(0).element(i);
+    QCOMPARE(b.address(), a.address());
+    QCOMPARE(b.memSize(), a.memSize());
+    QVERIFY(0 == memcmp(a.ptr(), b.ptr(), a.memSize()));
+  }
+}
+
+void
+D878UVTest::testParallelDecoding() {
+  ErrorStack err;
+  Codeplug::Flags flags; flags.updateCodePlug=false;
+
+  // Enough channels to get decoded by several threads
+  Config config;
+  if (! config.readYAML(":/data/config_test.yaml", err)) {
+    QFAIL(QString("Cannot open codeplug file: %1")
+          .arg(err.format()).toStdString().c_str());
+  }
+  for (int i=0; i<200; i++) {
+    Channel *ch = config.channelList()->channel(i%2)->clone()->as<Channel>();
+    ch->setName(QString("Channel %1").arg(i));
+    config.channelList()->add(ch);
+  }
+
+  D878UVCodeplug codeplug;
+  if (! codeplug.encode(&config, flags, err)) {
+    QFAIL(QString("Cannot encode codeplug for AnyTone AT-D878UV: %1")
+          .arg(err.format()).toStdString().c_str());
+  }
+
+  // Use a local pool with several threads, irrespective of the machine
+  QThreadPool pool;
+  pool.setMaxThreadCount(4);
+  codeplug.setThreadPool(&pool);
+  Config decoded;
+  if (! codeplug.decode(&decoded, err)) {
+    QFAIL(QString("Cannot decode codeplug for AnyTone AT-D878UV: %1")
+          .arg(err.format()).toStdString().c_str());
+  }
+
+  // Channels must be in order and live in this thread
+  QCOMPARE(decoded.channelList()->count(), config.channelList()->count());
+  for (int i=0; i<config.channelList()->count(); i++) {
+    Channel *ch = decoded.channelList()->channel(i);
+    QCOMPARE(ch->name(), config.channelList()->channel(i)->name());
+    QCOMPARE(ch->thread(), QThread::currentThread());
+    if (DMRChannel *dmr = ch->as<DMRChannel>()) {
+      QCOMPARE(dmr->contact()->thread(), QThread::currentThread());
+      QCOMPARE(dmr->radioId()->thread(), QThread::currentThread());
+    }
+  }
+}
+
 void
 D878UVTest::testHangTime() {
   ErrorStack err;
@@ -216,5 +306,169 @@ D878UVTest::testKeyFunctions() {
   QCOMPARE(ext->funcKeyBLong(), AnytoneKeySettingsExtension::KeyFunction::Call);
 }
 
+static QStringList
+verificationIssues(const RadioLimits &limits, const Config *config, RadioLimitCache *cache=nullptr,
+                   QThreadPool *pool=nullptr) {
+  RadioLimitContext ctx;
+  ctx.setCache(cache);
+  ctx.enableParallel(nullptr != pool);
+  ctx.setThreadPool(pool);
+  limits.verifyConfig(config, ctx);
+  QStringList issues;
+  for (int i=0; i<ctx.count(); i++)
+    issues.append(ctx.message(i).format());
+  return issues;
+}
+
+void
+D878UVTest::testIncrementalVerification() {
+  ErrorStack err;
+  Config config;
+  if (! config.readYAML(":/data/config_test.yaml", err)) {
+    QFAIL(QString("Cannot open codeplug file: %1")
+          .arg(err.format()).toStdString().c_str());
+  }
+
+  D878UV radio;
+  RadioLimitCache cache;
+
+  // Initial verification fills the cache
+  QStringList full = verificationIssues(radio.limits(), &config);
+  QCOMPARE(verificationIssues(radio.limits(), &config, &cache), full);
+  QVERIFY(cache.hasResult());
+  QVERIFY(cache.count() >= (config.contacts()->count() + config.channelList()->count()));
+  // Unchanged config replays the result
+  QCOMPARE(verificationIssues(radio.limits(), &config, &cache), full);
+
+  // Modify a single channel, only that one gets dropped
+  Channel *channel = config.channelList()->channel(0);
+  channel->setName("A channel name that is way too long for this radio");
+  QVERIFY(! cache.hasResult());
+  QVERIFY(! cache.contains(channel));
+  QVERIFY(cache.contains(config.channelList()->channel(1)));
+  full = verificationIssues(radio.limits(), &config);
+  QCOMPARE(verificationIssues(radio.limits(), &config, &cache), full);
+  QVERIFY(cache.contains(channel));
+
+  // Modify a referenced contact, referring group lists get dropped as well
+  DMRContact *contact = config.contacts()->contact(0)->as<DMRContact>();
+  QVERIFY(contact);
+  RXGroupList *group = nullptr;
+  for (int i=0; (nullptr == group) && (i<config.rxGroupLists()->count()); i++) {
+    if (0 <= config.rxGroupLists()->list(i)->contacts()->indexOf(contact))
+      group = config.rxGroupLists()->list(i);
+  }
+  QVERIFY(group);
+  QVERIFY(cache.contains(group));
+  contact->setType(DMRContact::PrivateCall);
+  QVERIFY(! cache.contains(contact));
+  QVERIFY(! cache.contains(group));
+  full = verificationIssues(radio.limits(), &config);
+  QCOMPARE(verificationIssues(radio.limits(), &config, &cache), full);
+
+  // Another radio instance resets the cache
+  D878UV other;
+  QCOMPARE(verificationIssues(other.limits(), &config, &cache), full);
+}
+
+void
+D878UVTest::testParallelVerification() {
+  ErrorStack err;
+  Config config;
+  if (! config.readYAML(":/data/config_test.yaml", err)) {
+    QFAIL(QString("Cannot open codeplug file: %1")
+          .arg(err.format()).toStdString().c_str());
+  }
+  // Enough channels to get verified by several threads, some with issues
+  for (int i=0; i<300; i++) {
+    Channel *ch = config.channelList()->channel(i%2)->clone()->as<Channel>();
+    ch->setName(QString((0 == (i%7)) ? "Channel with a too long name %1" : "Channel %1").arg(i));
+    config.channelList()->add(ch);
+  }
+
+  D878UV radio;
+  // Use a local pool with several threads, irrespective of the machine
+  QThreadPool pool;
+  pool.setMaxThreadCount(4);
+  QStringList serial = verificationIssues(radio.limits(), &config);
+  QStringList parallel = verificationIssues(radio.limits(), &config, nullptr, &pool);
+  RadioLimitCache cache;
+  QStringList cached = verificationIssues(radio.limits(), &config, &cache, &pool);
+  config.channelList()->channel(10)->setName("Another channel with a too long name");
+  QStringList modified = verificationIssues(radio.limits(), &config);
+  QStringList recached = verificationIssues(radio.limits(), &config, &cache, &pool);
+
+  QVERIFY(serial.count() > 40);
+  QCOMPARE(parallel, serial);
+  QCOMPARE(cached, serial);
+  QCOMPARE(recached, modified);
+}
+
+void
+D878UVTest::testCallsignDB() {
+  // Synthetic user database, large enough to span several entry banks and two index banks.
+  // Contains names outside of Latin-1 and names exceeding the field sizes.
+  static const char *names[] = {
+    "Jan", "Jürgen", "日本語の名前", "Grin \xF0\x9F\x98\x80 face", "A very long first name indeed", ""};
+  const int n = 20000;
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  QString filename = dir.filePath("user.json");
+  QFile file(filename);
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  file.write("{\"users\": [\n");
+  for (int i=0; i<n; i++) {
+    // Unique IDs, not ordered
+    unsigned id = 2620000 + (i*7919) % n;
+    file.write(QString("{\"id\": %1, \"callsign\": \"DL%2\", \"fname\": \"%3\", \"surname\": \"\", "
+                       "\"city\": \"%4\", \"state\": \"\", \"country\": \"%5\"}%6\n")
+               .arg(id).arg(i, 0, 36).arg(names[i % 6]).arg(names[(i/6) % 6])
+               .arg(names[(i/36) % 6]).arg((i+1)<n ? "," : "").toUtf8());
+  }
+  file.write("]}\n");
+  file.close();
+  UserDatabase db(filename);
+  QCOMPARE(db.count(), qint64(n));
+
+  // Reference: Encode all users one-by-one, in ascending order of their IDs
+  QByteArray entries, index;
+  for (int i=0; i<n; i++) {
+    UserDatabase::User user = db.user(i);
+    if (i)
+      QVERIFY(db.user(i-1).id < user.id);
+    uint8_t entry[100], indexEntry[8];
+    memset(indexEntry, 0xff, sizeof(indexEntry));
+    D868UVCallsignDB::IndexEntryElement idx(indexEntry);
+    idx.setID(user.id, false);
+    idx.setIndex(entries.size());
+    index.append((const char *)indexEntry, sizeof(indexEntry));
+    unsigned size = D868UVCallsignDB::EntryElement(entry).fromUser(user);
+    QCOMPARE(size, D868UVCallsignDB::EntryElement::size(user));
+    entries.append((const char *)entry, size);
+  }
+  const int entryBank = D868UVCallsignDB::EntryBankElement::size(),
+      indexBank = D868UVCallsignDB::IndexBankElement::size();
+  QVERIFY(entries.size() > 2*entryBank);
+  QVERIFY(index.size() > indexBank);
+
+  D868UVCallsignDB callsigns;
+  QVERIFY(callsigns.encode(&db));
+
+  // Compare limits, index and entries, the memory layout is given by the radio
+  D868UVCallsignDB::LimitsElement limits(callsigns.data(0x044C0000));
+  QCOMPARE(limits.count(), unsigned(n));
+  QCOMPARE(limits.endOfDB(), unsigned(0x04500000 + entries.size()));
+  for (int bank=0; bank*indexBank<index.size(); bank++) {
+    int len = std::min(indexBank, index.size()-bank*indexBank);
+    QVERIFY(0 == memcmp(callsigns.data(0x04000000 + bank*0x00040000),
+                        index.constData()+bank*indexBank, len));
+  }
+  for (int bank=0; bank*entryBank<entries.size(); bank++) {
+    int len = std::min(entryBank, entries.size()-bank*entryBank);
+    QVERIFY(0 == memcmp(callsigns.data(0x04500000 + bank*0x00040000),
+                        entries.constData()+bank*entryBank, len));
+  }
+}
+
 QTEST_GUILESS_MAIN(D878UVTest)
 
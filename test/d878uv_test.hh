@@ -21,8 +21,13 @@ private slots:
 
   void testAnalogMicGain();
   void testRoaming();
+  void testParallelEncoding();
+  void testParallelDecoding();
   void testHangTime();
   void testKeyFunctions();
+  void testIncrementalVerification();
+  void testParallelVerification();
+  void testCallsignDB();
 
 protected:
   QTextStream _stderr;
@@ -0,0 +1,253 @@
+#include "dfufiletest.hh"
+#include "dfufile.hh"
+#include "addressmap.hh"
+#include <QTest>
+#include <QTemporaryFile>
+
+DFUFileTest::DFUFileTest(QObject *parent)
+  : QObject(parent)
+{
+  // pass...
+}
+
+void
+DFUFileTest::testAddressMap() {
+  AddressMap map;
+  QVERIFY(map.add(0x1000, 0x100));
+  QVERIFY(map.add(0x0100, 0x010));
+  QVERIFY(map.add(0x2000, 0x040));
+  QVERIFY(! map.add(0x1000, 0x010));
+
+  QCOMPARE(map.find(0x0000), -1);
+  QCOMPARE(map.find(0x0100), 1);
+  QCOMPARE(map.find(0x010f), 1);
+  QCOMPARE(map.find(0x0110), -1);
+  QCOMPARE(map.find(0x10ff), 0);
+  QCOMPARE(map.find(0x203f), 2);
+  QCOMPARE(map.find(0x2040), -1);
+
+  QVERIFY(map.overlaps(0x0000, 0x0101));
+  QVERIFY(! map.overlaps(0x0000, 0x0100));
+  QVERIFY(map.overlaps(0x10f0, 0x0100));
+  QVERIFY(! map.overlaps(0x1100, 0x0f00));
+
+  std::vector<uint32_t> idx = map.intersecting(0x0000, 0x2001);
+  QCOMPARE(idx.size(), size_t(3));
+  QCOMPARE(idx[0], 1U); QCOMPARE(idx[1], 0U); QCOMPARE(idx[2], 2U);
+  QVERIFY(map.intersecting(0x1100, 0x0f00).empty());
+}
+
+void
+DFUFileTest::testAddressMapIndices() {
+  DFUFile::Image image;
+  image.addElement(0x0000, 0x10);
+  image.addElement(0x0020, 0x10);
+  image.addElement(0x0010, 0x10, 1);
+  // Duplicates must neither be added to the elements nor to the map
+  QVERIFY(! image.addElement(0x0020, 0x10));
+  QVERIFY(! image.addElement(0x0000, 0x10, 1));
+  QCOMPARE(image.numElements(), 3);
+
+  QCOMPARE(image.element(1).address(), 0x0010U);
+  QCOMPARE(image.data(0x0010), (unsigned char *)image.element(1).data().data());
+  QCOMPARE(image.data(0x0020), (unsigned char *)image.element(2).data().data());
+
+  image.remElement(0);
+  QVERIFY(! image.isAllocated(0x0000));
+  QCOMPARE(image.data(0x0010), (unsigned char *)image.element(0).data().data());
+  QCOMPARE(image.data(0x0020), (unsigned char *)image.element(1).data().data());
+}
+
+void
+DFUFileTest::testImageSort() {
+  DFUFile::Image image;
+  image.addElement(0x0200, 0x80);
+  image.addElement(0x0000, 0x80);
+  image.addElement(0x0100, 0x80);
+  image.sort();
+
+  QCOMPARE(image.element(0).address(), 0x0000U);
+  QCOMPARE(image.element(2).address(), 0x0200U);
+  QVERIFY(image.isAllocated(0x027f));
+  QVERIFY(! image.isAllocated(0x0080));
+  QCOMPARE(image.data(0x0170), (unsigned char *)image.element(1).data().data()+0x70);
+}
+
+void
+DFUFileTest::testExtents() {
+  DFUFile::Image image;
+  image.addElement(0x0000, 0x10);
+  image.addElement(0x0010, 0x10);
+  image.addElement(0x0040, 0x10);
+  image.addElement(0x1000, 0x10);
+
+  QVector<DFUFile::Extent> extents = image.extents();
+  QCOMPARE(extents.size(), 3);
+  QCOMPARE(extents[0].address, 0x0000U); QCOMPARE(extents[0].size, 0x20U);
+
+  extents = image.extents(0x20);
+  QCOMPARE(extents.size(), 2);
+  QCOMPARE(extents[0].address, 0x0000U); QCOMPARE(extents[0].size, 0x50U);
+
+  // Scatter over gaps and gather back
+  QByteArray buffer(0x50, 0x00);
+  for (int i=0; i<buffer.size(); i++)
+    buffer[i] = i;
+  image.scatter(0x0000, (const uint8_t *)buffer.constData(), buffer.size());
+  QCOMPARE(image.data(0x0045)[0], (unsigned char)0x45);
+  QByteArray result(0x50, 0xff);
+  image.gather(0x0000, (uint8_t *)result.data(), result.size());
+  QCOMPARE(uint8_t(result[0x1f]), uint8_t(0x1f));
+  QCOMPARE(uint8_t(result[0x20]), uint8_t(0x00));
+  QCOMPARE(uint8_t(result[0x4f]), uint8_t(0x4f));
+}
+
+void
+DFUFileTest::testModified() {
+  DFUFile::Image image;
+  image.addElement(0x0000, 0x100);
+  image.addElement(0x0100, 0x100);
+  image.takeSnapshot();
+  QVERIFY(image.modified(0x10).isEmpty());
+
+  image.data(0x0015)[0] = 0xff;
+  image.data(0x0100)[0] = 0xff;
+  image.data(0x01f0)[0] = 0xff;
+  image.addElement(0x0400, 0x20);
+
+  QVector<DFUFile::Extent> modified = image.modified(0x10);
+  QCOMPARE(modified.size(), 4);
+  QCOMPARE(modified[0].address, 0x0010U); QCOMPARE(modified[0].size, 0x10U);
+  QCOMPARE(modified[1].address, 0x0100U); QCOMPARE(modified[1].size, 0x10U);
+  QCOMPARE(modified[2].address, 0x01f0U); QCOMPARE(modified[2].size, 0x10U);
+  QCOMPARE(modified[3].address, 0x0400U); QCOMPARE(modified[3].size, 0x20U);
+}
+
+void
+DFUFileTest::testArena() {
+  DFUFile::Image image;
+  // The arena memory is allocated with the first element in its range
+  DFUFile::Image empty;
+  QVERIFY(empty.useArena(0x0000, 0x10000));
+  QVERIFY(empty.hasArena());
+  empty.addElement(0x20000, 0x10);
+  QVERIFY(! empty.element(0).isView());
+
+  image.addElement(0x0000, 0x10);
+  image.data(0x0000)[0] = 0x42;
+  QVERIFY(image.useArena(0x0000, 0x10000));
+  // Existing elements get moved into the arena
+  QVERIFY(image.element(0).isView());
+  QCOMPARE(image.data(0x0000)[0], (unsigned char)0x42);
+
+  image.addElement(0x0100, 0x10);
+  image.addElement(0x20000, 0x10);
+  QVERIFY(image.element(1).isView());
+  QVERIFY(! image.element(2).isView());
+  QCOMPARE(image.data(0x0105), image.element(1).ptr()+5);
+  // Unallocated addresses within the arena cannot be resolved
+  QVERIFY(nullptr == image.data(0x0200));
+
+  // Modifications via data() are visible through the element
+  image.data(0x0101)[0] = 0x17;
+  QCOMPARE(uint8_t(image.element(1).data().at(1)), uint8_t(0x17));
+
+  // Elements straddling the end of the arena hold their own data, also accessed via data()
+  image.addElement(0xfff8, 0x10);
+  QVERIFY(! image.element(3).isView());
+  image.data(0xfff9)[0] = 0x5a;
+  QCOMPARE(uint8_t(image.element(3).data().at(1)), uint8_t(0x5a));
+
+  // Copies only copy the elements, the arena is allocated with the next element added
+  DFUFile::Image copy(image);
+  QVERIFY(copy.hasArena());
+  QVERIFY(! copy.element(1).isView());
+  copy.data(0x0101)[0] = 0x23;
+  QCOMPARE(image.data(0x0101)[0], (unsigned char)0x17);
+  QCOMPARE(copy.element(1).ptr()[1], (unsigned char)0x23);
+  QCOMPARE(copy.data(0xfff9)[0], (unsigned char)0x5a);
+  copy.addElement(0x0200, 0x10);
+  QVERIFY(copy.element(4).isView());
+
+  // Snapshots of views detect modifications
+  image.takeSnapshot();
+  image.data(0x0108)[0] = 0x01;
+  QVector<DFUFile::Extent> modified = image.modified(0x10);
+  QCOMPARE(modified.size(), 1);
+  QCOMPARE(modified[0].address, 0x0100U);
+}
+
+void
+DFUFileTest::testMapFile() {
+  DFUFile file;
+  file.addImage("Test");
+  file.image(0).addElement(0x0000, 0x0100);
+  file.image(0).addElement(0x1000, 0x0040);
+  for (uint32_t i=0; i<0x100; i++)
+    file.data(i)[0] = i;
+  file.data(0x1010)[0] = 0x42;
+
+  QTemporaryFile tmp;
+  QVERIFY(tmp.open());
+  QVERIFY(file.write(tmp));
+  QCOMPARE(uint32_t(tmp.size()), file.size());
+  tmp.close();
+
+  // Read back by streaming
+  DFUFile read;
+  QVERIFY(read.read(tmp.fileName()));
+  QCOMPARE(read.image(0).numElements(), 2);
+  QCOMPARE(read.data(0x1010)[0], (unsigned char)0x42);
+
+  // Map file, elements are views into the file
+  DFUFile mapped;
+  QVERIFY(mapped.map(tmp.fileName()));
+  QVERIFY(mapped.isMapped());
+  QCOMPARE(mapped.image(0).name(), QString("Test"));
+  QCOMPARE(mapped.image(0).numElements(), 2);
+  QVERIFY(mapped.image(0).element(0).isView());
+  QCOMPARE(mapped.data(0x0045)[0], (unsigned char)0x45);
+  QCOMPARE(mapped.data(0x1010)[0], (unsigned char)0x42);
+
+  // Modifications are private and survive unmapping
+  mapped.data(0x1011)[0] = 0x23;
+  mapped.unmap();
+  QVERIFY(! mapped.isMapped());
+  QVERIFY(! mapped.image(0).element(1).isView());
+  QCOMPARE(mapped.data(0x1011)[0], (unsigned char)0x23);
+  QVERIFY(read.read(tmp.fileName()));
+  QCOMPARE(read.data(0x1011)[0], (unsigned char)0x00);
+
+  // Corrupted files are rejected
+  QVERIFY(tmp.open());
+  tmp.seek(0x200);
+  tmp.write("\xff", 1);
+  tmp.close();
+  QVERIFY(! mapped.map(tmp.fileName()));
+  QVERIFY(! mapped.isMapped());
+}
+
+void
+DFUFileTest::benchmarkAllocation() {
+  // Allocates elements in the layout of a maximal D878UV codeplug: 4000 channels in banks of 128,
+  // each with its shadow record, as well as 10000 contacts.
+  QBENCHMARK {
+    DFUFile::Image image;
+    for (unsigned i=0; i<4000; i++) {
+      uint32_t addr = 0x00800000 + (i/128)*0x00040000 + (i%128)*0x40;
+      if (! image.isAllocated(addr))
+        image.addElement(addr, 0x40);
+      if (! image.isAllocated(addr+0x2000))
+        image.addElement(addr+0x2000, 0x40);
+    }
+    for (unsigned i=0; i<10000; i++) {
+      uint32_t addr = 0x02680000 + (i/1000)*0x00040000 + (i%1000)*0x64;
+      if (! image.isAllocated(addr))
+        image.addElement(addr, 0x64);
+    }
+    image.sort();
+    QCOMPARE(image.numElements(), 18000);
+  }
+}
+
+QTEST_GUILESS_MAIN(DFUFileTest)
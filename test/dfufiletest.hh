@@ -0,0 +1,24 @@
+#ifndef DFUFILETEST_HH
+#define DFUFILETEST_HH
+
+#include <QObject>
+
+class DFUFileTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit DFUFileTest(QObject *parent = nullptr);
+
+private slots:
+  void testAddressMap();
+  void testAddressMapIndices();
+  void testImageSort();
+  void testExtents();
+  void testModified();
+  void testArena();
+  void testMapFile();
+  void benchmarkAllocation();
+};
+
+#endif // DFUFILETEST_HH
@@ -0,0 +1,377 @@
+#include "userdatabasetest.hh"
+#include "userdatabase.hh"
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QPair>
+#include <algorithm>
+
+UserDatabaseTest::UserDatabaseTest(QObject *parent) : QObject(parent)
+{
+  // pass...
+}
+
+QByteArray
+UserDatabaseTest::makeDatabase(int n) {
+  static const char *countries[] = {"Germany", "United States", "Österreich", "日本"};
+  QByteArray json("{\"users\": [\n");
+  uint32_t state = 0x12345678;
+  for (int i=0; i<n; i++) {
+    // Simple LCG, deterministic but unordered IDs
+    state = state*1103515245 + 12345;
+    unsigned id = 1000000 + (state >> 8) % 8000000;
+    json.append(QString("  {\"id\": %1, \"callsign\": \"DL%2\", \"fname\": \"Name %3\", "
+                        "\"surname\": \"%4\", \"city\": \"City\", \"state\": \"\", "
+                        "\"country\": \"%5\", \"remarks\": \"\"}%6\n")
+                .arg(id).arg(i, 4, 36, QChar('0')).arg(i % 100).arg((i % 3) ? "Smith" : "")
+                .arg(countries[i % 4]).arg((i+1)<n ? "," : "").toUtf8());
+  }
+  json.append("]}\n");
+  return json;
+}
+
+bool
+UserDatabaseTest::writeDatabase(const QString &filename, int n) {
+  QFile file(filename);
+  if (! file.open(QIODevice::WriteOnly))
+    return false;
+  QByteArray json = makeDatabase(n);
+  return json.size() == file.write(json);
+}
+
+bool
+UserDatabaseTest::sameUsers(const UserDatabase &a, const UserDatabase &b) {
+  if (a.count() != b.count())
+    return false;
+  for (int i=0; i<a.count(); i++) {
+    UserDatabase::UserView ua = a.view(i), ub = b.view(i);
+    if (ua.id() != ub.id())
+      return false;
+    for (int f=0; f<=int(UserDatabase::Field::Comment); f++) {
+      if (ua.utf8(UserDatabase::Field(f)) != ub.utf8(UserDatabase::Field(f)))
+        return false;
+    }
+  }
+  return true;
+}
+
+void
+UserDatabaseTest::testCacheRoundTrip() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  QString filename = dir.filePath("user.json");
+  QVERIFY(writeDatabase(filename, 1000));
+
+  UserDatabase parsed(filename);
+  QCOMPARE(parsed.count(), qint64(1000));
+  QVERIFY(QFileInfo::exists(dir.filePath("user.cache")));
+  for (int i=1; i<parsed.count(); i++)
+    QVERIFY(parsed.view(i-1).id() <= parsed.view(i).id());
+
+  // Replace the JSON file by garbage of the same size and time stamp. Hence, the database can
+  // only be loaded from the cache.
+  QDateTime modified = QFileInfo(filename).lastModified();
+  QFile file(filename);
+  QVERIFY(file.open(QIODevice::ReadWrite));
+  file.write(QByteArray(file.size(), 'x'));
+  file.flush();
+  QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+  file.close();
+
+  UserDatabase cached(filename);
+  QCOMPARE(cached.count(), parsed.count());
+  QVERIFY(sameUsers(parsed, cached));
+  QCOMPARE(cached.user(10).name, parsed.user(10).name);
+
+  // A modified JSON file invalidates the cache
+  QVERIFY(file.open(QIODevice::ReadWrite));
+  QVERIFY(file.setFileTime(modified.addSecs(1), QFileDevice::FileModificationTime));
+  file.close();
+  UserDatabase outdated(filename);
+  QCOMPARE(outdated.count(), qint64(0));
+}
+
+void
+UserDatabaseTest::testInvalidCache() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  QString filename = dir.filePath("user.json"), cacheFilename = dir.filePath("user.cache");
+  QVERIFY(writeDatabase(filename, 100));
+  UserDatabase reference(filename);
+
+  QFile cache(cacheFilename);
+  QVERIFY(cache.open(QIODevice::ReadOnly));
+  QByteArray valid = cache.readAll();
+  cache.close();
+
+  // Bad magic, bad version, truncated columns and a truncated header
+  QVector<QByteArray> invalid(4, valid);
+  invalid[0].replace(0, 4, "XXXX");
+  invalid[1][8] = char(0xff);
+  invalid[2].chop(valid.size()/2);
+  invalid[3].truncate(12);
+
+  foreach (const QByteArray &content, invalid) {
+    QVERIFY(cache.open(QIODevice::WriteOnly));
+    cache.write(content);
+    cache.close();
+
+    // The invalid cache gets rejected, the database is read from the JSON file and the cache is
+    // regenerated
+    UserDatabase db(filename);
+    QVERIFY(sameUsers(reference, db));
+    QVERIFY(cache.open(QIODevice::ReadOnly));
+    QCOMPARE(cache.readAll(), valid);
+    cache.close();
+  }
+}
+
+void
+UserDatabaseTest::testReaderChunks() {
+  // Nested "users" keys and strings containing brackets, quotes and escapes must not confuse the
+  // reader, nor multi-byte characters split between chunks.
+  QByteArray doc = QString(
+        "{\"meta\": {\"users\": [1, 2], \"note\": \"a \\\"users\\\": [ string\"}, \"users\": [\n"
+        "  {\"id\": 2, \"callsign\": \"DL2\", \"fname\": \"Brace } and \\\"quote\\\" [\", "
+        "\"remarks\": \"back\\\\slash\\\\\"},\n"
+        "  {\"id\": 1, \"callsign\": \"DL1\", \"fname\": \"J\\u00fcrgen\", "
+        "\"surname\": \"M%1ller\", \"country\": \"%2\"}\n"
+        "]}\n").arg(QChar(0x00fc)).arg(QString::fromUtf8("日本")).toUtf8();
+
+  for (int size=1; size<=doc.size(); size++) {
+    UserDatabase::Reader reader;
+    UserDatabase::Store users;
+    for (int i=0; i<doc.size(); i+=size)
+      QVERIFY(reader.read(doc.mid(i, size), users));
+    QVERIFY(reader.isComplete());
+    QVERIFY(! reader.hasError());
+
+    // Users are kept in document order
+    QCOMPARE(users.count(), 2);
+    QCOMPARE(users.id(0), 2U);
+    QCOMPARE(users.id(1), 1U);
+    QCOMPARE(QString::fromUtf8(users.utf8(0, UserDatabase::Field::Name)),
+             QString("Brace } and \"quote\" ["));
+    QCOMPARE(QString::fromUtf8(users.utf8(0, UserDatabase::Field::Comment)),
+             QString("back\\slash\\"));
+    QCOMPARE(QString::fromUtf8(users.utf8(1, UserDatabase::Field::Name)),
+             QString("J%1rgen").arg(QChar(0x00fc)));
+    QCOMPARE(QString::fromUtf8(users.utf8(1, UserDatabase::Field::Surname)),
+             QString("M%1ller").arg(QChar(0x00fc)));
+    QCOMPARE(users.utf8(1, UserDatabase::Field::Country), QString::fromUtf8("日本").toUtf8());
+  }
+}
+
+void
+UserDatabaseTest::testReaderMalformed() {
+  QVector<QByteArray> malformed;
+  malformed << "[{\"id\": 1}]"
+            << "{\"users\": {}}"
+            << "{\"users\": [1, 2]}"
+            << "{\"users\": [{\"id\": 1, \"callsign\": }]}"
+            << "{\"foo\": 1}";
+
+  // Each document gets rejected, whether read at once or byte-by-byte
+  foreach (const QByteArray &doc, malformed) {
+    UserDatabase::Reader reader;
+    UserDatabase::Store users;
+    QVERIFY(! reader.read(doc, users));
+    QVERIFY(reader.hasError());
+    QVERIFY(! reader.errorMessage().isEmpty());
+
+    UserDatabase::Reader bytewise;
+    bool ok = true;
+    for (int i=0; (i<doc.size()) && ok; i++)
+      ok = bytewise.read(doc.mid(i, 1), users);
+    QVERIFY(! ok);
+    QVERIFY(bytewise.hasError());
+    // Once failed, the reader rejects any further input
+    QVERIFY(! bytewise.read("]}", users));
+  }
+
+  // Truncated documents are not an error but remain incomplete
+  QVector<QByteArray> truncated;
+  truncated << ""
+            << "{\"users\": [{\"id\": 1"
+            << "{\"users\": [{\"id\": 1}, "
+            << "{\"users\": [{\"id\": 1, \"fname\": \"a\\\"}]}";
+  foreach (const QByteArray &doc, truncated) {
+    UserDatabase::Reader reader;
+    UserDatabase::Store users;
+    QVERIFY(reader.read(doc, users));
+    QVERIFY(! reader.isComplete());
+    QVERIFY(! reader.hasError());
+  }
+
+  // A truncated database file does not get loaded nor cached
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  QString filename = dir.filePath("user.json");
+  QFile file(filename);
+  QVERIFY(file.open(QIODevice::WriteOnly));
+  QByteArray doc = makeDatabase(10);
+  file.write(doc.left(doc.size()/2));
+  file.close();
+  UserDatabase db(filename);
+  QCOMPARE(db.count(), qint64(0));
+  QVERIFY(! QFileInfo::exists(dir.filePath("user.cache")));
+}
+
+void
+UserDatabaseTest::testStoreInterning() {
+  UserDatabase::Store users;
+  UserDatabase::User user;
+  user.id = 1; user.call = "DL1ABC"; user.name = "Jan"; user.country = "Germany";
+  users.append(user);
+  user.id = 2; user.call = "DL2ABC"; user.name = "Jan"; user.surname = "Germany";
+  users.append(user);
+  user.id = 3; user.call = "DL1ABC"; user.name = ""; user.surname = ""; user.country = "";
+  users.append(user);
+  users.squeeze();
+
+  QCOMPARE(users.count(), 3);
+  // Equal strings share the same index, regardless of the field
+  QCOMPARE(users.fields.at(0*UserDatabase::Store::FieldCount + int(UserDatabase::Field::Call)),
+           users.fields.at(2*UserDatabase::Store::FieldCount + int(UserDatabase::Field::Call)));
+  QCOMPARE(users.fields.at(0*UserDatabase::Store::FieldCount + int(UserDatabase::Field::Name)),
+           users.fields.at(1*UserDatabase::Store::FieldCount + int(UserDatabase::Field::Name)));
+  QCOMPARE(users.fields.at(0*UserDatabase::Store::FieldCount + int(UserDatabase::Field::Country)),
+           users.fields.at(1*UserDatabase::Store::FieldCount + int(UserDatabase::Field::Surname)));
+  // Empty strings are string 0
+  QCOMPARE(users.fields.at(2*UserDatabase::Store::FieldCount + int(UserDatabase::Field::Name)), 0U);
+  QCOMPARE(users.fields.at(0*UserDatabase::Store::FieldCount + int(UserDatabase::Field::City)), 0U);
+  QVERIFY(users.utf8(2, UserDatabase::Field::Name).isEmpty());
+
+  // Each distinct string is stored once
+  QCOMPARE(users.offsets.size(), 1+5);
+  QCOMPARE(users.pool, QByteArray("DL1ABCJanGermanyDL2ABC"));
+  QCOMPARE(users.utf8(1, UserDatabase::Field::Call), QByteArray("DL2ABC"));
+  QCOMPARE(users.utf8(1, UserDatabase::Field::Surname), QByteArray("Germany"));
+}
+
+void
+UserDatabaseTest::testStoreReorder() {
+  UserDatabase::Store users;
+  unsigned ids[] = {30, 10, 20, 10};
+  for (int i=0; i<4; i++) {
+    UserDatabase::User user;
+    user.id = ids[i]; user.call = QString("CALL%1").arg(i);
+    users.append(user);
+  }
+
+  users.reorder(QVector<int>{3, 0, 2, 1});
+  QCOMPARE(users.id(0), 10U);
+  QCOMPARE(users.id(1), 30U);
+  QCOMPARE(users.id(2), 20U);
+  QCOMPARE(users.id(3), 10U);
+  QCOMPARE(users.utf8(0, UserDatabase::Field::Call), QByteArray("CALL3"));
+  QCOMPARE(users.utf8(1, UserDatabase::Field::Call), QByteArray("CALL0"));
+  QCOMPARE(users.utf8(3, UserDatabase::Field::Call), QByteArray("CALL1"));
+
+  // Sorting is stable, hence users with the same ID keep their order
+  users.sortByID();
+  QCOMPARE(users.count(), 4);
+  QCOMPARE(users.id(0), 10U);
+  QCOMPARE(users.id(1), 10U);
+  QCOMPARE(users.id(2), 20U);
+  QCOMPARE(users.id(3), 30U);
+  QCOMPARE(users.utf8(0, UserDatabase::Field::Call), QByteArray("CALL3"));
+  QCOMPARE(users.utf8(1, UserDatabase::Field::Call), QByteArray("CALL1"));
+  QCOMPARE(users.utf8(2, UserDatabase::Field::Call), QByteArray("CALL2"));
+  QCOMPARE(users.utf8(3, UserDatabase::Field::Call), QByteArray("CALL0"));
+}
+
+void
+UserDatabaseTest::testColumn() {
+  const quint32 raw[] = {3, 1, 2};
+  UserDatabase::Column column = UserDatabase::Column::fromRawData(raw, 3);
+  // Referenced, not copied
+  QCOMPARE(column.size(), 3);
+  QCOMPARE(column.constData(), raw);
+  QCOMPARE(column.at(1), 1U);
+
+  // Copies share the referenced memory, modifications copy it
+  UserDatabase::Column copy = column;
+  QCOMPARE(copy.constData(), raw);
+  copy.append(4);
+  QVERIFY(copy.constData() != raw);
+  QCOMPARE(copy.size(), 4);
+  QCOMPARE(copy.at(0), 3U);
+  QCOMPARE(copy.at(3), 4U);
+  QCOMPARE(column.size(), 3);
+  QCOMPARE(raw[0], 3U);
+}
+
+void
+UserDatabaseTest::testSortUsersLimit() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  QString filename = dir.filePath("user.json");
+  QVERIFY(writeDatabase(filename, 2000));
+
+  QVector<QSet<unsigned>> prefixes;
+  prefixes << QSet<unsigned>{262} << QSet<unsigned>{262, 3100} << QSet<unsigned>{4000123};
+  QVector<int> limits{0, 1, 100, 1999, 2000, 5000};
+
+  foreach (const QSet<unsigned> &ids, prefixes) {
+    UserDatabase full(filename);
+    full.sortUsers(ids);
+    foreach (int limit, limits) {
+      UserDatabase limited(filename);
+      QCOMPARE(limited.count(), full.count());
+      limited.sortUsers(ids, limit);
+      QCOMPARE(limited.count(), full.count());
+
+      // The closest users are the same and in the same order as if all users were sorted
+      int n = int(std::min(qint64(limit), limited.count()));
+      for (int i=0; i<n; i++)
+        QCOMPARE(limited.view(i).id(), full.view(i).id());
+      // The remaining ones keep their previous order, that is, are sorted by ID
+      for (int i=n+1; i<limited.count(); i++)
+        QVERIFY(limited.view(i-1).id() <= limited.view(i).id());
+      // No user got lost
+      QVector<QPair<unsigned, QByteArray>> a, b;
+      for (int i=0; i<full.count(); i++) {
+        a.append(QPair<unsigned, QByteArray>(full.view(i).id(),
+                                             full.view(i).utf8(UserDatabase::Field::Call)));
+        b.append(QPair<unsigned, QByteArray>(limited.view(i).id(),
+                                             limited.view(i).utf8(UserDatabase::Field::Call)));
+      }
+      std::sort(a.begin(), a.end()); std::sort(b.begin(), b.end());
+      QVERIFY(a == b);
+    }
+  }
+}
+
+void
+UserDatabaseTest::benchmarkSortUsers() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  QString filename = dir.filePath("user.json");
+  QVERIFY(writeDatabase(filename, 250000));
+  UserDatabase db(filename);
+  QCOMPARE(db.count(), qint64(250000));
+
+  QBENCHMARK {
+    db.sortUsers(QSet<unsigned>{262, 263}, 10000);
+  }
+}
+
+void
+UserDatabaseTest::benchmarkSortUsersFull() {
+  // Reference for benchmarkSortUsers: Sorts all users
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  QString filename = dir.filePath("user.json");
+  QVERIFY(writeDatabase(filename, 250000));
+  UserDatabase db(filename);
+  QCOMPARE(db.count(), qint64(250000));
+
+  QBENCHMARK {
+    db.sortUsers(QSet<unsigned>{262, 263});
+  }
+}
+
+QTEST_GUILESS_MAIN(UserDatabaseTest)
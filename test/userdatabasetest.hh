@@ -0,0 +1,37 @@
+#ifndef USERDATABASETEST_HH
+#define USERDATABASETEST_HH
+
+#include <QObject>
+#include <QByteArray>
+
+class UserDatabase;
+
+class UserDatabaseTest : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit UserDatabaseTest(QObject *parent = nullptr);
+
+private slots:
+  void testCacheRoundTrip();
+  void testInvalidCache();
+  void testReaderChunks();
+  void testReaderMalformed();
+  void testStoreInterning();
+  void testStoreReorder();
+  void testColumn();
+  void testSortUsersLimit();
+  void benchmarkSortUsers();
+  void benchmarkSortUsersFull();
+
+protected:
+  /** Returns a JSON user database with @c n synthetic users. */
+  static QByteArray makeDatabase(int n);
+  /** Writes a JSON user database with @c n synthetic users. */
+  static bool writeDatabase(const QString &filename, int n);
+  /** Compares the users of the two databases. */
+  static bool sameUsers(const UserDatabase &a, const UserDatabase &b);
+};
+
+#endif // USERDATABASETEST_HH
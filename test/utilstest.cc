@@ -5,6 +5,13 @@
 #include "frequency.hh"
 #include "chirpformat.hh"
 #include "config.hh"
+#include "taskgraph.hh"
+#include "codeplug.hh"
+#include "anytone_extension.hh"
+#include "radiolimits.hh"
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QVector>
 
 
 UtilsTest::UtilsTest(QObject *parent)
@@ -95,4 +102,116 @@ UtilsTest::testFrequencyParser() {
   QCOMPARE(Frequency::fromString("100.0").inHz(), 100000000ULL);
 }
 
+void
+UtilsTest::testTaskGraph() {
+  // Each task records its position in the completion order
+  QAtomicInt counter(0);
+  QVector<int> finished(64, -1);
+  TaskGraph tasks;
+  for (int i=0; i<finished.size(); i++) {
+    QList<int> deps;
+    if (i >= 8)
+      deps << (i-8) << (i%8);
+    tasks.add([i, &counter, &finished](const ErrorStack &err) {
+      Q_UNUSED(err);
+      finished[i] = counter.fetchAndAddOrdered(1);
+      return true;
+    }, deps);
+  }
+
+  QThreadPool pool; pool.setMaxThreadCount(4);
+  QVERIFY(tasks.run(ErrorStack(), &pool));
+  for (int i=8; i<finished.size(); i++) {
+    QVERIFY(finished[i] > finished[i-8]);
+    QVERIFY(finished[i] > finished[i%8]);
+  }
+
+  // A failing task stops the execution of its dependents and reports its errors
+  TaskGraph failing;
+  bool dependentRun = false;
+  int first = failing.add([](const ErrorStack &err) {
+    errMsg(err) << "Task failed.";
+    return false;
+  });
+  failing.add([&dependentRun](const ErrorStack &err) {
+    Q_UNUSED(err);
+    dependentRun = true;
+    return true;
+  }, QList<int>() << first);
+  ErrorStack err;
+  QVERIFY(! failing.run(err, &pool));
+  QVERIFY(! dependentRun);
+  QCOMPARE(err.count(), 1U);
+}
+
+void
+UtilsTest::testCodeplugContext() {
+  Config config;
+  Codeplug::Context ctx(&config);
+
+  // Derived types resolve to the table of their base class
+  DMRChannel dmr; FMChannel fm;
+  QVERIFY(ctx.hasTable(&DMRChannel::staticMetaObject));
+  QVERIFY(! ctx.addTable(&DMRChannel::staticMetaObject));
+  QVERIFY(ctx.add(&dmr, 1));
+  QVERIFY(ctx.add(&fm, 100000));
+  QCOMPARE(ctx.index(&dmr), 1);
+  QCOMPARE(ctx.index(&fm), 100000);
+  QCOMPARE(ctx.get<Channel>(1), (Channel *)&dmr);
+  QCOMPARE(ctx.get<Channel>(100000), (Channel *)&fm);
+  QVERIFY(! ctx.has<Channel>(0));
+  QCOMPARE(ctx.count<Channel>(), 2U);
+
+  // First association wins
+  DMRChannel other;
+  QVERIFY(ctx.add(&other, 1));
+  QCOMPARE(ctx.get<Channel>(1), (Channel *)&dmr);
+  QCOMPARE(ctx.index(&other), 1);
+
+  // Tables added later take precedence over previously resolved types
+  AnytoneAutoRepeaterOffset offset;
+  QCOMPARE(ctx.index(&offset), -1);
+  QCOMPARE(ctx.count<AnytoneAutoRepeaterOffset>(), 0U);
+  QVERIFY(! ctx.add(&offset, 0));
+  QVERIFY(ctx.addTable(&AnytoneAutoRepeaterOffset::staticMetaObject));
+  QVERIFY(ctx.add(&offset, 0));
+  QCOMPARE(ctx.get<AnytoneAutoRepeaterOffset>(0), &offset);
+}
+
+void
+UtilsTest::testRadioLimitRules() {
+  // Overlapping and unsorted ranges get merged
+  RadioLimitObject limits {
+    { "name", new RadioLimitStringRegEx("[A-Z0-9]+") },
+    { "rxFrequency", new RadioLimitFrequencies({{430., 440.}, {136., 174.}, {144., 180.}}) }
+  };
+
+  FMChannel channel;
+  channel.setName("DB0ABC");
+  QVector<double> valid = {136., 150., 174., 175., 180., 430., 435., 440.};
+  foreach (double f, valid) {
+    channel.setRXFrequency(f);
+    RadioLimitContext ctx;
+    QVERIFY(limits.verifyObject(&channel, ctx));
+    QCOMPARE(ctx.count(), 0);
+  }
+
+  QVector<double> invalid = {100., 135.9, 180.1, 300., 429.9, 440.1, 1000.};
+  foreach (double f, invalid) {
+    channel.setRXFrequency(f);
+    RadioLimitContext ctx;
+    QVERIFY(! limits.verifyObject(&channel, ctx));
+    QCOMPARE(ctx.count(), 1);
+    QCOMPARE(ctx.maxSeverity(), RadioLimitIssue::Critical);
+  }
+
+  // Pattern must match the entire string
+  channel.setRXFrequency(435.);
+  channel.setName("DB0ABC x");
+  RadioLimitContext ctx;
+  QVERIFY(limits.verifyObject(&channel, ctx));
+  QCOMPARE(ctx.count(), 1);
+  QCOMPARE(ctx.maxSeverity(), RadioLimitIssue::Warning);
+}
+
 QTEST_GUILESS_MAIN(UtilsTest)
@@ -20,6 +20,9 @@ private slots:
   void testDecodeDMRID_bcd();
   void testEncodeDMRID_bcd();
   void testFrequencyParser();
+  void testTaskGraph();
+  void testCodeplugContext();
+  void testRadioLimitRules();
 };
 
 #endif // UTILSTEST_HH